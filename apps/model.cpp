@@ -13,11 +13,12 @@ auto main() -> int {
 	auto window = Window("Model", 1280, 720);
 
 	// Enable depth testing
-	glEnable(GL_DEPTH_TEST);
+	auto &state = StateCache::get();
+	state.setEnabled(GL_DEPTH_TEST, true);
 
 	// Enable blending for transparency
-	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-	glEnable(GL_BLEND);
+	state.setBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	state.setEnabled(GL_BLEND, true);
 
 	auto shader_program = ShaderProgram(
 	    {"resources/shaders/model.vert", "resources/shaders/model.frag"});
@@ -55,7 +56,14 @@ auto main() -> int {
 		                        glm::vec3(0.0f, 1.0f, 0.0f));
 		shader_program.setUniform("u_transform", transform);
 
-		model.draw();
+		// Tint every part of the model by its material
+		const auto &submeshes = model.getSubmeshes();
+		for (size_t i = 0; i < submeshes.size(); ++i) {
+			const auto &material = model.getMaterial(submeshes[i]);
+			shader_program.setUniform("u_model_color",
+			                          model_color * material.diffuse_color);
+			model.drawSubmesh(i);
+		}
 
 		window.swapBuffers();
 	}
@@ -7,6 +7,7 @@
 
 #include "Entities.h"
 
+#include <algorithm>
 #include <chrono>
 #include <fstream>
 #include <functional>
@@ -129,8 +130,9 @@ class Level {
 
 		// Enable blending for transparency
 		// FIXME: This should be done somewhere else
-		glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-		glEnable(GL_BLEND);
+		auto &state = StateCache::get();
+		state.setBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+		state.setEnabled(GL_BLEND, true);
 
 		// Create shader program
 		const auto paths = {"resources/shaders/pacman.vert"s,
@@ -295,14 +297,22 @@ class Level {
 			if (std::holds_alternative<Pacman>(entity)) { // Update pacman
 				auto &pacman = std::get<Pacman>(entity);
 
-				// Pass input if there is any
-				if (!m_input_queue->empty()) {
-					auto key = m_input_queue->back();
-					pacman.onInput(key.code, m_entities);
+				// Move pacman up to the time of every input before turning
+				// him, so that several inputs in one frame all count
+				const auto end  = glfwGetTime();
+				auto       time = end - static_cast<double>(dt.count());
+				while (const auto input = m_input_queue->pop()) {
+					if (input->state == InputState::Released)
+						continue;
+
+					const auto at = std::clamp(input->time, time, end);
+					pacman.update(Duration(at - time), m_entities);
+					pacman.onInput(input->code, m_entities);
+					time = at;
 				}
 
 				// Update
-				pacman.update(dt, m_entities);
+				pacman.update(Duration(end - time), m_entities);
 
 				// Check if the game should end
 				if (!pacman.active()) {
@@ -364,7 +374,7 @@ class Level {
 
 		// I don't know how or why this works, but it does, and that's what
 		// counts ;-)
-		glViewport(0, 0, h, h);
+		StateCache::get().setViewport(glm::ivec4(0, 0, h, h));
 		auto projection =
 		    glm::ortho(0.0f, (float)m_height, 0.0f, (float)m_height);
 
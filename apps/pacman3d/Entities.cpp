@@ -4,24 +4,152 @@
 #include "generation.h"
 
 #include <algorithm>
+#include <numeric>
 #include <random>
+#include <tuple>
 #include <utility>
 
+/**
+ * @brief Width and height of a maze chunk in cells.
+ */
+static constexpr int gChunkSize = 8;
+
+/**
+ * @brief Sort the triangles of the maze mesh into one submesh per chunk of
+ * cells. Triangles larger than a chunk, i.e. the floor, get a submesh of their
+ * own.
+ */
+static void split_into_chunks(MeshData &mesh, const Level &level) {
+	const auto [w, h]         = level.getSize();
+	const auto chunks_x       = (w + gChunkSize - 1) / gChunkSize;
+	const auto chunks_z       = (h + gChunkSize - 1) / gChunkSize;
+	const auto chunk_count    = static_cast<size_t>(chunks_x * chunks_z);
+	const auto triangle_count = mesh.indices.size() / 3;
+
+	std::vector<size_t> chunk_of(triangle_count);
+	for (size_t i = 0; i < triangle_count; ++i) {
+		const auto &a = mesh.vertices[mesh.indices[i * 3 + 0]].pos;
+		const auto &b = mesh.vertices[mesh.indices[i * 3 + 1]].pos;
+		const auto &c = mesh.vertices[mesh.indices[i * 3 + 2]].pos;
+
+		const auto extent =
+		    glm::max(glm::max(a, b), c) - glm::min(glm::min(a, b), c);
+		if (extent.x > gChunkSize || extent.z > gChunkSize) {
+			chunk_of[i] = chunk_count;
+			continue;
+		}
+
+		const auto centroid = (a + b + c) / 3.0f;
+		const auto x = std::clamp(static_cast<int>(centroid.x) / gChunkSize, 0,
+		                          chunks_x - 1);
+		const auto z = std::clamp(static_cast<int>(centroid.z) / gChunkSize, 0,
+		                          chunks_z - 1);
+		chunk_of[i]  = static_cast<size_t>(z * chunks_x + x);
+	}
+
+	// Counting sort of the triangles by chunk
+	std::vector<uint32_t> offsets(chunk_count + 2, 0);
+	for (const auto chunk : chunk_of)
+		offsets[chunk + 1]++;
+	std::partial_sum(begin(offsets), end(offsets), begin(offsets));
+
+	std::vector<GLuint> indices(mesh.indices.size());
+	auto                next = offsets;
+	for (size_t i = 0; i < triangle_count; ++i) {
+		const auto triangle = next[chunk_of[i]]++;
+		std::copy_n(begin(mesh.indices) + i * 3, 3,
+		            begin(indices) + triangle * 3);
+	}
+	mesh.indices = std::move(indices);
+
+	mesh.submeshes.clear();
+	for (size_t chunk = 0; chunk <= chunk_count; ++chunk) {
+		const auto count = offsets[chunk + 1] - offsets[chunk];
+		if (count > 0)
+			mesh.submeshes.push_back({offsets[chunk] * 3, count * 3, 0, 0});
+	}
+}
+
 Maze::Maze(const Level &level) {
-	auto [vertices, indices] = genLevelMesh(level);
-	m_vbo = std::make_unique<VertexBuffer<Vertex3DNormTex>>(vertices, indices);
+	auto mesh = MeshData{};
+	std::tie(mesh.vertices, mesh.indices) = genLevelMesh(level);
+	split_into_chunks(mesh, level);
+
+	for (const auto index : mesh.indices) {
+		const auto &vertex = mesh.vertices[index];
+		if (vertex.normal.y == 0.0f)
+			m_occluders.push_back(vertex.pos);
+	}
+
+	m_stats = optimizeMesh(mesh);
+
+	for (auto &chunk : mesh.submeshes)
+		chunk.bounds = computeBounds(mesh, chunk);
+	m_chunks = std::move(mesh.submeshes);
+
+	m_vbo = std::make_unique<VertexBuffer<Vertex3DNormTex>>(mesh.vertices,
+	                                                        mesh.indices);
 }
 
-Pellets::Pellets(std::vector<glm::vec3> centroids)
-    : m_centroids(std::move(centroids)) {
-	m_sphere = std::make_unique<Model>("resources/models/sphere.obj");
-	m_sphere->enableInstancing<glm::mat4>();
-	upload();
+void Maze::draw(const Frustum &frustum) const {
+	const auto transform = getTransform();
+	for (const auto &chunk : m_chunks) {
+		if (frustum.intersects(chunk.bounds, transform))
+			m_vbo->drawRange(chunk.index_offset, chunk.index_count,
+			                 static_cast<GLint>(chunk.base_vertex));
+	}
 }
 
-auto Pellets::update(const Pacman &pacman) -> bool {
-	auto before = m_centroids.size();
+/**
+ * @brief Scale of the pellet spheres.
+ */
+static constexpr float gPelletScale = 0.2f;
+
+/**
+ * @brief Number of pellets culled by each compute shader work group.
+ */
+static constexpr GLuint gCullGroupSize = 64;
 
+Pellets::Pellets(std::vector<glm::vec3>     centroids,
+                 std::shared_ptr<AsyncModel> sphere)
+    : m_sphere(std::move(sphere)), m_centroids(std::move(centroids)),
+      m_capacity(m_centroids.size()), m_dirty(true) {
+	m_centroid_buffer   = std::make_unique<Buffer>(
+	    std::max<size_t>(m_capacity, 1) * sizeof(glm::vec4));
+	m_visibility_buffer = std::make_unique<Buffer>(
+	    std::max<size_t>(m_capacity, 1) * sizeof(GLuint));
+
+	using namespace std::string_literals;
+	const auto cull_shaders = {"resources/shaders/cull_pellets.comp"s};
+	m_cull_shader           = std::make_unique<ShaderProgram>(cull_shaders);
+}
+
+auto Pellets::prepare() -> bool {
+	if (m_command_buffer)
+		return true;
+	if (!m_sphere->ready())
+		return false;
+
+	auto *sphere = m_sphere->get();
+	sphere->enableInstancing<glm::mat4>();
+
+	// Every level of detail gets room for all the pellets in the instance
+	// buffer, as the culling does not know up front how many end up in each
+	const auto lod_count = sphere->getLodCount();
+	sphere->uploadInstanceData(
+	    std::vector<glm::mat4>(lod_count * std::max<size_t>(m_capacity, 1)));
+
+	for (size_t lod = 0; lod < lod_count; ++lod) {
+		const auto commands = sphere->indirectCommands(
+		    lod, static_cast<GLuint>(lod * m_capacity));
+		m_commands.insert(end(m_commands), begin(commands), end(commands));
+	}
+	m_command_buffer = std::make_unique<Buffer>(m_commands);
+
+	return true;
+}
+
+auto Pellets::update(const Pacman &pacman) -> bool {
 	// Check for collision with pacman, and delete colliding pellets.
 	// TODO: Can we instead only check and remove the closets pellet, only one
 	// can be picked up at a time anyway?
@@ -29,41 +157,103 @@ auto Pellets::update(const Pacman &pacman) -> bool {
 	    begin(m_centroids), end(m_centroids), [&](const auto &c) {
 		    return glm::length(c - pacman.getPosition()) <= 0.4f;
 	    });
+	m_dirty |= remove != end(m_centroids);
+	m_eaten.insert(end(m_eaten), remove, end(m_centroids));
 	m_centroids.erase(remove, end(m_centroids));
 
-	auto after = m_centroids.size();
-
-	// Update transforms if they changed
-	if (before != after)
-		upload();
-
 	// Return true if pacman has eaten all the pellets
 	return m_centroids.empty();
 }
 
-void Pellets::draw() const { m_sphere->draw(); }
+void Pellets::cull(const Frustum &frustum, float pixels_per_unit,
+                   const std::optional<glm::vec3> &eye,
+                   const OcclusionCuller *         occlusion) {
+	if (!prepare())
+		return;
 
-void Pellets::upload() const {
-	// Build instance data from centroids
-	std::vector<glm::mat4> transforms;
-	transforms.reserve(m_centroids.size());
+	const auto *sphere = m_sphere->get();
 
-	for (const auto &centroid : m_centroids) {
-		const auto transform = glm::scale(
-		    glm::translate(glm::mat4(1.0f), centroid), glm::vec3(0.2f));
-		transforms.push_back(transform);
+	// Only upload the centroids again after pellets are eaten
+	if (m_dirty) {
+		std::vector<glm::vec4> centroids;
+		centroids.reserve(m_centroids.size());
+		for (const auto &centroid : m_centroids)
+			centroids.emplace_back(centroid, 0.0f);
+		m_centroid_buffer->upload(centroids);
+		m_dirty = false;
 	}
 
-	// Upload the instance data
-	m_sphere->uploadInstanceData(transforms);
+	// Occlusion changes with every view, so it is tested and uploaded every
+	// time
+	if (occlusion) {
+		const auto &bounds = sphere->getBounds();
+		const auto  min    = bounds.min * gPelletScale;
+		const auto  max    = bounds.max * gPelletScale;
+
+		std::vector<GLuint> visible;
+		visible.reserve(m_centroids.size());
+		for (const auto &centroid : m_centroids)
+			visible.push_back(
+			    occlusion->isVisible(centroid + min, centroid + max));
+		m_visibility_buffer->upload(visible);
+	}
+
+	// Reset the instance counts, the shader counts the visible pellets again
+	m_command_buffer->upload(m_commands);
+
+	const auto &bounds = sphere->getBounds();
+	m_cull_shader->use();
+	m_cull_shader->setUniform(
+	    "u_planes",
+	    std::vector<glm::vec4>(begin(frustum.planes), end(frustum.planes)));
+	m_cull_shader->setUniform("u_bounds",
+	                          glm::vec4(bounds.center, bounds.radius));
+	m_cull_shader->setUniform("u_scale", gPelletScale);
+	m_cull_shader->setUniform("u_pellet_count",
+	                          static_cast<GLuint>(m_centroids.size()));
+	m_cull_shader->setUniform("u_capacity", static_cast<GLuint>(m_capacity));
+	m_cull_shader->setUniform(
+	    "u_submesh_count",
+	    static_cast<GLuint>(sphere->getSubmeshes().size()));
+	m_cull_shader->setUniform("u_lod_count",
+	                          static_cast<GLuint>(sphere->getLodCount()));
+	m_cull_shader->setUniform("u_lod_errors", sphere->getLodErrors());
+	m_cull_shader->setUniform("u_eye", eye.value_or(glm::vec3(0.0f)));
+	m_cull_shader->setUniform("u_pixels_per_unit", pixels_per_unit);
+	m_cull_shader->setUniform("u_perspective",
+	                          static_cast<GLuint>(eye.has_value()));
+	m_cull_shader->setUniform("u_occlusion",
+	                          static_cast<GLuint>(occlusion != nullptr));
+
+	m_centroid_buffer->bindBase(GL_SHADER_STORAGE_BUFFER, 0);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, sphere->getInstanceBuffer());
+	m_command_buffer->bindBase(GL_SHADER_STORAGE_BUFFER, 2);
+	m_visibility_buffer->bindBase(GL_SHADER_STORAGE_BUFFER, 3);
+
+	const auto groups = static_cast<GLuint>(
+	    (m_centroids.size() + gCullGroupSize - 1) / gCullGroupSize);
+	if (groups > 0)
+		m_cull_shader->dispatch(groups);
+
+	// The draws read the instances as vertex attributes, and the counts as
+	// indirect commands
+	glMemoryBarrier(GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT |
+	                GL_COMMAND_BARRIER_BIT);
 }
 
-Pacman::Pacman(glm::vec3 position) : m_yaw(0.0f) {
-	m_forward   = glm::vec3(0.0f, 0.0f, 0.0f);
-	m_transform = {position, glm::vec3(0.0f), glm::vec3(0.25f)};
+void Pellets::draw() const {
+	if (m_command_buffer)
+		m_sphere->get()->drawIndirect(*m_command_buffer, 0, m_commands.size());
+}
+
+Pacman::Pacman(glm::vec3 position, std::shared_ptr<AsyncModel> model)
+    : m_yaw(0.0f), m_model(std::move(model)) {
+	m_forward      = glm::vec3(0.0f, 0.0f, 0.0f);
+	m_transform    = {position, glm::vec3(0.0f), glm::vec3(0.25f)};
+	m_previous     = m_transform;
+	m_interpolated = m_transform;
 	// FIXME: Aspect ratio needs to be updated when the window is resized
 	m_camera = CameraComponent(16.0f / 9.0f, 96.0f);
-	m_model = std::make_unique<Model>("resources/models/sphere.obj");
 }
 
 void Pacman::input(Input input) {
@@ -93,6 +283,7 @@ void Pacman::input(Input input) {
 }
 
 void Pacman::update(float dt, const Level &level) {
+	m_previous = m_transform;
 	m_transform.rotation.y += m_yaw * dt;
 
 	const auto translation =
@@ -110,21 +301,33 @@ void Pacman::update(float dt, const Level &level) {
 	}
 }
 
-void Pacman::draw() const {
-	m_model->draw();
+void Pacman::interpolate(float alpha) {
+	m_interpolated = TransformComponent::mix(m_previous, m_transform, alpha);
+}
+
+void Pacman::draw(size_t lod) const { m_model->draw(lod); }
+
+auto Pacman::selectLod(float pixels_per_unit) const -> size_t {
+	const auto *model = m_model->get();
+	return model ? model->selectLod(pixels_per_unit * m_transform.scale.x)
+	             : 0;
 }
 
 void Pacman::updateAspectRatio(float aspect) {
 	m_camera.aspect = aspect;
 }
 
-Ghost::Ghost(glm::vec3 position, std::shared_ptr<Model> model)
+Ghost::Ghost(glm::vec3 position, std::shared_ptr<AsyncModel> model)
     : m_model(std::move(model)) {
-	m_forward   = glm::vec3(1.0f, 0.0f, 0.0f);
-	m_transform = {position, glm::vec3(0.0f), glm::vec3(0.25f)};
+	m_forward      = glm::vec3(1.0f, 0.0f, 0.0f);
+	m_transform    = {position, glm::vec3(0.0f), glm::vec3(0.25f)};
+	m_previous     = m_transform;
+	m_interpolated = m_transform;
 }
 
 auto Ghost::update(float dt, const Pacman &pacman, const Level &level) -> bool {
+	m_previous = m_transform;
+
 	// Find new pos based on pos, forward and dt
 	const auto translation = m_transform.translation + m_forward * dt;
 
@@ -159,4 +362,35 @@ auto Ghost::update(float dt, const Pacman &pacman, const Level &level) -> bool {
 	return pacman_collision;
 }
 
-void Ghost::draw() const { m_model->draw(); }
+void Ghost::interpolate(float alpha) {
+	m_interpolated = TransformComponent::mix(m_previous, m_transform, alpha);
+}
+
+void Ghost::draw(size_t lod) const { m_model->draw(lod); }
+
+void Ghost::draw(const Frustum &frustum, size_t lod) const {
+	if (auto *model = m_model->get())
+		model->drawVisible(frustum, getTransform(), lod);
+}
+
+void Ghost::record(CommandList &list, const Frustum &frustum,
+                   size_t lod) const {
+	if (const auto *model = m_model->get()) {
+		const auto transform = getTransform();
+		if (frustum.intersects(model->getBounds(), transform)) {
+			list.setUniform("u_transform", transform);
+			model->recordVisible(list, frustum, transform, lod);
+		}
+	}
+}
+
+auto Ghost::isVisible(const OcclusionCuller &culler) const -> bool {
+	const auto *model = m_model->get();
+	return !model || culler.isVisible(model->getBounds(), getTransform());
+}
+
+auto Ghost::selectLod(float pixels_per_unit) const -> size_t {
+	const auto *model = m_model->get();
+	return model ? model->selectLod(pixels_per_unit * m_transform.scale.x)
+	             : 0;
+}
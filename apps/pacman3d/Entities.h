@@ -1,9 +1,13 @@
 #pragma once
 
 #include <glove/lib.h>
+#include <optional>
+#include <utility>
 
 /**
  * @brief The level Maze.
+ * The maze mesh is split into square chunks of cells, so that the chunks
+ * outside the view can be culled.
  */
 class Maze {
   public:
@@ -14,24 +18,60 @@ class Maze {
 	 */
 	void draw() const { m_vbo->draw(); }
 
+	/**
+	 * @brief Draw the chunks of the maze that are inside a view frustum.
+	 * @param frustum View frustum in world space.
+	 */
+	void draw(const Frustum &frustum) const;
+
 	/**
 	 * @brief Get the transformation matrix for rendering.
 	 * @return The transformation matrix.
 	 */
 	[[nodiscard]] auto getTransform() const { return glm::mat4(1.0f); }
 
+	/**
+	 * @brief Get the wall faces, for occlusion culling. The floor and the tops
+	 * of the walls hide nothing from inside the maze, so they are left out.
+	 * @return Triangle list in world space.
+	 */
+	[[nodiscard]] auto getOccluders() const -> const std::vector<glm::vec3> & {
+		return m_occluders;
+	}
+
+	/**
+	 * @brief Get how much optimizing the maze mesh improved its vertex cache
+	 * use.
+	 * @return Vertex cache efficiency before and after.
+	 */
+	[[nodiscard]] auto getOptimizerStats() const -> const MeshOptimizerStats & {
+		return m_stats;
+	}
+
   private:
 	std::unique_ptr<VertexBuffer<Vertex3DNormTex>> m_vbo;
+	std::vector<Submesh> m_chunks; ///< Index ranges and bounds of the chunks.
+	std::vector<glm::vec3> m_occluders; ///< Wall faces, three per triangle.
+	MeshOptimizerStats     m_stats;     ///< Vertex cache efficiency.
 };
 
 /**
  * @brief The pellets in the level.
  * Implements drawing all the pellets as spheres using instanced rendering, in
  * addition to detecting collisions between pellets and pacman.
+ *
+ * The pellets are culled on the GPU. A compute shader tests every pellet
+ * against the frustum, writes the visible ones into the instance buffer and
+ * counts them in indirect draw commands, so nothing is read back or uploaded
+ * per frame.
+ *
+ * The sphere model may still be loading, in which case the pellets are
+ * neither culled nor drawn.
  */
 class Pellets {
   public:
-	Pellets(std::vector<glm::vec3> centroids);
+	Pellets(std::vector<glm::vec3> centroids,
+	        std::shared_ptr<AsyncModel> sphere);
 
 	/**
 	 * @brief Update the internal state of all the pellets.
@@ -41,29 +81,78 @@ class Pellets {
 	[[nodiscard]] auto update(const class Pacman &pacman) -> bool;
 
 	/**
-	 * @brief Draw all the pellets.
+	 * @brief Take the positions of the pellets eaten since the last call.
+	 * @return Positions of the eaten pellets.
+	 */
+	auto takeEaten() -> std::vector<glm::vec3> {
+		return std::exchange(m_eaten, {});
+	}
+
+	/**
+	 * @brief Get the positions of the remaining pellets.
+	 * @return Center positions of the pellets.
+	 */
+	[[nodiscard]] auto getCentroids() const -> const std::vector<glm::vec3> & {
+		return m_centroids;
+	}
+
+	/**
+	 * @brief Cull the pellets against a view frustum on the GPU, and pick the
+	 * level of detail of every visible pellet.
+	 * Every render pass that draws pellets should call this first, with its
+	 * own view.
+	 * @param frustum View frustum in world space.
+	 * @param pixels_per_unit How many pixels one world space unit covers on
+	 * screen. At unit distance from the eye, if there is one.
+	 * @param eye Position of a perspective camera, or nothing for an
+	 * orthographic one.
+	 * @param occlusion Occlusion culler rendered from the same view, to also
+	 * cull the pellets hidden behind walls, or nullptr.
+	 */
+	void cull(const Frustum &frustum, float pixels_per_unit,
+	          const std::optional<glm::vec3> &eye       = std::nullopt,
+	          const OcclusionCuller *         occlusion = nullptr);
+
+	/**
+	 * @brief Draw the pellets that survived the last cull, with one indirect
+	 * draw per submesh and level of detail.
 	 */
 	void draw() const;
 
   private:
 	/**
-	 * @brief Build and upload the instance data for all the pellets.
+	 * @brief Set up the instances and draw commands of the sphere, once it is
+	 * loaded.
+	 * @return Is the sphere ready to cull and draw?
 	 */
-	void upload() const;
+	auto prepare() -> bool;
 
-  private:
-	std::unique_ptr<Model> m_sphere;
+	std::shared_ptr<AsyncModel> m_sphere; ///< Model of every pellet.
 	std::vector<glm::vec3>
 	    m_centroids; ///< Center positions for all the pellets.
+	std::vector<glm::vec3>
+	    m_eaten; ///< Pellets eaten since the last "takeEaten".
+	size_t m_capacity; ///< Number of pellets at the start of the level.
+	bool   m_dirty;    ///< Have pellets been removed since the last upload?
+	std::unique_ptr<Buffer>
+	    m_centroid_buffer; ///< Centroids of the remaining pellets, for culling.
+	std::unique_ptr<Buffer>
+	    m_visibility_buffer; ///< Is every pellet unoccluded, for culling.
+	std::unique_ptr<Buffer>
+	    m_command_buffer; ///< Indirect draw commands, one per submesh and lod.
+	std::vector<DrawElementsIndirectCommand>
+	    m_commands; ///< The commands with zero instances, for resetting.
+	std::unique_ptr<ShaderProgram> m_cull_shader; ///< Culling compute shader.
 };
 
 /**
  * @brief Pacman.
  * Also owns the camera used to render the game from first person perspective.
+ * Pacman's model may still be loading, in which case nothing is drawn.
  */
 class Pacman {
   public:
-	Pacman(glm::vec3 position);
+	Pacman(glm::vec3 position, std::shared_ptr<AsyncModel> model);
 
 	/**
 	 * @brief Pass input to pacman.
@@ -79,9 +168,24 @@ class Pacman {
 	void update(float dt, const class Level &level);
 
 	/**
-	 * @brief Draw pacman to the minimap.
+	 * @brief Place pacman between the previous tick and the last, for the
+	 * camera and drawing.
+	 * @param alpha How far from the previous tick to the last.
 	 */
-	void draw() const;
+	void interpolate(float alpha);
+
+	/**
+	 * @brief Draw pacman.
+	 * @param lod Level of detail to draw.
+	 */
+	void draw(size_t lod = 0) const;
+
+	/**
+	 * @brief Pick the level of detail to draw pacman with.
+	 * @param pixels_per_unit Pixels one world space unit covers on screen.
+	 * @return Level of detail.
+	 */
+	[[nodiscard]] auto selectLod(float pixels_per_unit) const -> size_t;
 
 	/**
 	 * @brief Update the aspect ratio of pacman's camera.
@@ -90,16 +194,24 @@ class Pacman {
 	void updateAspectRatio(float aspect);
 
 	/**
-	 * @brief Get pacman's position.
+	 * @brief Get pacman's position as of the last tick.
 	 * @return Pacman's position.
 	 */
 	[[nodiscard]] auto getPosition() const { return m_transform.translation; }
 
+	/**
+	 * @brief Get pacman's position as drawn, see "interpolate".
+	 * @return Pacman's position.
+	 */
+	[[nodiscard]] auto getDrawnPosition() const {
+		return m_interpolated.translation;
+	}
+
 	/**
 	 * @brief Get the view matrix from pacman's camera.
 	 * @return The view matrix.
 	 */
-	[[nodiscard]] auto view() const { return m_camera.view(m_transform); }
+	[[nodiscard]] auto view() const { return m_camera.view(m_interpolated); }
 
 	/**
 	 * @brief Get the projection matrix from pacman's camera.
@@ -108,25 +220,44 @@ class Pacman {
 	[[nodiscard]] auto projection() const { return m_camera.projection(); }
 
 	/**
-	 * @brief Get pacman's transform matrix.
+	 * @brief Get the view frustum of pacman's camera.
+	 * @return The frustum in world space.
+	 */
+	[[nodiscard]] auto frustum() const {
+		return m_camera.frustum(m_interpolated);
+	}
+
+	/**
+	 * @brief Get pacman's camera.
+	 * @return The camera.
+	 */
+	[[nodiscard]] auto getCamera() const -> const CameraComponent & {
+		return m_camera;
+	}
+
+	/**
+	 * @brief Get pacman's transform matrix, as interpolated.
 	 * @return The transform matrix.
 	 */
-	[[nodiscard]] auto getTransform() const { return m_transform.matrix(); }
+	[[nodiscard]] auto getTransform() const { return m_interpolated.matrix(); }
 
   private:
-	float                  m_yaw;     ///< Yaw for delta rotation from input.
-	glm::vec3              m_forward; ///< Forward direction based on input.
-	TransformComponent     m_transform;
-	CameraComponent        m_camera;
-	std::unique_ptr<Model> m_model; ///< Model for the minimap.
+	float                       m_yaw;          ///< Yaw speed from input.
+	glm::vec3                   m_forward;      ///< Forward direction of input.
+	TransformComponent          m_transform;    ///< Transform of the last tick.
+	TransformComponent          m_previous;     ///< Transform a tick before.
+	TransformComponent          m_interpolated; ///< Transform drawn.
+	CameraComponent             m_camera;
+	std::shared_ptr<AsyncModel> m_model; ///< Model of pacman.
 };
 
 /**
  * @brief Ghost.
+ * The ghost's model may still be loading, in which case nothing is drawn.
  */
 class Ghost {
   public:
-	Ghost(glm::vec3 position, std::shared_ptr<Model> model);
+	Ghost(glm::vec3 position, std::shared_ptr<AsyncModel> model);
 
 	/**
 	 * @brief Update the internal state of an individual Ghost.
@@ -138,19 +269,74 @@ class Ghost {
 	[[nodiscard]] auto update(float dt, const Pacman &pacman,
 	                          const class Level &level) -> bool;
 
+	/**
+	 * @brief Place the ghost between the previous tick and the last, for
+	 * drawing.
+	 * @param alpha How far from the previous tick to the last.
+	 */
+	void interpolate(float alpha);
+
 	/**
 	 * @brief Draw the ghost.
+	 * @param lod Level of detail to draw.
 	 */
-	void draw() const;
+	void draw(size_t lod = 0) const;
+
+	/**
+	 * @brief Draw the ghost if it is inside a view frustum.
+	 * @param frustum View frustum in world space.
+	 * @param lod Level of detail to draw.
+	 */
+	void draw(const Frustum &frustum, size_t lod) const;
+
+	/**
+	 * @brief Record drawing the ghost if it is inside a view frustum, see
+	 * draw. Sets u_transform of the program used last in the list.
+	 * @param list Command list to record into.
+	 * @param frustum View frustum in world space.
+	 * @param lod Level of detail to draw.
+	 */
+	void record(CommandList &list, const Frustum &frustum, size_t lod) const;
+
+	/**
+	 * @brief Test if the ghost is hidden behind the occluders.
+	 * @param culler Occlusion culler rendered from the view to test in.
+	 * @return Is any part of the ghost visible?
+	 */
+	[[nodiscard]] auto isVisible(const OcclusionCuller &culler) const -> bool;
+
+	/**
+	 * @brief Pick the level of detail to draw the ghost with.
+	 * @param pixels_per_unit Pixels one world space unit covers on screen.
+	 * @return Level of detail.
+	 */
+	[[nodiscard]] auto selectLod(float pixels_per_unit) const -> size_t;
+
+	/**
+	 * @brief Get the ghost's position as of the last tick.
+	 * @return The ghost's position.
+	 */
+	[[nodiscard]] auto getPosition() const { return m_transform.translation; }
+
+	/**
+	 * @brief Get the ghost's position as drawn, see "interpolate".
+	 * @return The ghost's position.
+	 */
+	[[nodiscard]] auto getDrawnPosition() const {
+		return m_interpolated.translation;
+	}
 
 	/**
-	 * @brief Get the transformation matrix for passing to shaders.
+	 * @brief Get the transformation matrix for passing to shaders, as
+	 * interpolated.
 	 * @return Entities transformation matrix.
 	 */
-	[[nodiscard]] auto getTransform() const { return m_transform.matrix(); }
+	[[nodiscard]] auto getTransform() const { return m_interpolated.matrix(); }
 
   private:
-	glm::vec3              m_forward; ///< Forward direction based on input.
-	TransformComponent     m_transform;
-	std::shared_ptr<Model> m_model;
+	glm::vec3                   m_forward;      ///< Forward direction.
+	TransformComponent          m_transform;    ///< Transform of the last tick.
+	TransformComponent          m_previous;     ///< Transform a tick before.
+	TransformComponent          m_interpolated; ///< Transform drawn.
+	std::shared_ptr<AsyncModel> m_model;
 };
@@ -0,0 +1,148 @@
+#include "Minimap.h"
+
+#include "Entities.h"
+#include "Level.h"
+
+#include <cassert>
+
+/**
+ * @brief A point sprite on the minimap, laid out like the std430 struct in
+ * minimap_sprites.vert.
+ */
+struct MinimapSprite {
+	glm::vec4 position; ///< Position in cells in xy, radius in cells in z.
+	glm::vec4 color;    ///< Color of the sprite.
+};
+
+/**
+ * @brief Radius of the sprites in cells.
+ */
+static constexpr float gSpriteRadius = 0.45f;
+
+/**
+ * @brief Texture unit of the grid, apart from the units the scene samples
+ * from, so that drawing the map does not change what the scene sees.
+ */
+static constexpr GLuint gGridSlot = 2;
+
+/**
+ * @brief Get the cell a position in the level is in.
+ */
+static auto cell_of(const glm::vec3 &position) -> glm::ivec2 {
+	return glm::ivec2(std::floor(position.x), std::floor(position.z));
+}
+
+Minimap::Minimap(const Level &level, const std::vector<glm::vec3> &pellets)
+    : m_sprite_count(0) {
+	const auto [w, h] = level.getSize();
+	m_size            = glm::ivec2(w, h);
+
+	// Only walls and pellets are drawn from the grid, pacman and the ghosts
+	// move around as sprites
+	std::vector<uint8_t> cells(static_cast<size_t>(w * h));
+	for (int j = 0; j < h; ++j) {
+		for (int i = 0; i < w; ++i) {
+			const auto wall = level.get(i, j) == EntityType::Wall;
+			cells[j * w + i] = static_cast<uint8_t>(
+			    wall ? EntityType::Wall : EntityType::Tunnel);
+		}
+	}
+	for (const auto &pellet : pellets) {
+		const auto cell = cell_of(pellet);
+		cells[cell.y * w + cell.x] = static_cast<uint8_t>(EntityType::Pellet);
+	}
+
+	glGenTextures(1, &m_grid_texture);
+	StateCache::get().bindTexture(GL_TEXTURE_2D, m_grid_texture);
+	glTexStorage2D(GL_TEXTURE_2D, 1, GL_R8UI, w, h);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	glTextureSubImage2D(m_grid_texture, 0, 0, 0, w, h, GL_RED_INTEGER,
+	                    GL_UNSIGNED_BYTE, cells.data());
+
+	// Integer textures can only be sampled with nearest filtering
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+	glGenVertexArrays(1, &m_vao);
+
+	using namespace std::string_literals;
+	const auto grid_shaders = {"resources/shaders/minimap_grid.vert"s,
+	                           "resources/shaders/minimap_grid.frag"s};
+	m_grid_shader = std::make_unique<ShaderProgram>(grid_shaders);
+
+	const auto sprite_shaders = {"resources/shaders/minimap_sprites.vert"s,
+	                             "resources/shaders/minimap_sprites.frag"s};
+	m_sprite_shader = std::make_unique<ShaderProgram>(sprite_shaders);
+}
+
+Minimap::~Minimap() {
+	auto &state = StateCache::get();
+	state.deleteTextures(1, &m_grid_texture);
+	state.deleteVertexArray(m_vao);
+}
+
+void Minimap::removePellet(const glm::vec3 &position) {
+	const auto cell = cell_of(position);
+	assert(cell.x >= 0 && cell.x < m_size.x && cell.y >= 0 &&
+	       cell.y < m_size.y);
+
+	const auto tunnel = static_cast<uint8_t>(EntityType::Tunnel);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	glTextureSubImage2D(m_grid_texture, 0, cell.x, cell.y, 1, 1,
+	                    GL_RED_INTEGER, GL_UNSIGNED_BYTE, &tunnel);
+}
+
+void Minimap::update(const Pacman &pacman, const std::vector<Ghost> &ghosts) {
+	std::vector<MinimapSprite> sprites;
+	sprites.reserve(ghosts.size() + 1);
+
+	const auto sprite = [](const glm::vec3 &position, const glm::vec4 &color) {
+		return MinimapSprite{
+		    glm::vec4(position.x, position.z, gSpriteRadius, 0.0f), color};
+	};
+	sprites.push_back(
+	    sprite(pacman.getDrawnPosition(), glm::vec4(0.0f, 0.0f, 1.0f, 1.0f)));
+	for (const auto &ghost : ghosts)
+		sprites.push_back(sprite(ghost.getDrawnPosition(),
+		                         glm::vec4(0.0f, 1.0f, 0.0f, 1.0f)));
+
+	const auto size = sprites.size() * sizeof(MinimapSprite);
+	if (!m_sprite_buffer || m_sprite_buffer->getSize() < size)
+		m_sprite_buffer = std::make_unique<Buffer>(size);
+	m_sprite_buffer->upload(sprites);
+	m_sprite_count = sprites.size();
+}
+
+void Minimap::draw(glm::ivec4 region) const {
+	auto &state = StateCache::get();
+
+	state.setViewport(region);
+
+	// The map is an overlay, it is neither tested against nor written to the
+	// depth of the scene
+	state.setEnabled(GL_DEPTH_TEST, false);
+	state.bindVertexArray(m_vao);
+	state.bindTexture(gGridSlot, GL_TEXTURE_2D, m_grid_texture);
+
+	m_grid_shader->use();
+	m_grid_shader->setUniform("u_grid", gGridSlot);
+	m_grid_shader->setUniform("u_level_size", m_size);
+	glDrawArraysInstanced(GL_TRIANGLES, 0, 3, 1);
+
+	if (m_sprite_count > 0) {
+		const auto pixels_per_cell = static_cast<float>(region.w) /
+		                             static_cast<float>(m_size.y);
+
+		m_sprite_buffer->bindBase(GL_SHADER_STORAGE_BUFFER, 0);
+
+		state.setEnabled(GL_PROGRAM_POINT_SIZE, true);
+		m_sprite_shader->use();
+		m_sprite_shader->setUniform("u_level_size", m_size);
+		m_sprite_shader->setUniform("u_pixels_per_cell", pixels_per_cell);
+		glDrawArraysInstanced(GL_POINTS, 0,
+		                      static_cast<GLsizei>(m_sprite_count), 1);
+		state.setEnabled(GL_PROGRAM_POINT_SIZE, false);
+	}
+
+	state.setEnabled(GL_DEPTH_TEST, true);
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <glove/lib.h>
+#include <memory>
+#include <vector>
+
+/**
+ * @brief Top down map of the level in a corner of the screen.
+ *
+ * The level grid is uploaded once as a small integer texture and drawn with a
+ * single full screen triangle. Only the cells that change, i.e. eaten
+ * pellets, are uploaded again. Pacman and the ghosts are drawn on top as point
+ * sprites, from one small buffer of positions.
+ */
+class Minimap {
+  public:
+	/**
+	 * @brief Upload the level grid.
+	 * @param level The level.
+	 * @param pellets Positions of the pellets in the level.
+	 */
+	Minimap(const class Level &level, const std::vector<glm::vec3> &pellets);
+
+	Minimap(const Minimap &other) = delete;
+
+	Minimap(const Minimap &&other) = delete;
+
+	auto operator=(const Minimap &other) = delete;
+
+	auto operator=(const Minimap &&other) = delete;
+
+	~Minimap();
+
+	/**
+	 * @brief Remove an eaten pellet from the map.
+	 * @param position Position of the pellet.
+	 */
+	void removePellet(const glm::vec3 &position);
+
+	/**
+	 * @brief Upload the positions of pacman and the ghosts.
+	 * @param pacman Pacman entity.
+	 * @param ghosts All the ghosts in the level.
+	 */
+	void update(const class Pacman &            pacman,
+	            const std::vector<class Ghost> &ghosts);
+
+	/**
+	 * @brief Draw the map into a region of the bound framebuffer.
+	 * Leaves the viewport set to the region.
+	 * @param region Position and size of the region in pixels.
+	 */
+	void draw(glm::ivec4 region) const;
+
+  private:
+	glm::ivec2 m_size;         ///< Width and height of the level in cells.
+	GLuint     m_grid_texture; ///< One entity type per cell.
+	GLuint     m_vao;          ///< Empty vertex array, vertices are generated.
+	size_t     m_sprite_count; ///< Number of sprites in the sprite buffer.
+	std::unique_ptr<Buffer> m_sprite_buffer; ///< Positions and colors.
+	std::unique_ptr<ShaderProgram> m_grid_shader;   ///< Draws the grid.
+	std::unique_ptr<ShaderProgram> m_sprite_shader; ///< Draws the sprites.
+};
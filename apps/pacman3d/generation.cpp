@@ -180,14 +180,12 @@ auto findPacman(const Level &level) -> glm::vec3 {
     throw std::runtime_error("Pacman not found in level!");
 }
 
-auto genGhosts(const Level &level) -> std::vector<Ghost> {
+auto genGhosts(const Level &level, std::shared_ptr<AsyncModel> model)
+    -> std::vector<Ghost> {
     const auto [w, h] = level.getSize();
     std::vector<Ghost> ghosts;
     ghosts.reserve(4);
 
-    // Load model
-    auto model = std::make_shared<Model>("resources/models/sphere.obj");
-
     // Init random number generator
     std::random_device                    rd;
     std::default_random_engine            generator(rd());
@@ -209,7 +207,8 @@ auto genGhosts(const Level &level) -> std::vector<Ghost> {
     return ghosts;
 }
 
-auto genPellets(const Level &level) -> std::unique_ptr<Pellets> {
+auto genPellets(const Level &level, std::shared_ptr<AsyncModel> model)
+    -> std::unique_ptr<Pellets> {
     const auto [w, h] = level.getSize();
     std::vector<glm::vec3> pellets;
 
@@ -224,5 +223,5 @@ auto genPellets(const Level &level) -> std::unique_ptr<Pellets> {
         }
     }
 
-    return std::make_unique<Pellets>(pellets);
+    return std::make_unique<Pellets>(pellets, std::move(model));
 }
@@ -23,14 +23,18 @@ auto findPacman(const class Level &level) -> glm::vec3;
  * @brief Generate ghosts based on their position in the level.
  *
  * @param level Level.
+ * @param model Model shared by all the ghosts.
  * @return std::vector<class Ghost> Ghosts from the level.
  */
-auto genGhosts(const class Level &level) -> std::vector<class Ghost>;
+auto genGhosts(const class Level &level, std::shared_ptr<AsyncModel> model)
+    -> std::vector<class Ghost>;
 
 /**
  * @brief Generate pellets based on the level.
  *
  * @param level Level.
+ * @param model Model of a pellet.
  * @return std::unique_ptr<class Pellets> Pellets in the level.
  */
-auto genPellets(const class Level &level) -> std::unique_ptr<class Pellets>;
+auto genPellets(const class Level &level, std::shared_ptr<AsyncModel> model)
+    -> std::unique_ptr<class Pellets>;
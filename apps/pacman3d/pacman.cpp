@@ -1,8 +1,47 @@
 #include "Entities.h"
 #include "Level.h"
+#include "Minimap.h"
 #include "generation.h"
 
 #include <glove/lib.h>
+#include <iostream>
+
+/**
+ * @brief Time per frame spent uploading models loaded in the background.
+ */
+static constexpr auto gModelUploadBudget = std::chrono::microseconds(2000);
+
+/**
+ * @brief Shadow map cascades. Four 1024² cascades hold a quarter of the texels
+ * a single 4096² map would, but spend them where pacman can see.
+ */
+static constexpr GLsizei gCascadeResolution = 1024;
+static constexpr size_t  gCascadeCount      = 4;
+static constexpr float   gShadowDistance    = 30.0f;
+
+/**
+ * @brief GPU time per frame the main view is scaled to fit in, in
+ * milliseconds. A little under 60 Hz, leaving room for the upscale.
+ */
+static constexpr float gGpuFrameBudget = 15.0f;
+
+/**
+ * @brief Distance the render queue's depth keys span, the far plane of
+ * pacman's camera.
+ */
+static constexpr float gSortDistance = 100.0f;
+
+/**
+ * @brief Threads recording command lists, besides the main thread.
+ */
+static constexpr size_t gRecordThreads = 2;
+
+/**
+ * @brief Texture units the main view samples from. The minimap has a unit of
+ * its own.
+ */
+static constexpr GLuint gDiffuseMapSlot = 0;
+static constexpr GLuint gShadowMapSlot  = 1;
 
 /**
  * @brief Main game state of pacman 3d.
@@ -16,37 +55,45 @@ class GameState : public IGameState {
 		// **********************************************************************************************************
 		m_backbuffer = Framebuffer::defaultFramebuffer();
 
-		m_framebuffer = std::make_unique<Framebuffer>();
-		m_framebuffer->bind();
-		m_framebuffer->addAttachment(AttachmentType::Color,
-		                             glm::ivec2(280, 340));
-		m_framebuffer->addAttachment(AttachmentType::Depth,
-		                             glm::ivec2(280, 340));
-		assert(m_framebuffer->valid() && "Minimap framebuffer is not valid!");
-
-		m_shadow_framebuffer = std::make_unique<Framebuffer>();
-		m_shadow_framebuffer->bind();
-		m_shadow_framebuffer->addAttachment(AttachmentType::Depth,
-		                                    glm::ivec2(4096, 4096));
-		assert(m_shadow_framebuffer->valid() &&
-		       "Shadow map framebuffer is not valid!");
+		m_render_targets = std::make_unique<RenderTargetPool>();
+		m_shadow_map     = std::make_unique<CascadedShadowMap>(
+		    gCascadeResolution, gCascadeCount, gShadowDistance);
+
+		// The main view renders at a scale picked from the GPU frame time,
+		// into attachments the frame graph leases from the pool, and is
+		// upscaled into the backbuffer
+		m_frame_graph = std::make_unique<FrameGraph>(*m_render_targets);
+		m_scene_framebuffer  = std::make_unique<Framebuffer>();
+		m_gpu_timer          = std::make_unique<GpuTimer>();
+		m_gpu_profiler       = std::make_unique<GpuProfiler>();
+		m_dynamic_resolution = std::make_unique<DynamicResolution>(
+		    gGpuFrameBudget);
+
+		// Every pass of the frame graph is timed on the GPU
+		m_frame_graph->setProfiler(m_gpu_profiler.get());
+
+		m_lights       = std::make_unique<ClusteredLights>();
+		m_render_queue = std::make_unique<RenderQueue>();
+		m_commands     = std::make_unique<CommandQueue>(gRecordThreads);
 
 		// Setup opengl state
 		// **********************************************************************************************************
 
-		// FIXME: Do this more intelligently
-		// TODO: Figure out how to abstract OpenGL state management
+		// All state changes go through the state cache, which skips the ones
+		// that change nothing
+		auto &state = StateCache::get();
 
 		// Enable depth testing
-		glEnable(GL_DEPTH_TEST);
+		state.setEnabled(GL_DEPTH_TEST, true);
+		state.setDepthFunc(GL_LESS);
 
 		// Enable back face culling.
-		glEnable(GL_CULL_FACE);
-		glCullFace(GL_BACK);
+		state.setEnabled(GL_CULL_FACE, true);
+		state.setCullFace(GL_BACK);
 
 		// Enable blending for transparency
-		glEnable(GL_BLEND);
-		glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+		state.setEnabled(GL_BLEND, true);
+		state.setBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
 		// Load level
 		// **********************************************************************************************************
@@ -55,10 +102,24 @@ class GameState : public IGameState {
 
 		// Setup game entities
 		// **********************************************************************************************************
+		// The models load in the background, and whatever uses them is
+		// invisible until they are uploaded. The pellets draw their sphere
+		// instanced, so they get one of their own.
+		m_model_loader = std::make_unique<ModelLoader>();
+
+		const auto sphere_path  = "resources/models/sphere.obj"s;
+		const auto pellet_model = m_model_loader->load(sphere_path);
+		m_sphere                = m_model_loader->load(sphere_path);
+
 		m_maze    = std::make_unique<Maze>(*m_level);
-		m_pacman  = std::make_unique<Pacman>(findPacman(*m_level));
-		m_pellets = genPellets(*m_level);
-		m_ghosts  = genGhosts(*m_level);
+		m_pacman  = std::make_unique<Pacman>(findPacman(*m_level), m_sphere);
+		m_pellets = genPellets(*m_level, pellet_model);
+		m_ghosts  = genGhosts(*m_level, m_sphere);
+
+		m_occlusion = std::make_unique<OcclusionCuller>();
+		m_occlusion->setOccluders(m_maze->getOccluders());
+		m_minimap =
+		    std::make_unique<Minimap>(*m_level, m_pellets->getCentroids());
 
 		// Load texture
         // **********************************************************************************************************
@@ -74,10 +135,6 @@ class GameState : public IGameState {
 		                             "resources/shaders/model.frag"s};
 		m_pellet_shader = std::make_unique<ShaderProgram>(pellet_shaders);
 
-		const auto minimap_shaders = {"resources/shaders/model.vert"s,
-		                              "resources/shaders/minimap.frag"s};
-		m_minimap_shader = std::make_unique<ShaderProgram>(minimap_shaders);
-
 		const auto model_shadow_shaders = {
 		    "resources/shaders/model_shadow.vert"s,
 		    "resources/shaders/shadow.frag"s};
@@ -90,27 +147,41 @@ class GameState : public IGameState {
 		m_pellet_shadow_shader =
 		    std::make_unique<ShaderProgram>(pellet_shadow_shaders);
 
+		// The depth pre-pass writes no color, so it reuses the empty shadow
+		// fragment shader
+		const auto model_depth_shaders = {"resources/shaders/model_depth.vert"s,
+		                                  "resources/shaders/shadow.frag"s};
+		m_model_depth_shader =
+		    std::make_unique<ShaderProgram>(model_depth_shaders);
+
+		const auto pellet_depth_shaders = {
+		    "resources/shaders/pellets_depth.vert"s,
+		    "resources/shaders/shadow.frag"s};
+		m_pellet_depth_shader =
+		    std::make_unique<ShaderProgram>(pellet_depth_shaders);
+
 		// Setup uniforms
 		// **********************************************************************************************************
-		const auto diffuse_map_slot = 0u;
-
 		m_model_shader->use();
-		m_model_shader->setUniform("u_diffuse_map", diffuse_map_slot);
+		m_model_shader->setUniform("u_diffuse_map", gDiffuseMapSlot);
 
 		m_pellet_shader->use();
 		m_pellet_shader->setUniform("u_model_color",
 		                            glm::vec4(1.0f, 1.0f, 0.0f, 1.0f));
-		m_pellet_shader->setUniform("u_diffuse_map", diffuse_map_slot);
+		m_pellet_shader->setUniform("u_diffuse_map", gDiffuseMapSlot);
 	}
 
 	auto manifest() -> StateManifest override {
-		return {"Pacman 3D"};
+		// Tearing when a frame is late beats waiting a whole refresh for it
+		return {"Pacman 3D", PresentMode::AdaptiveVSync};
 	}
 
 	void resized(int width, int height) override {
 		m_backbuffer->bind();
         m_backbuffer->resize(width, height);
 
+		m_viewport = glm::ivec2(width, height);
+
 		m_pacman->updateAspectRatio((float)width / (float)height);
 	}
 
@@ -118,6 +189,25 @@ class GameState : public IGameState {
 		if (input.state == InputState::Pressed) {
 			if (input.code == InputCode::Escape)
 				return Pop{};
+			if (input.code == InputCode::P)
+				m_depth_prepass = !m_depth_prepass;
+			if (input.code == InputCode::O)
+				m_occlusion_culling = !m_occlusion_culling;
+			if (input.code == InputCode::T)
+				GlTracer::get().setEnabled(!GlTracer::get().isEnabled());
+			if (input.code == InputCode::G) {
+				std::cout << m_gpu_profiler->report();
+				if (GlTracer::get().isEnabled())
+					std::cout << GlTracer::get().report();
+				std::cout << std::endl;
+			}
+			if (input.code == InputCode::M) {
+				std::cout << "Maze:   " << m_maze->getOptimizerStats() << "\n";
+				if (const auto *sphere = m_sphere->get())
+					std::cout << "Sphere: " << sphere->getOptimizerStats()
+					          << "\n";
+				std::cout << std::endl;
+			}
 		}
 
 		m_pacman->input(input);
@@ -130,6 +220,10 @@ class GameState : public IGameState {
 		m_pacman->update(dt, *m_level);
 		should_quit |= m_pellets->update(*m_pacman);
 
+		// Only the cells of eaten pellets change on the minimap
+		for (const auto &pellet : m_pellets->takeEaten())
+			m_minimap->removePellet(pellet);
+
 		for (auto &ghost : m_ghosts) {
 			should_quit |= ghost.update(dt, *m_pacman, *m_level);
 		}
@@ -140,9 +234,24 @@ class GameState : public IGameState {
 			return None{};
 	}
 
-	void render() override {
+	void render(float alpha) override {
 		// Setup
 		// *********************************************************************
+		m_model_loader->finalize(gModelUploadBudget);
+
+		// Draw the entities between the last two ticks
+		m_pacman->interpolate(alpha);
+		for (auto &ghost : m_ghosts)
+			ghost.interpolate(alpha);
+
+		// The time of an earlier frame picks the scale of this one
+		if (const auto gpu_ms = m_gpu_timer->result())
+			m_dynamic_resolution->update(gpu_ms.value());
+		m_gpu_timer->begin();
+
+		const auto scene_dimensions = m_dynamic_resolution->scale(m_viewport);
+		const auto scene_height     = static_cast<float>(scene_dimensions.y);
+
 		const auto [w, h] = m_level->getSize();
 
 		const auto eye               = glm::vec3(-2.0f, 20.0f, -1.0f);
@@ -150,149 +259,383 @@ class GameState : public IGameState {
 		const auto directional_light = DirectionalLight{
 		    glm::vec3(1.0f, 1.0f, 1.0f), glm::normalize(eye - target), 2.0f};
 
-		const auto shadow_map_slot = 1u;
+		// The passes are declared every frame and run by the frame graph,
+		// which orders them by what they read and write, and leases their
+		// targets from the pool for as long as they are used
+		const auto shadows = m_frame_graph->importResource("shadow map");
+		const auto visible = m_frame_graph->importResource("visible pellets");
 
-		// Zeroth render pass - Generate a shadow map
+		// Shadow pass - Generate the shadow map cascades
 		// *********************************************************************
-		m_shadow_framebuffer->bind();
-		m_shadow_framebuffer->clear();
-
-		auto projection = glm::ortho(-23.0f, 23.0f, -23.0f, 23.0f, 5.0f, 50.0f);
-		auto view       = glm::lookAt(eye, target, glm::vec3(0.0f, 1.0f, 0.0f));
-		auto light_space_matrix = projection * view;
-
-		m_model_shadow_shader->use();
-		m_model_shadow_shader->setUniform("u_light_space_matrix",
-		                                  light_space_matrix);
-
-		// FIXME: Need to draw pacman as well.
-		m_model_shadow_shader->setUniform("u_transform",
-		                                  m_maze->getTransform());
-		m_maze->draw();
-
-		for (const auto &ghost : m_ghosts) {
-			m_model_shadow_shader->setUniform("u_transform",
-			                                  ghost.getTransform());
-			ghost.draw();
+		m_frame_graph->addPass(
+		    "shadows",
+		    [&](FrameGraph::PassBuilder &builder) {
+			    builder.write(shadows);
+			    builder.write(visible);
+		    },
+		    [&](const FrameGraph::PassContext &) {
+			    m_shadow_map->update(m_pacman->getCamera(), m_pacman->view(),
+			                         directional_light.direction);
+
+			    // The ghosts are culled and recorded into one list per
+			    // cascade on the worker threads, while the maze and pellets
+			    // are drawn
+			    std::vector<size_t> ghost_casters;
+			    for (size_t i = 0; i < m_shadow_map->getCascadeCount(); ++i) {
+				    const auto record = [&, i](CommandList &list) {
+					    const auto light_frustum =
+					        Frustum::fromMatrix(m_shadow_map->getMatrix(i));
+					    const auto pixels_per_unit =
+					        m_shadow_map->pixelsPerUnit(i);
+
+					    list.useProgram(*m_model_shadow_shader);
+					    for (const auto &ghost : m_ghosts)
+						    ghost.record(list, light_frustum,
+						                 ghost.selectLod(pixels_per_unit));
+				    };
+				    ghost_casters.push_back(m_commands->record(record));
+			    }
+
+			    for (size_t i = 0; i < m_shadow_map->getCascadeCount(); ++i)
+				    renderCascade(i, ghost_casters[i]);
+		    });
+
+		// Both the model and pellet shaders look up shadows in the cascades
+		const auto set_shadow_uniforms = [&](ShaderProgram &shader) {
+			shader.setUniform("u_shadow_map", gShadowMapSlot);
+			shader.setUniform("u_light_space_matrices",
+			                  m_shadow_map->getMatrices());
+			shader.setUniform("u_cascade_splits", m_shadow_map->getSplits());
+			shader.setUniform(
+			    "u_cascade_count",
+			    static_cast<GLuint>(m_shadow_map->getCascadeCount()));
+		};
+
+		const auto view       = m_pacman->view();
+		const auto projection = m_pacman->projection();
+
+		// Everything outside pacman's view is culled
+		const auto  frustum = m_pacman->frustum();
+		const auto &camera  = m_pacman->getCamera();
+		const auto  ghost_lod = [&](const Ghost &ghost) {
+			const auto distance =
+			    glm::distance(ghost.getDrawnPosition(),
+			                  m_pacman->getDrawnPosition());
+			return ghost.selectLod(
+			    camera.pixelsPerUnit(distance, scene_height));
+		};
+
+		// Cull pass - Cull the pellets and bin the lights for pacman's view,
+		// after the shadow pass is done with the culled pellets
+		// *********************************************************************
+		m_frame_graph->addPass(
+		    "cull",
+		    [&](FrameGraph::PassBuilder &builder) { builder.write(visible); },
+		    [&](const FrameGraph::PassContext &) {
+			    // The pellets glow faintly, and every ghost carries a light.
+			    // The lights are binned into clusters along pacman's view.
+			    std::vector<PointLight> point_lights;
+			    point_lights.reserve(m_pellets->getCentroids().size() +
+			                         m_ghosts.size());
+			    for (const auto &pellet : m_pellets->getCentroids())
+				    point_lights.push_back(
+				        {pellet, 1.0f, glm::vec3(1.0f, 0.8f, 0.2f), 0.5f});
+			    for (const auto &ghost : m_ghosts)
+				    point_lights.push_back({ghost.getDrawnPosition(), 4.0f,
+				                            glm::vec3(0.2f, 1.0f, 0.4f),
+				                            3.0f});
+
+			    m_lights->setLights(point_lights);
+			    m_lights->update(view, projection);
+
+			    // The walls hide most of the maze from inside it
+			    if (m_occlusion_culling)
+				    m_occlusion->render(projection * view);
+
+			    m_pellets->cull(frustum,
+			                    camera.pixelsPerUnit(1.0f, scene_height),
+			                    m_pacman->getDrawnPosition(),
+			                    m_occlusion_culling ? m_occlusion.get()
+			                                        : nullptr);
+		    });
+
+		// The maze, ghosts and pellets are drawn through the render queue,
+		// sorted so that every program and material is set up once, and the
+		// ghosts go front to back
+		const auto submit_opaque = [&](ShaderProgram &        model_shader,
+		                               ShaderProgram &        pellet_shader,
+		                               const RenderCallback *maze_material,
+		                               const RenderCallback *ghost_material) {
+			// The maze covers most of the screen, so it goes first
+			m_render_queue->submit(
+			    {RenderQueue::makeKey({0, 0, 0, 0, 0, 0.0f}), &model_shader,
+			     maze_material, [&](ShaderProgram &shader) {
+				     shader.setUniform("u_transform", m_maze->getTransform());
+				     m_maze->draw(frustum);
+			     }});
+
+			for (const auto &ghost : m_ghosts) {
+				if (m_occlusion_culling && !ghost.isVisible(*m_occlusion))
+					continue;
+
+				const auto distance =
+				    glm::distance(ghost.getDrawnPosition(),
+				                  m_pacman->getDrawnPosition());
+				m_render_queue->submit(
+				    {RenderQueue::makeKey(
+				         {0, 0, 0, 1, 1, distance / gSortDistance}),
+				     &model_shader, ghost_material,
+				     [&ghost, &frustum, lod = ghost_lod(ghost)](
+				         ShaderProgram &shader) {
+					     shader.setUniform("u_transform",
+					                       ghost.getTransform());
+					     ghost.draw(frustum, lod);
+				     }});
+			}
+
+			m_render_queue->submit(
+			    {RenderQueue::makeKey({0, 0, 1, 0, 2, 0.0f}), &pellet_shader,
+			     nullptr, [&](ShaderProgram &) { m_pellets->draw(); }});
+
+			m_render_queue->flush();
+		};
+
+		auto &state = StateCache::get();
+
+		// Depth pre-pass - Lay down the depth of the opaque geometry first, so
+		// that the lit pass only shades the fragments that end up on screen.
+		// Both passes must draw exactly the same triangles for the depths to
+		// be equal.
+		// *********************************************************************
+		const auto depth_desc =
+		    RenderTargetDesc{AttachmentType::Depth, scene_dimensions, 1};
+		auto scene_depth = FrameResource();
+		if (m_depth_prepass) {
+			m_frame_graph->addPass(
+			    "depth pre-pass",
+			    [&](FrameGraph::PassBuilder &builder) {
+				    builder.read(visible);
+				    scene_depth = builder.create(depth_desc);
+			    },
+			    [&](const FrameGraph::PassContext &) {
+				    state.setColorMask(false);
+
+				    m_model_depth_shader->use();
+				    m_model_depth_shader->setUniform("u_view", view);
+				    m_model_depth_shader->setUniform("u_projection",
+				                                     projection);
+
+				    m_pellet_depth_shader->use();
+				    m_pellet_depth_shader->setUniform("u_view", view);
+				    m_pellet_depth_shader->setUniform("u_projection",
+				                                      projection);
+
+				    submit_opaque(*m_model_depth_shader,
+				                  *m_pellet_depth_shader, nullptr, nullptr);
+
+				    state.setColorMask(true);
+			    });
 		}
 
-		m_pellet_shadow_shader->use();
-		m_pellet_shadow_shader->setUniform("u_light_space_matrix",
-		                                   light_space_matrix);
+		// Scene pass - Draw the scene at the dynamic resolution
+		// *********************************************************************
+		auto scene_color = FrameResource();
+		m_frame_graph->addPass(
+		    "scene",
+		    [&](FrameGraph::PassBuilder &builder) {
+			    builder.read(shadows);
+			    builder.read(visible);
+			    scene_color = builder.create(
+			        {AttachmentType::Color, scene_dimensions, 1});
+			    if (m_depth_prepass)
+				    builder.write(scene_depth);
+			    else
+				    scene_depth = builder.create(depth_desc);
+		    },
+		    [&](const FrameGraph::PassContext &) {
+			    if (m_depth_prepass) {
+				    state.setDepthFunc(GL_EQUAL);
+				    state.setDepthMask(false);
+			    }
+
+			    m_shadow_map->bindToSlot(gShadowMapSlot);
+
+			    m_model_shader->use();
+			    m_model_shader->setUniform("u_view", view);
+			    m_model_shader->setUniform("u_projection", projection);
+			    m_model_shader->setUniform("u_directional_light",
+			                               directional_light);
+			    set_shadow_uniforms(*m_model_shader);
+			    m_lights->bindTo(*m_model_shader, scene_dimensions);
+
+			    m_pellet_shader->use();
+			    m_pellet_shader->setUniform("u_view", view);
+			    m_pellet_shader->setUniform("u_projection", projection);
+			    m_pellet_shader->setUniform("u_directional_light",
+			                                directional_light);
+			    set_shadow_uniforms(*m_pellet_shader);
+			    m_lights->bindTo(*m_pellet_shader, scene_dimensions);
+
+			    // Every material binds what it samples, other passes may have
+			    // left anything on the units
+			    const RenderCallback maze_material =
+			        [this](ShaderProgram &shader) {
+				        m_texture->bindToSlot(gDiffuseMapSlot);
+				        shader.setUniform("u_model_color",
+				                          glm::vec4(1.0f, 0.0f, 0.0f, 0.0f));
+			        };
+			    const RenderCallback ghost_material =
+			        [](ShaderProgram &shader) {
+				        shader.setUniform("u_model_color",
+				                          glm::vec4(0.0f, 1.0f, 0.0f, 1.0f));
+			        };
+			    submit_opaque(*m_model_shader, *m_pellet_shader,
+			                  &maze_material, &ghost_material);
+
+			    state.setDepthFunc(GL_LESS);
+			    state.setDepthMask(true);
+		    });
+
+		// Upscale pass - Upscale the scene into the backbuffer, filtered
+		// *********************************************************************
+		m_frame_graph->addPass(
+		    "upscale",
+		    [&](FrameGraph::PassBuilder &builder) {
+			    builder.read(scene_color);
+			    builder.sideEffect();
+		    },
+		    [&](const FrameGraph::PassContext &context) {
+			    m_scene_framebuffer->attach(context.getTarget(scene_color));
+			    m_backbuffer->blit(
+			        m_scene_framebuffer.get(),
+			        glm::ivec4(0, 0, scene_dimensions.x, scene_dimensions.y),
+			        glm::ivec4(0, 0, m_viewport.x, m_viewport.y), GL_LINEAR);
+		    });
+
+		// Minimap pass - Draw the minimap over a corner of the backbuffer
+		// *********************************************************************
+		m_frame_graph->addPass(
+		    "minimap",
+		    [&](FrameGraph::PassBuilder &builder) { builder.sideEffect(); },
+		    [&](const FrameGraph::PassContext &) {
+			    m_minimap->update(*m_pacman, m_ghosts);
 
-		m_pellets->draw();
+			    m_backbuffer->bind();
+			    m_minimap->draw(glm::ivec4(0, 0, 280, 340));
+		    });
 
-		m_shadow_framebuffer->bindDepthAttachmentToSlot(shadow_map_slot);
+		m_frame_graph->execute();
 
-		// First render pass - Draw scene to the backbuffer
+		// Render pass end
 		// *********************************************************************
-		m_backbuffer->bind();
 
-		view       = m_pacman->view();
-		projection = m_pacman->projection();
+		m_gpu_timer->end();
+		m_gpu_profiler->endFrame();
 
-		m_model_shader->use();
-		m_model_shader->setUniform("u_view", view);
-		m_model_shader->setUniform("u_projection", projection);
-		m_model_shader->setUniform("u_directional_light", directional_light);
-		m_model_shader->setUniform("u_shadow_map", shadow_map_slot);
-		m_model_shader->setUniform("u_light_space_matrix", light_space_matrix);
-
-		m_model_shader->setUniform("u_transform", m_maze->getTransform());
-		m_model_shader->setUniform("u_model_color",
-		                           glm::vec4(1.0f, 0.0f, 0.0f, 0.0f));
-		m_maze->draw();
-
-		m_model_shader->setUniform("u_model_color",
-		                           glm::vec4(0.0f, 1.0f, 0.0f, 1.0f));
-		for (const auto &ghost : m_ghosts) {
-			m_model_shader->setUniform("u_transform", ghost.getTransform());
-			ghost.draw();
-		}
+		// Let the pool free the targets of old resolutions
+		m_render_targets->endFrame();
+		m_commands->reset();
 
-		m_pellet_shader->use();
-		m_pellet_shader->setUniform("u_view", view);
-		m_pellet_shader->setUniform("u_projection", projection);
-		m_pellet_shader->setUniform("u_directional_light", directional_light);
-		m_pellet_shader->setUniform("u_shadow_map", shadow_map_slot);
-		m_pellet_shader->setUniform("u_light_space_matrix", light_space_matrix);
+		// Bind the backbuffer for GLFW to read from
+		m_backbuffer->bind();
+	}
 
-		m_pellets->draw();
+  private:
+	/**
+	 * @brief Draw the casters of one shadow map cascade.
+	 * @param cascade Index of the cascade.
+	 * @param ghost_casters Command list of the ghosts in the cascade.
+	 */
+	void renderCascade(size_t cascade, size_t ghost_casters) {
+		const auto &light_space_matrix = m_shadow_map->getMatrix(cascade);
+		const auto  light_frustum = Frustum::fromMatrix(light_space_matrix);
+		const auto  pixels_per_unit = m_shadow_map->pixelsPerUnit(cascade);
 
-		// Second render pass - Draw scene to minimap and blit it to the
-		// backbuffer
-		// *********************************************************************
-		m_framebuffer->bind();
-		m_framebuffer->clear();
-
-		view       = glm::lookAt(glm::vec3(0.0f, 10.0f, 0.0f),
-                           glm::vec3(0.0f, 0.0f, 0.0f),
-                           glm::vec3(0.0f, 0.0f, 1.0f));
-		projection = glm::ortho(-(float)w, 0.0f, 0.0f, (float)h, 0.0f, 10.0f);
-
-		m_minimap_shader->use();
-		m_minimap_shader->setUniform("u_view", view);
-		m_minimap_shader->setUniform("u_projection", projection);
-
-		m_minimap_shader->setUniform("u_transform", m_maze->getTransform());
-		m_minimap_shader->setUniform("u_model_color",
-		                             glm::vec4(1.0f, 0.0f, 0.0f, 1.0f));
-		m_maze->draw();
-
-		m_minimap_shader->setUniform("u_transform", m_pacman->getTransform());
-		m_minimap_shader->setUniform("u_model_color", glm::vec4(0.0f, 0.0f, 1.0f, 1.0f));
-		m_pacman->draw();
-
-		m_minimap_shader->setUniform("u_model_color",
-		                             glm::vec4(0.0f, 1.0f, 0.0f, 1.0f));
-		for (const auto &ghost : m_ghosts) {
-			m_minimap_shader->setUniform("u_transform", ghost.getTransform());
-			ghost.draw();
-		}
+		m_model_shadow_shader->use();
+		m_model_shadow_shader->setUniform("u_light_space_matrix",
+		                                  light_space_matrix);
 
-		m_pellet_shader->use();
-		m_pellet_shader->setUniform("u_view", view);
-		m_pellet_shader->setUniform("u_projection", projection);
+		// The maze never moves, so its shadow is only drawn when the
+		// cascade's cache is invalid
+		if (m_shadow_map->beginStatic(cascade)) {
+			m_model_shadow_shader->setUniform("u_transform",
+			                                  m_maze->getTransform());
+			m_maze->draw(light_frustum);
+		}
 
-		m_pellets->draw();
+		// FIXME: Need to draw pacman as well.
+		m_shadow_map->beginDynamic(cascade);
+		m_commands->execute(ghost_casters);
 
-		m_backbuffer->blit(m_framebuffer.get(), glm::ivec4(0, 0, 280, 340),
-		                   glm::ivec4(0, 0, 280, 340));
+		// Culling uses its own program, so it goes before the pellet shader
+		m_pellets->cull(light_frustum, pixels_per_unit);
 
-		// Render pass end
-		// *********************************************************************
+		m_pellet_shadow_shader->use();
+		m_pellet_shadow_shader->setUniform("u_light_space_matrix",
+		                                   light_space_matrix);
 
-		// Bind the backbuffer for GLFW to read from
-		m_backbuffer->bind();
+		m_pellets->draw();
 	}
 
-  private:
+	std::unique_ptr<ModelLoader> m_model_loader; ///< Background model loads.
+	std::shared_ptr<AsyncModel>  m_sphere;       ///< Pacman and ghost model.
+
 	std::unique_ptr<Level>   m_level;   ///< The current level.
 	std::unique_ptr<Maze>    m_maze;    ///< The level maze.
 	std::unique_ptr<Pacman>  m_pacman;  ///< Pacman entity.
 	std::unique_ptr<Pellets> m_pellets; ///< All the pellets in the level.
 	std::vector<Ghost>       m_ghosts;  ///< All the ghosts in the level.
+	std::unique_ptr<Minimap> m_minimap; ///< Map in the corner of the screen.
+
+	glm::ivec2 m_viewport = glm::ivec2(1280, 720); ///< Size of the backbuffer.
 
 	std::unique_ptr<ShaderProgram>
 	    m_model_shader; ///< Default model shader program (Used for e.g. the
 	                    ///< maze).
 	std::unique_ptr<ShaderProgram>
 	    m_pellet_shader; ///< Shader used for drawing pellets instanced.
-	std::unique_ptr<ShaderProgram>
-	    m_minimap_shader; ///< Minimap shader program.
 	std::unique_ptr<ShaderProgram>
 	    m_model_shadow_shader; ///< Shadow map generating shader program.
 	std::unique_ptr<ShaderProgram>
 	    m_pellet_shadow_shader; ///< Shadow map generating shader program.
+	std::unique_ptr<ShaderProgram>
+	    m_model_depth_shader; ///< Depth pre-pass shader program.
+	std::unique_ptr<ShaderProgram>
+	    m_pellet_depth_shader; ///< Depth pre-pass shader program for pellets.
+
+	bool m_depth_prepass     = true; ///< Draw depth first, toggled by P.
+	bool m_occlusion_culling = true; ///< Cull behind walls, toggled by O.
 
 	std::unique_ptr<Texture> m_texture; ///< A texture for the walls.
 
+	std::unique_ptr<RenderTargetPool>
+	    m_render_targets; ///< Transient attachments for the render passes.
+
 	std::unique_ptr<Framebuffer>
 	    m_backbuffer; ///< Default framebuffer created by GLFW.
 	std::unique_ptr<Framebuffer>
-	    m_framebuffer; ///< Framebuffer for drawing the minimap to.
-	std::unique_ptr<Framebuffer>
-	    m_shadow_framebuffer; ///< Framebuffer for generating a shadow map.
+	    m_scene_framebuffer; ///< Reads the main view for the upscale.
+	std::unique_ptr<FrameGraph>
+	    m_frame_graph; ///< Orders the passes and leases their targets.
+	std::unique_ptr<CascadedShadowMap>
+	    m_shadow_map; ///< Shadow map cascades along pacman's view.
+
+	std::unique_ptr<ClusteredLights>
+	    m_lights; ///< Point lights of the pellets and ghosts.
+
+	std::unique_ptr<RenderQueue>
+	    m_render_queue; ///< Sorts the draws of the main view.
+	std::unique_ptr<OcclusionCuller>
+	    m_occlusion; ///< Depth of the maze walls from pacman's view.
+	std::unique_ptr<CommandQueue>
+	    m_commands; ///< Records draws on worker threads.
+
+	std::unique_ptr<GpuTimer> m_gpu_timer; ///< GPU time of every frame.
+	std::unique_ptr<GpuProfiler>
+	    m_gpu_profiler; ///< GPU time of every pass, printed by G with the GL
+	                    ///< calls of the last frame if traced, toggled by T.
+	std::unique_ptr<DynamicResolution>
+	    m_dynamic_resolution; ///< Scale of the main view.
 };
 
 auto main() -> int {
@@ -23,8 +23,9 @@ auto main() -> int {
 	auto vbo = VertexBuffer(vertices, indices);
 
 	// Enable blending for transparency
-	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-	glEnable(GL_BLEND);
+	auto &state = StateCache::get();
+	state.setBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	state.setEnabled(GL_BLEND, true);
 
 	auto tex = Texture("resources/textures/dog.png");
 	tex.bindToSlot(0);
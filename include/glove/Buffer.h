@@ -0,0 +1,91 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <vector>
+
+/**
+ * @brief A general purpose OpenGL buffer, e.g. a shader storage buffer or an
+ * indirect draw buffer. Freeing the buffer on deconstruction.
+ *
+ * The buffer is not tied to a single target, it is bound to whatever target
+ * it is used as with "bind" or "bindBase".
+ */
+class Buffer {
+  public:
+	/**
+	 * @brief Construct a zeroed buffer.
+	 * @param size Size of the buffer in bytes.
+	 * @param usage How is the buffer going to be used? Default is DYNAMIC DRAW
+	 */
+	explicit Buffer(size_t size, GLenum usage = GL_DYNAMIC_DRAW);
+
+	/**
+	 * @brief Construct a buffer containing a copy of some data.
+	 * @tparam T Type of the elements.
+	 * @param data Elements to copy into the buffer.
+	 * @param usage How is the buffer going to be used? Default is DYNAMIC DRAW
+	 */
+	template <typename T>
+	explicit Buffer(const std::vector<T> &data, GLenum usage = GL_DYNAMIC_DRAW)
+	    : Buffer(data.size() * sizeof(T), usage) {
+		upload(data);
+	}
+
+	Buffer(const Buffer &other) = delete;
+
+	Buffer(const Buffer &&other) = delete;
+
+	auto operator=(const Buffer &other) = delete;
+
+	auto operator=(const Buffer &&other) = delete;
+
+	~Buffer();
+
+	/**
+	 * @brief Bind the buffer to a target.
+	 * @param target Target to bind to, e.g. GL_DRAW_INDIRECT_BUFFER.
+	 */
+	void bind(GLenum target) const;
+
+	/**
+	 * @brief Bind the buffer to an indexed binding point.
+	 * @param target Indexed target, e.g. GL_SHADER_STORAGE_BUFFER.
+	 * @param index Binding point, matching the shader's "binding = index".
+	 */
+	void bindBase(GLenum target, GLuint index) const;
+
+	/**
+	 * @brief Upload data to part of the buffer.
+	 * @param data Pointer to the data.
+	 * @param size Size of the data in bytes.
+	 * @param offset Offset into the buffer in bytes.
+	 */
+	void upload(const void *data, size_t size, size_t offset = 0);
+
+	/**
+	 * @brief Upload elements to part of the buffer.
+	 * @tparam T Type of the elements.
+	 * @param data Elements to upload.
+	 * @param offset Offset into the buffer in elements.
+	 */
+	template <typename T>
+	void upload(const std::vector<T> &data, size_t offset = 0) {
+		upload(data.data(), data.size() * sizeof(T), offset * sizeof(T));
+	}
+
+	/**
+	 * @brief Get the OpenGL name of the buffer.
+	 * @return The buffer name.
+	 */
+	[[nodiscard]] auto getId() const -> GLuint { return m_buffer; }
+
+	/**
+	 * @brief Get the size of the buffer.
+	 * @return Size in bytes.
+	 */
+	[[nodiscard]] auto getSize() const -> size_t { return m_size; }
+
+  private:
+	GLuint m_buffer; ///< Internal buffer object.
+	size_t m_size;   ///< Size of the buffer in bytes.
+};
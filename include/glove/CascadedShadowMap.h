@@ -0,0 +1,157 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+#include <glove/Components.h>
+#include <glove/Framebuffer.h>
+#include <memory>
+#include <vector>
+
+/**
+ * @brief Most cascades a cascaded shadow map can have, must match
+ * MAX_CASCADES in the shaders.
+ */
+constexpr size_t gMaxCascades = 4;
+
+/**
+ * @brief A directional light shadow map split into cascades along the view of
+ * a camera.
+ *
+ * The camera frustum is split into slices, near slices being shorter than far
+ * ones. Every slice gets a light projection fitted around it, all with the
+ * same resolution, stored as the layers of one depth array texture.
+ *
+ * Every projection covers a region of light space somewhat larger than its
+ * slice, snapped to whole texels, that stays put while the slice moves around
+ * inside it. The shadow edges do not shimmer as the camera moves, and the
+ * static casters of every cascade are cached, and only drawn again once the
+ * slice leaves the region or the light changes.
+ *
+ * # Usage
+ * ```
+ * shadow_map.update(camera, view, light_direction);
+ * for (size_t i = 0; i < shadow_map.getCascadeCount(); ++i) {
+ *     // Set the light space matrix to shadow_map.getMatrix(i)
+ *     if (shadow_map.beginStatic(i)) {
+ *         // Draw static casters
+ *     }
+ *     shadow_map.beginDynamic(i);
+ *     // Draw dynamic casters
+ * }
+ * shadow_map.bindToSlot(slot);
+ * ```
+ */
+class CascadedShadowMap {
+  public:
+	/**
+	 * @brief Allocate the cascades.
+	 * @param resolution Width and height of every cascade.
+	 * @param cascade_count Number of cascades, at most gMaxCascades.
+	 * @param max_distance How far from the camera there are shadows.
+	 */
+	CascadedShadowMap(GLsizei resolution, size_t cascade_count,
+	                  float max_distance);
+
+	CascadedShadowMap(const CascadedShadowMap &other) = delete;
+
+	CascadedShadowMap(const CascadedShadowMap &&other) = delete;
+
+	auto operator=(const CascadedShadowMap &other) = delete;
+
+	auto operator=(const CascadedShadowMap &&other) = delete;
+
+	~CascadedShadowMap();
+
+	/**
+	 * @brief Fit the cascades to the view of a camera.
+	 * @param camera The camera.
+	 * @param view View matrix of the camera.
+	 * @param light_direction Direction towards the light.
+	 */
+	void update(const CameraComponent &camera, const glm::mat4 &view,
+	            const glm::vec3 &light_direction);
+
+	/**
+	 * @brief Start rendering the static casters of a cascade, if its cache
+	 * needs it.
+	 * @param cascade Index of the cascade.
+	 * @return Should the static casters be drawn now?
+	 */
+	auto beginStatic(size_t cascade) -> bool;
+
+	/**
+	 * @brief Copy the cache of a cascade into the shadow map and start
+	 * rendering the dynamic casters on top of it.
+	 * @param cascade Index of the cascade.
+	 */
+	void beginDynamic(size_t cascade);
+
+	/**
+	 * @brief Invalidate the caches, e.g. after the static geometry changed.
+	 */
+	void invalidate();
+
+	/**
+	 * @brief Bind the depth array texture to a texture slot for sampling.
+	 * @param slot Texture slot.
+	 */
+	void bindToSlot(GLuint slot) const;
+
+	/**
+	 * @brief Get the number of cascades.
+	 * @return Number of cascades.
+	 */
+	[[nodiscard]] auto getCascadeCount() const -> size_t {
+		return m_matrices.size();
+	}
+
+	/**
+	 * @brief Get the light space matrix of a cascade.
+	 * @param cascade Index of the cascade.
+	 * @return Projection and view of the light.
+	 */
+	[[nodiscard]] auto getMatrix(size_t cascade) const -> const glm::mat4 & {
+		return m_matrices[cascade];
+	}
+
+	/**
+	 * @brief Get the light space matrices of all the cascades.
+	 * @return One matrix per cascade.
+	 */
+	[[nodiscard]] auto getMatrices() const -> const std::vector<glm::mat4> & {
+		return m_matrices;
+	}
+
+	/**
+	 * @brief Get how far from the camera every cascade reaches, along the
+	 * view direction.
+	 * @return One distance per cascade.
+	 */
+	[[nodiscard]] auto getSplits() const -> const std::vector<float> & {
+		return m_splits;
+	}
+
+	/**
+	 * @brief Get how many texels one world space unit covers in a cascade.
+	 * @param cascade Index of the cascade.
+	 * @return Texels per world space unit.
+	 */
+	[[nodiscard]] auto pixelsPerUnit(size_t cascade) const -> float {
+		return m_pixels_per_unit[cascade];
+	}
+
+  private:
+	std::unique_ptr<Framebuffer> m_framebuffer; ///< Framebuffer to draw with.
+	GLuint  m_static_texture; ///< Cached depth of the static casters.
+	GLuint  m_texture;        ///< Depth of all the casters.
+	GLsizei m_resolution;     ///< Width and height of every cascade.
+	float   m_max_distance;   ///< How far from the camera there are shadows.
+
+	std::vector<glm::mat4> m_matrices;        ///< Light space matrices.
+	std::vector<float>     m_splits;          ///< Far distance of cascades.
+	std::vector<float>     m_pixels_per_unit; ///< Texels per unit.
+	std::vector<glm::vec3> m_origins;         ///< Region centers, light space.
+	std::vector<float>     m_extents;         ///< Region half sizes.
+	glm::vec3              m_light_direction; ///< Light of the regions.
+	std::vector<bool>      m_cached;          ///< Are the caches valid?
+};
@@ -0,0 +1,110 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+#include <glove/Buffer.h>
+#include <glove/ShaderProgram.h>
+#include <memory>
+#include <vector>
+
+/**
+ * @brief A point light, laid out like the std430 struct in the shaders.
+ */
+struct PointLight {
+	glm::vec3 position;  ///< Position in world space.
+	float     radius;    ///< Distance where the light has faded out.
+	glm::vec3 color;     ///< Color of the light.
+	float     intensity; ///< Brightness of the light.
+};
+
+/**
+ * @brief Default size of the cluster grid, in tiles across and down the
+ * screen and slices along the view.
+ */
+const glm::ivec3 gClusterGrid = glm::ivec3(16, 9, 24);
+
+/**
+ * @brief Point lights binned into a grid of clusters along the view, for
+ * clustered forward shading.
+ *
+ * The view frustum is split into tiles across the screen, and every tile into
+ * slices along the view, thinner near the camera. Every frame a compute pass
+ * finds the lights touching every cluster, so that a fragment only loops over
+ * the lights of its own cluster, however many lights there are in total.
+ *
+ * The lights, the light count of every cluster and the light indices of every
+ * cluster are bound to shader storage bindings 3, 4 and 5.
+ *
+ * # Usage
+ * ```
+ * lights.setLights(point_lights);
+ * lights.update(view, projection);
+ * shader.use();
+ * lights.bindTo(shader, viewport);
+ * // Draw with compute_point_light in model.frag
+ * ```
+ */
+class ClusteredLights {
+  public:
+	/**
+	 * @brief Allocate the light and cluster buffers.
+	 * @param max_lights Most lights there can be at once.
+	 * @param max_lights_per_cluster Most lights a cluster can hold, the rest
+	 * are dropped.
+	 * @param depth_range Distance from the camera to the first and the last
+	 * slice. Fragments beyond the last slice use it anyway.
+	 * @param grid Number of tiles across and down, and slices along the view.
+	 */
+	explicit ClusteredLights(size_t     max_lights             = 1024,
+	                         size_t     max_lights_per_cluster = 64,
+	                         glm::vec2  depth_range = glm::vec2(0.1f, 50.0f),
+	                         glm::ivec3 grid        = gClusterGrid);
+
+	ClusteredLights(const ClusteredLights &other) = delete;
+
+	ClusteredLights(const ClusteredLights &&other) = delete;
+
+	auto operator=(const ClusteredLights &other) = delete;
+
+	auto operator=(const ClusteredLights &&other) = delete;
+
+	/**
+	 * @brief Upload the lights. Lights beyond the maximum are dropped.
+	 * @param lights The lights, in world space.
+	 */
+	void setLights(const std::vector<PointLight> &lights);
+
+	/**
+	 * @brief Bin the lights into the clusters of a view, on the GPU.
+	 * @param view View matrix of the camera.
+	 * @param projection Perspective projection of the camera.
+	 */
+	void update(const glm::mat4 &view, const glm::mat4 &projection);
+
+	/**
+	 * @brief Bind the buffers and set the cluster uniforms of a shader that
+	 * looks up lights, the shader must be in use.
+	 * @param shader The shader.
+	 * @param viewport Size of the viewport drawn to, in pixels.
+	 */
+	void bindTo(ShaderProgram &shader, glm::ivec2 viewport) const;
+
+	/**
+	 * @brief Get the number of lights.
+	 * @return Number of lights.
+	 */
+	[[nodiscard]] auto getLightCount() const -> size_t {
+		return m_light_count;
+	}
+
+  private:
+	glm::ivec3 m_grid;                   ///< Tiles across, down and slices.
+	glm::vec2  m_depth_range;            ///< Depth of the first and last slice.
+	size_t     m_max_lights;             ///< Capacity of the light buffer.
+	size_t     m_max_lights_per_cluster; ///< Capacity of every cluster.
+	size_t     m_light_count;            ///< Number of uploaded lights.
+	std::unique_ptr<Buffer> m_light_buffer;   ///< The lights.
+	std::unique_ptr<Buffer> m_count_buffer;   ///< Lights in every cluster.
+	std::unique_ptr<Buffer> m_index_buffer;   ///< Light indices per cluster.
+	std::unique_ptr<ShaderProgram> m_shader; ///< Binning compute shader.
+};
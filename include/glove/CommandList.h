@@ -0,0 +1,255 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <future>
+#include <glm/glm.hpp>
+#include <glove/Buffer.h>
+#include <glove/ShaderProgram.h>
+#include <glove/ThreadPool.h>
+#include <variant>
+#include <vector>
+
+/**
+ * @brief Value of a uniform recorded in a command list.
+ */
+using UniformValue =
+    std::variant<GLuint, float, glm::vec2, glm::vec3, glm::vec4, glm::ivec2,
+                 glm::ivec3, glm::ivec4, glm::mat4>;
+
+/**
+ * @brief A list of draw, state and upload commands, recorded without OpenGL
+ * and replayed on the thread that owns the context.
+ *
+ * Recording only appends plain data, so lists can be recorded on worker
+ * threads, one list per thread. Everything is decided while recording,
+ * replaying just issues the calls in order.
+ *
+ * Uniforms are set on the program used last in the list. Programs, buffers
+ * and uniform names are referenced, not copied, and must outlive the replay.
+ * Uploaded data is copied.
+ *
+ * # Usage
+ * ```
+ * // On any thread
+ * list.useProgram(program);
+ * list.setUniform("u_transform", transform);
+ * model.recordVisible(list, frustum, transform);
+ *
+ * // On the OpenGL thread
+ * list.execute();
+ * list.clear();
+ * ```
+ */
+class CommandList {
+  public:
+	CommandList() = default;
+
+	CommandList(const CommandList &other) = delete;
+
+	CommandList(const CommandList &&other) = delete;
+
+	auto operator=(const CommandList &other) = delete;
+
+	auto operator=(const CommandList &&other) = delete;
+
+	/**
+	 * @brief Use a shader program.
+	 * @param program The program.
+	 */
+	void useProgram(ShaderProgram &program);
+
+	/**
+	 * @brief Set a uniform of the program used last.
+	 * @param name Name of the uniform, e.g. a string literal.
+	 * @param value Value of the uniform.
+	 */
+	void setUniform(const char *name, UniformValue value);
+
+	/**
+	 * @brief Bind a texture to a texture unit.
+	 * @param unit Texture unit.
+	 * @param target Texture target, e.g. GL_TEXTURE_2D.
+	 * @param texture The texture.
+	 */
+	void bindTexture(GLuint unit, GLenum target, GLuint texture);
+
+	/**
+	 * @brief Enable or disable a capability, e.g. GL_BLEND.
+	 * @param capability The capability.
+	 * @param enabled Should it be enabled?
+	 */
+	void setEnabled(GLenum capability, bool enabled);
+
+	/**
+	 * @brief Draw a range of an index buffer as triangles.
+	 * @param vao Vertex array of the index buffer.
+	 * @param index_offset Offset of the first index to draw.
+	 * @param index_count Number of indices to draw.
+	 * @param base_vertex Value added to every index.
+	 * @param first_instance First instance to draw.
+	 * @param instance_count Number of instances to draw.
+	 */
+	void drawElements(GLuint vao, GLuint index_offset, GLuint index_count,
+	                  GLint base_vertex = 0, GLuint first_instance = 0,
+	                  GLuint instance_count = 1);
+
+	/**
+	 * @brief Draw a range of a vertex buffer as triangles.
+	 * @param vao Vertex array of the vertex buffer.
+	 * @param first First vertex to draw.
+	 * @param count Number of vertices to draw.
+	 */
+	void drawArrays(GLuint vao, GLint first, GLsizei count);
+
+	/**
+	 * @brief Upload data to a buffer. The data is copied into the list.
+	 * @param buffer Buffer to upload to.
+	 * @param data Data to upload.
+	 * @param size Size of the data in bytes.
+	 * @param offset Offset into the buffer in bytes.
+	 */
+	void upload(Buffer &buffer, const void *data, size_t size,
+	            size_t offset = 0);
+
+	/**
+	 * @brief Issue all the recorded commands, in order.
+	 * Must be called on the thread the OpenGL context is current on.
+	 */
+	void execute() const;
+
+	/**
+	 * @brief Forget all the recorded commands, keeping the memory.
+	 */
+	void clear();
+
+	/**
+	 * @brief Get the number of recorded commands.
+	 * @return Number of commands.
+	 */
+	[[nodiscard]] auto size() const -> size_t { return m_commands.size(); }
+
+  private:
+	struct UseProgram {
+		ShaderProgram *program;
+	};
+
+	struct SetUniform {
+		const char *name;
+		size_t      value; ///< Index into m_uniforms.
+	};
+
+	struct BindTexture {
+		GLuint unit;
+		GLenum target;
+		GLuint texture;
+	};
+
+	struct SetEnabled {
+		GLenum capability;
+		bool   enabled;
+	};
+
+	struct DrawElements {
+		GLuint vao;
+		GLuint index_offset;
+		GLuint index_count;
+		GLint  base_vertex;
+		GLuint first_instance;
+		GLuint instance_count;
+	};
+
+	struct DrawArrays {
+		GLuint  vao;
+		GLint   first;
+		GLsizei count;
+	};
+
+	struct Upload {
+		Buffer *buffer;
+		size_t  offset;
+		size_t  data; ///< Offset into m_data.
+		size_t  size;
+	};
+
+	using Command = std::variant<UseProgram, SetUniform, BindTexture,
+	                             SetEnabled, DrawElements, DrawArrays, Upload>;
+
+	std::vector<Command>      m_commands; ///< Recorded commands, in order.
+	std::vector<UniformValue> m_uniforms; ///< Values of the uniforms.
+	std::vector<std::byte>    m_data;     ///< Data of the uploads.
+};
+
+/**
+ * @brief Records command lists on a thread pool, and replays them in the
+ * order they were recorded in.
+ *
+ * Replaying a list waits for only that list, so the first lists can be
+ * replayed while the later ones are still being recorded.
+ *
+ * # Usage
+ * ```
+ * const auto shadows = queue.record([&](CommandList &list) { ... });
+ * const auto scene   = queue.record([&](CommandList &list) { ... });
+ * queue.execute(shadows);
+ * queue.execute(scene);
+ * queue.reset();
+ * ```
+ */
+class CommandQueue {
+  public:
+	/**
+	 * @brief Start the recording threads.
+	 * @param thread_count Number of threads recording lists.
+	 */
+	explicit CommandQueue(size_t thread_count);
+
+	CommandQueue(const CommandQueue &other) = delete;
+
+	CommandQueue(const CommandQueue &&other) = delete;
+
+	auto operator=(const CommandQueue &other) = delete;
+
+	auto operator=(const CommandQueue &&other) = delete;
+
+	/**
+	 * @brief Record a list on a worker thread.
+	 * The job must not touch OpenGL, and whatever it references must stay
+	 * alive until the list is replayed.
+	 * @param job Records the commands into the list it is given.
+	 * @return Index of the list, for execute.
+	 */
+	auto record(std::function<void(CommandList &)> job) -> size_t;
+
+	/**
+	 * @brief Wait for a list to be recorded, and replay it.
+	 * Rethrows what the recording job threw.
+	 * @param index Index of the list, from record.
+	 */
+	void execute(size_t index);
+
+	/**
+	 * @brief Replay every list that has not been replayed yet, in order.
+	 */
+	void execute();
+
+	/**
+	 * @brief Forget all the lists, after they have been replayed. Call once
+	 * per frame.
+	 */
+	void reset();
+
+  private:
+	/**
+	 * @brief Recorded lists, reused between frames. A deque, so that lists do
+	 * not move while they are being recorded.
+	 */
+	std::deque<CommandList> m_lists;
+
+	std::vector<std::future<void>> m_pending;  ///< Recordings, per list.
+	std::vector<bool>              m_executed; ///< Replayed lists.
+
+	ThreadPool m_pool; ///< Threads recording the lists, stopped first.
+};
@@ -3,6 +3,7 @@
 #include <glm/gtx/euler_angles.hpp>
 #include <glm/mat4x4.hpp>
 #include <glm/vec3.hpp>
+#include <glove/Frustum.h>
 
 struct TransformComponent {
   public:
@@ -14,6 +15,21 @@ struct TransformComponent {
 		       glm::eulerAngleXYZ(rotation.x, rotation.y, rotation.z);
 	}
 
+	/**
+	 * @brief Blend between two transforms, e.g. of two simulation ticks.
+	 * @param from Transform at 0.
+	 * @param to Transform at 1.
+	 * @param alpha How far to blend.
+	 * @return The blended transform.
+	 */
+	[[nodiscard]] static auto mix(const TransformComponent &from,
+	                              const TransformComponent &to, float alpha)
+	    -> TransformComponent {
+		return {glm::mix(from.translation, to.translation, alpha),
+		        glm::mix(from.rotation, to.rotation, alpha),
+		        glm::mix(from.scale, to.scale, alpha)};
+	}
+
   public:
 	glm::vec3 translation;
 	glm::vec3 rotation; ///< Rotation in euler angles.
@@ -30,6 +46,24 @@ struct CameraComponent {
 
 	[[nodiscard]] auto projection() const -> glm::mat4;
 
+	/**
+	 * @brief Get the view frustum of the camera.
+	 * @param transform Transform of the camera.
+	 * @return The frustum in world space.
+	 */
+	[[nodiscard]] auto frustum(const TransformComponent &transform) const
+	    -> Frustum;
+
+	/**
+	 * @brief Get how many pixels one world space unit covers on screen at a
+	 * distance from the camera.
+	 * @param distance Distance from the camera.
+	 * @param viewport_height Height of the viewport in pixels.
+	 * @return Pixels per world space unit.
+	 */
+	[[nodiscard]] auto pixelsPerUnit(float distance,
+	                                 float viewport_height) const -> float;
+
   public:
 	float aspect; ///< Aspect ratio.
 	float vfov;   ///< Vertical field of view in degrees.
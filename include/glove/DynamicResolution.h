@@ -0,0 +1,60 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <optional>
+
+/**
+ * @brief Picks the resolution to render at from measured frame times, so that
+ * a fill rate bound scene stays within its frame budget.
+ *
+ * The cost of a fill rate bound frame grows with the number of pixels, i.e.
+ * with the square of the scale. The controller smooths the frame times, and
+ * only changes the scale once they leave a band just under the budget. The
+ * scale moves in fixed steps, so that render targets of the same size can be
+ * reused from a RenderTargetPool.
+ *
+ * # Usage
+ * ```
+ * if (const auto ms = gpu_timer.result())
+ *     dynamic_resolution.update(ms.value());
+ * const auto dimensions = dynamic_resolution.scale(viewport);
+ * ```
+ */
+class DynamicResolution {
+  public:
+	/**
+	 * @brief Create a controller starting at the highest scale.
+	 * @param budget_ms Frame time to stay within, in milliseconds.
+	 * @param min_scale Lowest scale of the width and height.
+	 * @param max_scale Highest scale of the width and height.
+	 */
+	explicit DynamicResolution(float budget_ms, float min_scale = 0.5f,
+	                           float max_scale = 1.0f);
+
+	/**
+	 * @brief Feed the controller the time of a frame.
+	 * @param frame_ms Frame time in milliseconds.
+	 * @return The scale to render the next frame at.
+	 */
+	auto update(float frame_ms) -> float;
+
+	/**
+	 * @brief Get the current scale.
+	 * @return Scale of the width and height.
+	 */
+	[[nodiscard]] auto getScale() const -> float { return m_scale; }
+
+	/**
+	 * @brief Scale full resolution dimensions by the current scale.
+	 * @param dimensions Full width and height.
+	 * @return Scaled width and height, at least one pixel each.
+	 */
+	[[nodiscard]] auto scale(glm::ivec2 dimensions) const -> glm::ivec2;
+
+  private:
+	float                m_budget;    ///< Frame time budget in milliseconds.
+	float                m_min_scale; ///< Lowest scale.
+	float                m_max_scale; ///< Highest scale.
+	float                m_scale;     ///< Current scale.
+	std::optional<float> m_average;   ///< Smoothed frame time.
+};
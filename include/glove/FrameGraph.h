@@ -0,0 +1,270 @@
+#pragma once
+
+#include <functional>
+#include <glove/Framebuffer.h>
+#include <glove/GpuProfiler.h>
+#include <glove/RenderTargetPool.h>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Handle of a resource in a frame graph.
+ */
+using FrameResource = size_t;
+
+/**
+ * @brief Render passes and the attachments they read and write, executed in
+ * the order they were added.
+ *
+ * The passes are added every frame, and the graph compiles them into a plan
+ * the first time and whenever they change, e.g. after a resize or when a pass
+ * is turned off. The plan:
+ *
+ * - Culls the passes whose outputs are never read by a pass that is kept.
+ *   Passes with side effects, e.g. drawing to the backbuffer, are always kept.
+ * - Leases every transient target from a RenderTargetPool right before its
+ *   first pass, and gives it back after its last pass, invalidating the
+ *   content. Targets whose lifetimes do not overlap share textures.
+ * - Clears transient targets in the pass that creates them, and attaches what
+ *   a pass writes to a framebuffer that is bound before the pass executes.
+ *
+ * Resources owned outside of the graph, like a shadow map, are imported, so
+ * that the passes writing and reading them are ordered and culled too. They
+ * are never attached, cleared or invalidated.
+ *
+ * # Usage
+ * ```
+ * FrameResource color;
+ * graph.addPass(
+ *     "scene",
+ *     [&](FrameGraph::PassBuilder &builder) {
+ *         color = builder.create({AttachmentType::Color, size, 1});
+ *     },
+ *     [&](const FrameGraph::PassContext &context) { ... });
+ * graph.addPass(
+ *     "present",
+ *     [&](FrameGraph::PassBuilder &builder) {
+ *         builder.read(color);
+ *         builder.sideEffect();
+ *     },
+ *     [&](const FrameGraph::PassContext &context) {
+ *         context.getTarget(color).bindToSlot(0);
+ *         ...
+ *     });
+ * graph.execute();
+ * ```
+ */
+class FrameGraph {
+  public:
+	/**
+	 * @brief Declares what a pass reads and writes, while it is added.
+	 */
+	class PassBuilder {
+	  public:
+		/**
+		 * @brief Create a transient target, written by this pass and cleared
+		 * before it.
+		 * @param desc Description of the target.
+		 * @return The target.
+		 */
+		auto create(const RenderTargetDesc &desc) -> FrameResource;
+
+		/**
+		 * @brief Read a resource written by an earlier pass, e.g. by sampling
+		 * it.
+		 * @param resource The resource.
+		 * @return The resource.
+		 */
+		auto read(FrameResource resource) -> FrameResource;
+
+		/**
+		 * @brief Write to a resource, keeping what earlier passes wrote.
+		 * @param resource The resource.
+		 * @return The resource.
+		 */
+		auto write(FrameResource resource) -> FrameResource;
+
+		/**
+		 * @brief Mark the pass as having effects outside of the graph, so
+		 * that it is never culled.
+		 */
+		void sideEffect();
+
+	  private:
+		friend class FrameGraph;
+
+		PassBuilder(FrameGraph &graph, size_t pass)
+		    : m_graph(graph), m_pass(pass) {}
+
+		FrameGraph &m_graph; ///< Graph the pass is added to.
+		size_t      m_pass;  ///< Index of the pass.
+	};
+
+	/**
+	 * @brief What a pass gets while it executes.
+	 */
+	class PassContext {
+	  public:
+		/**
+		 * @brief Get a transient target the pass declared.
+		 * @param resource The target.
+		 * @return The leased target.
+		 */
+		[[nodiscard]] auto getTarget(FrameResource resource) const
+		    -> const RenderTarget &;
+
+		/**
+		 * @brief Get the framebuffer of the pass, with the transient targets
+		 * it writes attached. Bound before the pass executes.
+		 * @return The framebuffer, or nullptr if the pass writes no transient
+		 * targets.
+		 */
+		[[nodiscard]] auto getFramebuffer() const -> Framebuffer * {
+			return m_framebuffer;
+		}
+
+	  private:
+		friend class FrameGraph;
+
+		PassContext(const FrameGraph &graph, Framebuffer *framebuffer)
+		    : m_graph(graph), m_framebuffer(framebuffer) {}
+
+		const FrameGraph &m_graph;       ///< Graph executing the pass.
+		Framebuffer *     m_framebuffer; ///< Framebuffer of the pass.
+	};
+
+	using SetupFunction   = std::function<void(PassBuilder &)>;
+	using ExecuteFunction = std::function<void(const PassContext &)>;
+
+	/**
+	 * @brief Create an empty graph.
+	 * @param pool Pool the transient targets are leased from.
+	 */
+	explicit FrameGraph(RenderTargetPool &pool);
+
+	FrameGraph(const FrameGraph &other) = delete;
+
+	FrameGraph(const FrameGraph &&other) = delete;
+
+	auto operator=(const FrameGraph &other) = delete;
+
+	auto operator=(const FrameGraph &&other) = delete;
+
+	/**
+	 * @brief Import a resource owned outside of the graph.
+	 * @param name Name of the resource, for debugging.
+	 * @return The resource.
+	 */
+	auto importResource(const std::string &name) -> FrameResource;
+
+	/**
+	 * @brief Add a pass. The setup runs right away, the execution later in
+	 * execute, if the pass is not culled.
+	 * @param name Name of the pass, for debugging.
+	 * @param setup Declares the resources of the pass.
+	 * @param execute Renders the pass.
+	 */
+	void addPass(const std::string &name, const SetupFunction &setup,
+	             ExecuteFunction execute);
+
+	/**
+	 * @brief Time every pass that executes as a scope named after it.
+	 * @param profiler Profiler timing the passes, or nullptr for none.
+	 */
+	void setProfiler(GpuProfiler *profiler) { m_profiler = profiler; }
+
+	/**
+	 * @brief Compile the passes added since the last execute, unless they are
+	 * the same as the ones compiled last.
+	 */
+	void compile();
+
+	/**
+	 * @brief Compile and execute the passes, then forget them, ready for the
+	 * next frame.
+	 */
+	void execute();
+
+	/**
+	 * @brief Get the names of the passes that are kept, in execution order.
+	 * @return Names of the passes. Valid after compile.
+	 */
+	[[nodiscard]] auto getCompiledPasses() const -> std::vector<std::string>;
+
+	/**
+	 * @brief Get the most transient targets alive at once, which is how many
+	 * textures the graph leases from the pool at most.
+	 * @return Number of targets. Valid after compile.
+	 */
+	[[nodiscard]] auto getPeakTargets() const -> size_t {
+		return m_peak_targets;
+	}
+
+	/**
+	 * @brief Get how many times the passes have been compiled.
+	 * @return Number of compiles.
+	 */
+	[[nodiscard]] auto getCompileCount() const -> size_t {
+		return m_compile_count;
+	}
+
+  private:
+	/**
+	 * @brief A resource, as declared by the passes.
+	 */
+	struct Resource {
+		std::string                     name;    ///< Name for debugging.
+		std::optional<RenderTargetDesc> desc;    ///< Empty if imported.
+		size_t                          creator; ///< Pass creating it.
+
+		auto operator==(const Resource &other) const -> bool {
+			return name == other.name && desc == other.desc &&
+			       creator == other.creator;
+		}
+	};
+
+	/**
+	 * @brief A pass, as declared by its setup.
+	 */
+	struct Pass {
+		std::string                name;        ///< Name for debugging.
+		std::vector<FrameResource> creates;     ///< Created targets.
+		std::vector<FrameResource> reads;       ///< Read resources.
+		std::vector<FrameResource> writes;      ///< Written resources.
+		bool                       side_effect; ///< Never culled?
+
+		auto operator==(const Pass &other) const -> bool {
+			return name == other.name && creates == other.creates &&
+			       reads == other.reads && writes == other.writes &&
+			       side_effect == other.side_effect;
+		}
+	};
+
+	/**
+	 * @brief What a kept pass does besides executing.
+	 */
+	struct Step {
+		size_t                     pass;     ///< Index of the pass.
+		std::vector<FrameResource> acquires; ///< Targets leased before.
+		std::vector<FrameResource> attaches; ///< Targets attached.
+		std::vector<FrameResource> releases; ///< Targets given back after.
+		std::unique_ptr<Framebuffer> framebuffer; ///< Made on first use.
+	};
+
+	std::vector<Resource>        m_resources; ///< Resources of this frame.
+	std::vector<Pass>            m_passes;    ///< Passes of this frame.
+	std::vector<ExecuteFunction> m_executes;  ///< Executions of the passes.
+
+	std::vector<Resource> m_compiled_resources; ///< Resources compiled last.
+	std::vector<Pass>     m_compiled_passes;    ///< Passes compiled last.
+	std::vector<Step>     m_steps;              ///< The compiled plan.
+	size_t                m_peak_targets{0};    ///< Most targets at once.
+	size_t                m_compile_count{0};   ///< Number of compiles.
+
+	RenderTargetPool &m_pool;             ///< Pool of the transient targets.
+	GpuProfiler *     m_profiler{nullptr}; ///< Times the passes, if any.
+	std::vector<std::unique_ptr<RenderTarget>>
+	    m_targets; ///< Targets leased while executing.
+};
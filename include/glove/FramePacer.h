@@ -0,0 +1,117 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <chrono>
+#include <deque>
+
+/**
+ * @brief How frames are presented.
+ */
+enum class PresentMode {
+	VSync,         ///< Wait for the vertical blank, never tear.
+	AdaptiveVSync, ///< Wait for the vertical blank, but tear when late.
+	Uncapped,      ///< Present right away, as fast as possible.
+	Capped,        ///< Present right away, at most at a fixed rate.
+};
+
+/**
+ * @brief Most frames the CPU may submit before the GPU has finished the
+ * oldest of them, by default. Every frame in flight adds a frame of input
+ * latency.
+ */
+constexpr size_t gFramesInFlight = 2;
+
+/**
+ * @brief Number of present times a frame pacer remembers.
+ */
+constexpr size_t gPresentHistory = 120;
+
+/**
+ * @brief Paces the frames of a window: sets the swap interval, caps the frame
+ * rate, and keeps the CPU from running too far ahead of the GPU.
+ *
+ * A fence is inserted after every swap. Once more frames than allowed are in
+ * flight, the pacer waits for the fence of the oldest, so the CPU never queues
+ * up frames that would only be shown late.
+ *
+ * Capped frames are timed with a deadline per frame. The pacer sleeps until
+ * shortly before the deadline, as sleeps routinely overshoot by a millisecond
+ * or more, and spins for the rest.
+ *
+ * # Usage
+ * ```
+ * pacer.setMode(PresentMode::Capped, 144.0f);
+ * // Render a frame
+ * pacer.beforeSwap();
+ * glfwSwapBuffers(window);
+ * pacer.afterSwap();
+ * ```
+ */
+class FramePacer {
+  public:
+	using Clock     = std::chrono::steady_clock;
+	using TimePoint = Clock::time_point;
+
+	/**
+	 * @brief Create a pacer and set the swap interval of the current context.
+	 * @param mode How frames are presented.
+	 * @param rate Most frames per second, only used when capped.
+	 * @param frames_in_flight Most frames in flight, at least one.
+	 */
+	explicit FramePacer(PresentMode mode = PresentMode::VSync,
+	                    float rate = 0.0f,
+	                    size_t frames_in_flight = gFramesInFlight);
+
+	FramePacer(const FramePacer &other) = delete;
+
+	FramePacer(const FramePacer &&other) = delete;
+
+	auto operator=(const FramePacer &other) = delete;
+
+	auto operator=(const FramePacer &&other) = delete;
+
+	~FramePacer();
+
+	/**
+	 * @brief Change how frames are presented.
+	 * @param mode How frames are presented.
+	 * @param rate Most frames per second, only used when capped.
+	 */
+	void setMode(PresentMode mode, float rate = 0.0f);
+
+	/**
+	 * @brief Get how frames are presented.
+	 * @return The mode.
+	 */
+	[[nodiscard]] auto getMode() const -> PresentMode { return m_mode; }
+
+	/**
+	 * @brief Wait for the deadline of the frame, if capped.
+	 */
+	void beforeSwap();
+
+	/**
+	 * @brief Record the present time of the frame, and wait for the GPU if too
+	 * many frames are in flight.
+	 */
+	void afterSwap();
+
+	/**
+	 * @brief Get the times the last frames were presented, oldest first.
+	 * These are the times the swaps returned, which is when the frames were
+	 * queued for presentation, or shown if the driver blocks until then.
+	 * @return Up to gPresentHistory times.
+	 */
+	[[nodiscard]] auto getPresentTimes() const
+	    -> const std::deque<TimePoint> & {
+		return m_presents;
+	}
+
+  private:
+	PresentMode           m_mode;             ///< How frames are presented.
+	Clock::duration       m_period;           ///< Time per frame if capped.
+	TimePoint             m_deadline;         ///< Deadline of the next frame.
+	size_t                m_frames_in_flight; ///< Most frames in flight.
+	std::deque<GLsync>    m_fences;           ///< Fences of frames in flight.
+	std::deque<TimePoint> m_presents;         ///< Recent present times.
+};
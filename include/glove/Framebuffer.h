@@ -1,5 +1,10 @@
+#pragma once
+
 #include <GL/glew.h>
+#include <glm/glm.hpp>
+#include <memory>
 #include <optional>
+#include <vector>
 
 /**
  * @brief Abstract type of framebuffer attachment.
@@ -16,7 +21,8 @@ enum class AttachmentType {
  *
  * # Construction
  * A framebuffer is constructed by first calling the constructor and then adding
- * one or more attachments via "addAttachment".
+ * one or more attachments via "addAttachment", or by attaching render targets
+ * leased from a RenderTargetPool via "attach".
  *
  * # Binding
  * The framebuffer is bound using "bind" and will remain bound until another
@@ -75,14 +81,59 @@ class Framebuffer {
 	 */
 	void addAttachment(AttachmentType type, glm::ivec2 dimensions);
 
+	/**
+	 * @brief Attach a render target, replacing whatever was attached to the
+	 * same attachment point. The framebuffer does not take ownership, and
+	 * does not need to be bound.
+	 * The dimensions of the framebuffer become those of the target, so all
+	 * targets attached at once should be the same size.
+	 * @param target Render target to attach.
+	 * @param color_index Which color attachment to attach to, if the target is
+	 * a color target.
+	 */
+	void attach(const class RenderTarget &target, size_t color_index = 0);
+
+	/**
+	 * @brief Attach a texture owned by someone else, see the above.
+	 * @param type Type of attachment the texture is.
+	 * @param texture Texture to attach.
+	 * @param dimensions Dimensions of the texture.
+	 * @param color_index Which color attachment to attach to, if the texture
+	 * is a color texture.
+	 */
+	void attach(AttachmentType type, GLuint texture, glm::ivec2 dimensions,
+	            size_t color_index = 0);
+
+	/**
+	 * @brief Attach one layer of an array texture owned by someone else, e.g.
+	 * one cascade of a cascaded shadow map.
+	 * @param type Type of attachment the texture is.
+	 * @param texture Array texture to attach a layer of.
+	 * @param layer Layer to attach.
+	 * @param dimensions Dimensions of the texture.
+	 */
+	void attachLayer(AttachmentType type, GLuint texture, GLint layer,
+	                 glm::ivec2 dimensions);
+
 	/**
 	 * @brief Clear the framebuffer.
 	 * NOTE: Can not clear the default framebuffer.
 	 */
 	void clear() const;
 
+	/**
+	 * @brief Clear one attachment, color to black and depth to the far plane.
+	 * The framebuffer does not need to be bound.
+	 * @param type Type of attachment to clear.
+	 * @param color_index Which color attachment to clear, if a color
+	 * attachment.
+	 */
+	void clearAttachment(AttachmentType type, size_t color_index = 0) const;
+
 	/**
 	 * @brief Resize the framebuffer.
+	 * Only reallocates the attachments added with "addAttachment", attached
+	 * render targets are resized by attaching new ones.
 	 * @param width The new width.
 	 * @param height The new height.
 	 */
@@ -93,9 +144,10 @@ class Framebuffer {
 	 * @param source Source framebuffer.
 	 * @param source_extents Extents to blit from framebuffer.
 	 * @param destination_extents Extents to blit onto this framebuffer.
+	 * @param filter GL_LINEAR to filter when the extents differ in size.
 	 */
 	void blit(const Framebuffer *source, glm::ivec4 source_extents,
-	          glm::ivec4 destination_extents);
+	          glm::ivec4 destination_extents, GLenum filter = GL_NEAREST);
 
 	/**
 	 * @brief Bind the depth attachment of the framebuffer as a texture.
@@ -110,8 +162,19 @@ class Framebuffer {
 	 */
 	Framebuffer(GLuint fbo);
 
+	/**
+	 * @brief Remember which texture is attached where, for "clear" and
+	 * "resize".
+	 * @param type Type of attachment.
+	 * @param texture Attached texture.
+	 * @param color_index Color attachment index, if a color attachment.
+	 */
+	void trackAttachment(AttachmentType type, GLuint texture,
+	                     size_t color_index);
+
   private:
 	GLuint              m_fbo;                ///< Framebuffer object.
+	std::vector<GLuint> m_owned_textures;     ///< Textures made for attachments
 	std::vector<GLuint> m_color_attachments;  ///< The color attachment textures
 	std::optional<GLuint> m_depth_attachment; ///< Depth attachment texture
 	std::optional<GLuint>
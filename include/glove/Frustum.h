@@ -0,0 +1,56 @@
+#pragma once
+
+#include <array>
+#include <glm/glm.hpp>
+#include <glove/Mesh.h>
+
+/**
+ * @brief A view frustum, as six planes facing inwards.
+ */
+struct Frustum {
+  public:
+	/**
+	 * @brief Extract the frustum of a view projection matrix.
+	 * Uses the method from "Fast Extraction of Viewing Frustum Planes from the
+	 * World-View-Projection Matrix" by Gribb and Hartmann. Works with both
+	 * perspective and orthographic projections.
+	 * @param view_projection Projection matrix multiplied with the view matrix.
+	 * @return The frustum in world space.
+	 */
+	static auto fromMatrix(const glm::mat4 &view_projection) -> Frustum;
+
+	/**
+	 * @brief Test if a sphere is at least partially inside the frustum.
+	 * @param center Center of the sphere.
+	 * @param radius Radius of the sphere.
+	 * @return Is the sphere visible?
+	 */
+	[[nodiscard]] auto intersectsSphere(const glm::vec3 &center,
+	                                    float            radius) const -> bool;
+
+	/**
+	 * @brief Test if an axis aligned box is at least partially inside the
+	 * frustum. Conservative, some boxes near the corners of the frustum are
+	 * reported as visible even though they are not.
+	 * @param min Minimum corner of the box.
+	 * @param max Maximum corner of the box.
+	 * @return Is the box visible?
+	 */
+	[[nodiscard]] auto intersectsBox(const glm::vec3 &min,
+	                                 const glm::vec3 &max) const -> bool;
+
+	/**
+	 * @brief Test if transformed bounds are at least partially inside the
+	 * frustum. The cheap sphere test is done first, and the box test only if
+	 * the sphere intersects the frustum.
+	 * @param bounds Bounds in model space.
+	 * @param transform Model to world space transform.
+	 * @return Are the bounds visible?
+	 */
+	[[nodiscard]] auto intersects(const Bounds &   bounds,
+	                              const glm::mat4 &transform) const -> bool;
+
+  public:
+	std::array<glm::vec4, 6> planes; ///< Left, right, bottom, top, near and
+	                                 ///< far planes, as normal and distance.
+};
@@ -5,6 +5,58 @@
 #include <variant>
 #include <vector>
 
+/**
+ * @brief Length of a simulation tick, the delta time every update is given,
+ * in seconds.
+ */
+constexpr float gTickLength = 1.0f / 60.0f;
+
+/**
+ * @brief Most ticks simulated in one frame. Catching up on more time than
+ * that, e.g. after a hitch, would only make the next frame slower still, so
+ * the rest is dropped and the game slows down instead.
+ */
+constexpr int gMaxTicksPerFrame = 5;
+
+/**
+ * @brief Splits the time between frames into fixed ticks.
+ *
+ * The time is kept in ticks rather than seconds, so that whole ticks are taken
+ * off exactly, and a frame at the limit runs exactly gMaxTicksPerFrame ticks.
+ *
+ * # Usage
+ * ```
+ * clock.advance(dt);
+ * while (clock.tick())
+ *     state->update(gTickLength);
+ * state->render(clock.alpha());
+ * ```
+ */
+class TickClock {
+  public:
+	/**
+	 * @brief Add the time since the last frame, at most gMaxTicksPerFrame
+	 * ticks in all.
+	 * @param dt Delta time, in seconds.
+	 */
+	void advance(float dt);
+
+	/**
+	 * @brief Take one tick off the time, if there is a whole tick left.
+	 * @return Should a tick be simulated?
+	 */
+	auto tick() -> bool;
+
+	/**
+	 * @brief Get how far the game is towards the next tick.
+	 * @return From 0 to 1, once all the whole ticks are taken.
+	 */
+	[[nodiscard]] auto alpha() const -> float { return m_ticks; }
+
+  private:
+	float m_ticks = 0.0f; ///< Time not simulated yet, in ticks.
+};
+
 /**
  * @brief No state transition should occur.
  */
@@ -42,7 +94,9 @@ using StateTransition = std::variant<None, Push, Pop, Transition>;
  * @brief A manifest of static information about a game state.
  */
 struct StateManifest {
-	std::string title; ///< The game state's title.
+	std::string title;                             ///< The game state's title.
+	PresentMode present_mode = PresentMode::VSync; ///< How frames are shown.
+	float       frame_rate   = 0.0f;               ///< Most frames per second.
 };
 
 /**
@@ -89,17 +143,21 @@ class IGameState {
 	virtual auto input(Input input) -> StateTransition = 0;
 
 	/**
-	 * @brief Drive the game state forward.
-	 * @param dt Delta time.
+	 * @brief Drive the game state forward by one tick.
+	 * @param dt Delta time, always gTickLength.
 	 * @return Should the game transition states as a result of the input? If so
 	 * how?
 	 */
 	virtual auto update(float dt) -> StateTransition = 0;
 
 	/**
-	 * @brief Render the game as of this game state.
+	 * @brief Render the game as of this game state. Frames and ticks do not
+	 * line up, so the game is drawn part of the way from the previous tick to
+	 * the last one.
+	 * @param alpha How far to interpolate from the previous tick to the last,
+	 * from 0 to 1.
 	 */
-	virtual void render() = 0;
+	virtual void render(float alpha) = 0;
 };
 
 /**
@@ -136,8 +194,8 @@ class Core {
 
 	/**
 	 * @brief Run the game.
-	 * Update states and pass them input. Push and pop states based on state
-	 * transitions.
+	 * Update states in fixed ticks, render them once per frame and pass them
+	 * input. Push and pop states based on state transitions.
 	 */
 	void run();
 
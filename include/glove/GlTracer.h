@@ -0,0 +1,100 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <string>
+
+/**
+ * @brief Number of GL calls of every kind glove sent to the driver.
+ */
+struct GlCallStats {
+	size_t draws;      ///< Draw calls, including indirect and instanced.
+	size_t dispatches; ///< Compute dispatches.
+	size_t binds;      ///< Program, vertex array, buffer and framebuffer binds.
+	size_t uniforms;   ///< Uniform sets.
+	size_t uploads;    ///< Buffer and texture uploads.
+	size_t uploaded;   ///< Bytes uploaded to buffers.
+};
+
+/**
+ * @brief Counts the GL calls of every frame, by kind.
+ *
+ * GLEW loads every entry point past OpenGL 1.1 into a function pointer.
+ * Enabling the tracer swaps the pointers of the traced entry points for ones
+ * that count the call and forward it, and disabling it swaps them back, so a
+ * disabled tracer costs nothing at all.
+ *
+ * NOTE: The OpenGL 1.1 entry points, e.g. glBindTexture and glTexImage2D, are
+ * exported by the GL library itself and can not be traced. Creating a window
+ * loads the entry points again, so the tracer has to be enabled after it.
+ *
+ * Glove draws through glDrawElementsBaseVertex and glDrawArraysInstanced, and
+ * binds textures for sampling through glBindTextureUnit, so all of its draws
+ * and binds are counted. What is left untraced:
+ * - Texture binds for creating or editing, see StateCache::bindTexture.
+ * - Uploads through glTexImage2D and glTexSubImage2D, use glTextureSubImage2D.
+ * - glClear, glViewport, glEnable and the other fixed function state.
+ * - Draws through glDrawArrays and glDrawElements, e.g. in the small apps.
+ *
+ * There is only one OpenGL context, so there is only one tracer, see "get".
+ *
+ * # Usage
+ * ```
+ * auto &tracer = GlTracer::get();
+ * tracer.setEnabled(true);
+ * // Render a frame
+ * tracer.endFrame();
+ * const auto draws = tracer.lastFrame().draws;
+ * ```
+ */
+class GlTracer {
+  public:
+	GlTracer(const GlTracer &other) = delete;
+
+	GlTracer(const GlTracer &&other) = delete;
+
+	auto operator=(const GlTracer &other) = delete;
+
+	auto operator=(const GlTracer &&other) = delete;
+
+	/**
+	 * @brief Get the tracer of the current context.
+	 * @return The tracer.
+	 */
+	static auto get() -> GlTracer &;
+
+	/**
+	 * @brief Start or stop tracing, by swapping the entry points.
+	 * @param enabled Should the calls be counted?
+	 */
+	void setEnabled(bool enabled);
+
+	/**
+	 * @brief Are the calls counted?
+	 * @return Is the tracer enabled?
+	 */
+	[[nodiscard]] auto isEnabled() const -> bool { return m_enabled; }
+
+	/**
+	 * @brief Start counting a new frame.
+	 * The counts of the frame that ended are kept for "lastFrame".
+	 */
+	void endFrame();
+
+	/**
+	 * @brief Get the counts of the last whole frame.
+	 * @return Calls by kind.
+	 */
+	[[nodiscard]] auto lastFrame() const -> GlCallStats { return m_last_frame; }
+
+	/**
+	 * @brief Format the counts of the last whole frame, one kind per line.
+	 * @return The counts.
+	 */
+	[[nodiscard]] auto report() const -> std::string;
+
+  private:
+	GlTracer();
+
+	bool        m_enabled;    ///< Are the entry points swapped?
+	GlCallStats m_last_frame; ///< Counts of the last whole frame.
+};
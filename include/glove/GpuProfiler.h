@@ -0,0 +1,162 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <array>
+#include <glove/GpuTimer.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @brief Number of frames the GPU profiler averages over.
+ */
+constexpr size_t gGpuProfilerWindow = 120;
+
+/**
+ * @brief GPU time of a named scope over the last frames it ran in.
+ */
+struct GpuScopeStats {
+	std::string name;    ///< Name of the scope.
+	float       average; ///< Mean time in milliseconds.
+	float       maximum; ///< Longest time in milliseconds.
+	float       latest;  ///< Most recent time in milliseconds.
+};
+
+/**
+ * @brief Measures how long the GPU spends on named scopes, e.g. the passes of
+ * a frame.
+ *
+ * Scopes are timed with pairs of GL_TIMESTAMP queries, so unlike a GpuTimer
+ * they may nest and run inside one. Every frame gets its own queries from a
+ * ring gGpuTimerLatency frames deep, and only frames the GPU has finished are
+ * read back. If the GPU falls further behind than that, frames are dropped
+ * rather than waited for.
+ *
+ * # Usage
+ * ```
+ * profiler.begin("shadows");
+ * // Issue draw calls
+ * profiler.end();
+ * profiler.endFrame();
+ * for (const auto &stats : profiler.getStats())
+ *     // Use the times of earlier frames
+ * ```
+ */
+class GpuProfiler {
+  public:
+	/**
+	 * @brief Times a scope for as long as it is alive.
+	 */
+	class Scope {
+	  public:
+		Scope(GpuProfiler &profiler, const std::string &name)
+		    : m_profiler(profiler) {
+			m_profiler.begin(name);
+		}
+
+		Scope(const Scope &other) = delete;
+
+		Scope(const Scope &&other) = delete;
+
+		auto operator=(const Scope &other) = delete;
+
+		auto operator=(const Scope &&other) = delete;
+
+		~Scope() { m_profiler.end(); }
+
+	  private:
+		GpuProfiler &m_profiler; ///< Profiler timing the scope.
+	};
+
+	GpuProfiler();
+
+	GpuProfiler(const GpuProfiler &other) = delete;
+
+	GpuProfiler(const GpuProfiler &&other) = delete;
+
+	auto operator=(const GpuProfiler &other) = delete;
+
+	auto operator=(const GpuProfiler &&other) = delete;
+
+	~GpuProfiler();
+
+	/**
+	 * @brief Start timing a scope. A scope that runs several times in a frame
+	 * is timed as the sum of its runs.
+	 * @param name Name of the scope.
+	 */
+	void begin(const std::string &name);
+
+	/**
+	 * @brief Stop timing the innermost scope.
+	 */
+	void end();
+
+	/**
+	 * @brief Finish the frame, and read back any earlier frame that is done.
+	 */
+	void endFrame();
+
+	/**
+	 * @brief Get the times of every scope, in the order they first ran.
+	 * @return Times of the frames read back so far.
+	 */
+	[[nodiscard]] auto getStats() const -> const std::vector<GpuScopeStats> & {
+		return m_stats;
+	}
+
+	/**
+	 * @brief Format the times of every scope as a table, one scope per line.
+	 * @return The table.
+	 */
+	[[nodiscard]] auto report() const -> std::string;
+
+  private:
+	/**
+	 * @brief A run of a scope in a frame.
+	 */
+	struct Sample {
+		size_t scope; ///< Index of the scope.
+		size_t begin; ///< Query at the start of the run.
+		size_t end;   ///< Query at the end of the run.
+	};
+
+	/**
+	 * @brief The queries of one frame in the ring.
+	 */
+	struct Frame {
+		std::vector<GLuint> queries; ///< Grown to the most queries used.
+		size_t              used;    ///< Queries issued this frame.
+		std::vector<Sample> samples; ///< Runs of scopes.
+		bool                pending; ///< Issued but not read yet?
+	};
+
+	/**
+	 * @brief The last times of a scope.
+	 */
+	struct History {
+		std::array<float, gGpuProfilerWindow> times; ///< Ring of times.
+		size_t                                count; ///< Times in the ring.
+		size_t                                next;  ///< Time written next.
+	};
+
+	/**
+	 * @brief Issue a timestamp query in the current frame.
+	 * @return Index of the query in the frame.
+	 */
+	auto timestamp() -> size_t;
+
+	/**
+	 * @brief Read back the times of a finished frame.
+	 */
+	void read(Frame &frame);
+
+	std::array<Frame, gGpuTimerLatency> m_frames;  ///< Ring of frames.
+	size_t                              m_current; ///< Frame being issued.
+	std::vector<size_t> m_open; ///< Samples of the open scopes, innermost last.
+
+	std::unordered_map<std::string, size_t>
+	                           m_scopes;    ///< Index of every scope by name.
+	std::vector<History>       m_histories; ///< Last times of every scope.
+	std::vector<GpuScopeStats> m_stats;     ///< Times of every scope.
+};
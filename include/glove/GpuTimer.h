@@ -0,0 +1,72 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <array>
+#include <optional>
+#include <utility>
+
+/**
+ * @brief Number of frames a GPU timer keeps in flight. Results are read this
+ * many frames late, so that reading them never stalls on the GPU.
+ */
+constexpr size_t gGpuTimerLatency = 4;
+
+/**
+ * @brief Measures how long the GPU spends on a span of commands, once per
+ * frame.
+ *
+ * Every frame gets its own GL_TIME_ELAPSED query from a ring, and only
+ * queries that the GPU has finished are read back.
+ *
+ * # Usage
+ * ```
+ * timer.begin();
+ * // Issue draw calls
+ * timer.end();
+ * if (const auto ms = timer.result())
+ *     // Use the time of an earlier frame
+ * ```
+ */
+class GpuTimer {
+  public:
+	/**
+	 * @brief Create the queries.
+	 */
+	GpuTimer();
+
+	GpuTimer(const GpuTimer &other) = delete;
+
+	GpuTimer(const GpuTimer &&other) = delete;
+
+	auto operator=(const GpuTimer &other) = delete;
+
+	auto operator=(const GpuTimer &&other) = delete;
+
+	~GpuTimer();
+
+	/**
+	 * @brief Start timing. Only one GL_TIME_ELAPSED query can be active at a
+	 * time, so timers can not be nested.
+	 */
+	void begin();
+
+	/**
+	 * @brief Stop timing, and read back any earlier query that is done.
+	 */
+	void end();
+
+	/**
+	 * @brief Take the most recent time the GPU has reported, so that every
+	 * time is only taken once.
+	 * @return Milliseconds, or nothing if no new query is done.
+	 */
+	auto result() -> std::optional<float> {
+		return std::exchange(m_latest, std::nullopt);
+	}
+
+  private:
+	std::array<GLuint, gGpuTimerLatency> m_queries; ///< Ring of queries.
+	std::array<bool, gGpuTimerLatency>   m_pending; ///< Queries not read yet.
+	size_t               m_next;   ///< Query the next frame writes.
+	std::optional<float> m_latest; ///< Most recent result in milliseconds.
+};
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+/**
+ * @brief A read only memory mapping of a whole file.
+ *
+ * The mapping is released when the object is destroyed, so any pointer
+ * obtained through "data" must not outlive it.
+ */
+class MappedFile {
+  public:
+	/**
+	 * @brief Map a file into memory.
+	 * @param path Path to the file to map.
+	 * @return The mapped file, or nullptr if the file could not be opened or
+	 * mapped. Empty files can not be mapped.
+	 */
+	static auto open(const std::string &path) -> std::unique_ptr<MappedFile>;
+
+	MappedFile(const MappedFile &other) = delete;
+
+	MappedFile(const MappedFile &&other) = delete;
+
+	auto operator=(const MappedFile &other) = delete;
+
+	auto operator=(const MappedFile &&other) = delete;
+
+	~MappedFile();
+
+	/**
+	 * @brief Get a pointer to the start of the mapped file.
+	 * @return Pointer to the first byte of the file.
+	 */
+	[[nodiscard]] auto data() const -> const std::byte * { return m_data; }
+
+	/**
+	 * @brief Get the size of the mapped file.
+	 * @return Size in bytes.
+	 */
+	[[nodiscard]] auto size() const -> size_t { return m_size; }
+
+  private:
+	MappedFile(const std::byte *data, size_t size, void *handle);
+
+  private:
+	const std::byte *m_data;   ///< Start of the mapping.
+	size_t           m_size;   ///< Size of the mapping in bytes.
+	void *           m_handle; ///< Platform specific mapping handle.
+};
+
+/**
+ * @brief Hash a block of memory.
+ *
+ * A word-wise variant of 64 bit FNV-1a. Not suitable for cryptographic use, but
+ * plenty to detect that a file has changed.
+ *
+ * @param data Data to hash.
+ * @param size Size of the data in bytes.
+ * @return 64 bit hash of the data.
+ */
+auto hashBytes(const std::byte *data, size_t size) -> uint64_t;
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <array>
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <glove/VertexFormats.h>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Axis aligned bounding box, and a bounding sphere.
+ */
+struct Bounds {
+	glm::vec3 min;    ///< Minimum corner.
+	glm::vec3 max;    ///< Maximum corner.
+	glm::vec3 center; ///< Center of the bounding sphere.
+	float     radius; ///< Radius of the bounding sphere.
+};
+
+/**
+ * @brief Surface description of (parts of) a mesh.
+ */
+struct Material {
+	std::string name;          ///< Name of the material.
+	glm::vec4   diffuse_color; ///< Diffuse color and opacity.
+	std::string diffuse_map;   ///< Path to the diffuse texture, if any.
+};
+
+/**
+ * @brief Maximum number of simplified levels of detail per submesh.
+ */
+constexpr size_t gMaxLods = 4;
+
+/**
+ * @brief A simplified version of a submesh. It is another range of the index
+ * buffer, using the same vertices as the submesh.
+ */
+struct Lod {
+	uint32_t index_offset; ///< Offset of the first index in the index buffer.
+	uint32_t index_count;  ///< Number of indices in the level of detail.
+	float    error;        ///< Distance from the full detail surface.
+};
+
+/**
+ * @brief A contiguous range of a mesh's index buffer that is drawn as one
+ * unit.
+ */
+struct Submesh {
+	uint32_t index_offset;   ///< Offset of the first index in the buffer.
+	uint32_t index_count;    ///< Number of indices in the submesh.
+	uint32_t base_vertex;    ///< Value added to every index when drawing.
+	uint32_t material;       ///< Index into the mesh's materials.
+	Bounds   bounds    = {}; ///< Bounds of the vertices used by the submesh.
+	uint32_t lod_count = 0;  ///< Number of simplified levels of detail.
+	std::array<Lod, gMaxLods>
+	    lods = {}; ///< Simplified levels of detail, from finest to coarsest.
+};
+
+/**
+ * @brief Efficiency of an index buffer with regard to the post-transform
+ * vertex cache.
+ */
+struct VertexCacheStats {
+	float acmr; ///< Average cache miss ratio, vertex loads per triangle.
+	float atvr; ///< Average transform to vertex ratio, 1.0 is optimal.
+};
+
+/**
+ * @brief Vertex cache efficiency of a mesh before and after optimization.
+ */
+struct MeshOptimizerStats {
+	VertexCacheStats before; ///< Stats of the mesh as it was imported.
+	VertexCacheStats after;  ///< Stats of the optimized mesh.
+};
+
+/**
+ * @brief CPU side mesh data in the final layout used for rendering.
+ */
+struct MeshData {
+	std::vector<Vertex3DNormTex> vertices;  ///< Vertex buffer contents.
+	std::vector<GLuint>          indices;   ///< Index buffer contents.
+	std::vector<Submesh>         submeshes; ///< Ranges of the index buffer.
+	std::vector<Material>        materials; ///< Materials used by submeshes.
+	Bounds                       bounds;    ///< Bounds of all the vertices.
+	MeshOptimizerStats
+	    optimizer_stats = {}; ///< Vertex cache efficiency, see optimizeMesh.
+};
+
+/**
+ * @brief Compute the axis aligned bounding box and bounding sphere of some
+ * vertices.
+ * @param vertices Vertices to bound.
+ * @return Bounds of the vertices, or all zero bounds if there are none.
+ */
+auto computeBounds(const std::vector<Vertex3DNormTex> &vertices) -> Bounds;
+
+/**
+ * @brief Compute the axis aligned bounding box and bounding sphere of the
+ * vertices used by a submesh.
+ * @param mesh Mesh the submesh is a part of.
+ * @param submesh Submesh to bound.
+ * @return Bounds of the submesh, or all zero bounds if it is empty.
+ */
+auto computeBounds(const MeshData &mesh, const Submesh &submesh) -> Bounds;
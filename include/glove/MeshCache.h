@@ -0,0 +1,104 @@
+#pragma once
+
+#include <glove/MappedFile.h>
+#include <glove/Mesh.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * @brief A binary cache of an imported mesh, stored next to the source file.
+ *
+ * # Format
+ * The cache file is a fixed header followed by the vertex array, the index
+ * array and the submesh table, all stored exactly as they are laid out in
+ * memory, and finally a table of materials. It is therefore only valid for the
+ * machine and build that wrote it, which the header guards against with a
+ * version and the vertex stride.
+ *
+ * # Validation
+ * The header records the size, modification time and hash of the source file.
+ * A cache whose size and modification time match is trusted as is, otherwise
+ * the source is hashed and compared before the cache is used. The material
+ * table is read when the cache is loaded, and a cache whose table does not
+ * read back cleanly is rejected like any other invalid cache.
+ *
+ * # Loading
+ * The cache is memory mapped, and the arrays are read directly out of the
+ * mapping, e.g. straight into a vertex buffer.
+ */
+class MeshCache {
+  public:
+	/**
+	 * @brief Bump whenever the file format or the meaning of its contents
+	 * change.
+	 */
+	static constexpr uint32_t version = 7;
+
+	/**
+	 * @brief Load the cache for a source file.
+	 * @param source_path Path to the file the mesh was imported from.
+	 * @return The cache, or nullptr if there is no valid cache for the source
+	 * file.
+	 */
+	static auto load(const std::string &source_path)
+	    -> std::unique_ptr<MeshCache>;
+
+	/**
+	 * @brief Write a cache for a source file.
+	 * Failing to write the cache is not an error, the mesh will simply be
+	 * imported again the next time.
+	 * @param source_path Path to the file the mesh was imported from.
+	 * @param mesh The imported mesh.
+	 * @return Was the cache written?
+	 */
+	static auto store(const std::string &source_path, const MeshData &mesh)
+	    -> bool;
+
+	/**
+	 * @brief Get the path of the cache belonging to a source file.
+	 * @param source_path Path to the file the mesh was imported from.
+	 * @return Path to the cache file.
+	 */
+	static auto cachePath(const std::string &source_path) -> std::string;
+
+	MeshCache(const MeshCache &other) = delete;
+
+	MeshCache(const MeshCache &&other) = delete;
+
+	auto operator=(const MeshCache &other) = delete;
+
+	auto operator=(const MeshCache &&other) = delete;
+
+	~MeshCache() = default;
+
+	[[nodiscard]] auto vertices() const -> const Vertex3DNormTex *;
+
+	[[nodiscard]] auto vertexCount() const -> size_t;
+
+	[[nodiscard]] auto indices() const -> const GLuint *;
+
+	[[nodiscard]] auto indexCount() const -> size_t;
+
+	[[nodiscard]] auto submeshes() const -> std::vector<Submesh>;
+
+	[[nodiscard]] auto materials() const -> const std::vector<Material> &;
+
+	[[nodiscard]] auto bounds() const -> Bounds;
+
+	[[nodiscard]] auto optimizerStats() const -> MeshOptimizerStats;
+
+	/**
+	 * @brief Copy the cached mesh out of the mapping.
+	 * @return The cached mesh.
+	 */
+	[[nodiscard]] auto toMeshData() const -> MeshData;
+
+  private:
+	MeshCache(std::unique_ptr<MappedFile> file,
+	          std::vector<Material>       materials);
+
+  private:
+	std::unique_ptr<MappedFile> m_file;      ///< Mapping of the cache file.
+	std::vector<Material>       m_materials; ///< Materials read on load.
+};
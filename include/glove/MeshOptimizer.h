@@ -0,0 +1,88 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <glove/Mesh.h>
+#include <glove/VertexFormats.h>
+#include <ostream>
+#include <vector>
+
+/**
+ * @brief Size of the post-transform vertex cache the optimizer targets.
+ * Real hardware does not have a simple FIFO cache any more, but ordering for a
+ * small one is still a good fit for all of it.
+ */
+constexpr size_t gVertexCacheSize = 16;
+
+/**
+ * @brief Simulate a FIFO vertex cache over some triangles.
+ * @param indices Triangle list.
+ * @param vertex_count Number of vertices the indices refer to.
+ * @param cache_size Number of entries in the simulated cache.
+ * @return The efficiency of the index buffer.
+ */
+auto analyzeVertexCache(const std::vector<GLuint> &indices, size_t vertex_count,
+                        size_t cache_size = gVertexCacheSize)
+    -> VertexCacheStats;
+
+/**
+ * @brief Merge vertices that are bitwise identical, and remove the vertices no
+ * triangle refers to.
+ * @param vertices Vertices to weld.
+ * @param indices Triangle list, remapped to the welded vertices.
+ */
+void weldVertices(std::vector<Vertex3DNormTex> &vertices,
+                  std::vector<GLuint> &        indices);
+
+/**
+ * @brief Reorder triangles for reuse in the post-transform vertex cache.
+ *
+ * Uses Tipsify, from "Fast Triangle Reordering for Vertex Locality and Reduced
+ * Overdraw" by Sander, Nehab and Barczak. Triangles are emitted as fans around
+ * one vertex at a time, and the next vertex is picked among the ones that are
+ * still in the cache.
+ *
+ * @param indices Triangle list to reorder.
+ * @param vertex_count Number of vertices the indices refer to.
+ * @param cache_size Number of entries in the targeted cache.
+ */
+void optimizeVertexCache(std::vector<GLuint> &indices, size_t vertex_count,
+                         size_t cache_size = gVertexCacheSize);
+
+/**
+ * @brief Reorder clusters of triangles so that the ones most likely to occlude
+ * the rest are drawn first.
+ *
+ * The triangles are split into clusters wherever the vertex cache starts over,
+ * so the vertex cache order within each cluster is kept. Clusters facing away
+ * from the center of the mesh are moved to the front.
+ *
+ * @param indices Triangle list, ideally from optimizeVertexCache.
+ * @param vertices Vertices the indices refer to.
+ * @param cache_size Number of entries in the targeted cache.
+ */
+void optimizeOverdraw(std::vector<GLuint> &                indices,
+                      const std::vector<Vertex3DNormTex> &vertices,
+                      size_t cache_size = gVertexCacheSize);
+
+/**
+ * @brief Reorder vertices in the order they are first used by the triangles,
+ * for locality in vertex fetching.
+ * @param vertices Vertices to reorder, unused ones are removed.
+ * @param indices Triangle list, remapped to the new vertex order.
+ */
+void optimizeVertexFetch(std::vector<Vertex3DNormTex> &vertices,
+                         std::vector<GLuint> &         indices);
+
+/**
+ * @brief Run all the optimizations on a mesh.
+ *
+ * Every submesh is optimized on its own, so submesh boundaries and materials
+ * are kept. Submeshes sharing a base vertex share their vertices as well.
+ * Levels of detail are dropped, as the index buffer is rebuilt.
+ *
+ * @param mesh Mesh to optimize, its optimizer_stats are set as well.
+ * @return Vertex cache efficiency before and after.
+ */
+auto optimizeMesh(MeshData &mesh) -> MeshOptimizerStats;
+
+std::ostream &operator<<(std::ostream &os, const MeshOptimizerStats &stats);
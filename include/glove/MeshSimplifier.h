@@ -0,0 +1,45 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <glove/Mesh.h>
+#include <glove/VertexFormats.h>
+#include <vector>
+
+/**
+ * @brief Result of simplifying a triangle list.
+ */
+struct Simplification {
+	std::vector<GLuint> indices; ///< Simplified triangle list.
+	float               error;   ///< Distance from the input surface.
+};
+
+/**
+ * @brief Simplify a triangle list by collapsing edges.
+ *
+ * Uses the quadric error metric from "Surface Simplification Using Quadric
+ * Error Metrics" by Garland and Heckbert, but only collapses a vertex into one
+ * of its neighbors, so the vertices are shared with the input. Vertices on
+ * open borders and attribute seams are never moved, and collapses that would
+ * flip a triangle are rejected.
+ *
+ * @param vertices Vertices the indices refer to.
+ * @param indices Triangle list to simplify.
+ * @param target_index_count Stop once there are this many indices or fewer.
+ * @param target_error Stop before moving the surface further than this.
+ * @return The simplified triangle list, and how far it is from the input.
+ */
+auto simplifyMesh(const std::vector<Vertex3DNormTex> &vertices,
+                  const std::vector<GLuint> &indices, size_t target_index_count,
+                  float target_error) -> Simplification;
+
+/**
+ * @brief Generate a chain of simplified levels of detail for every submesh.
+ *
+ * Every level has roughly half the triangles of the previous one, and the
+ * chain ends early once a submesh can not be simplified any further without
+ * changing its silhouette noticeably. The new triangles are appended to the
+ * index buffer, and ordered for the vertex cache.
+ *
+ * @param mesh Mesh to generate levels of detail for.
+ */
+void generateLods(MeshData &mesh);
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <glove/Frustum.h>
+#include <glove/Mesh.h>
 #include <glove/Texture.h>
 #include <glove/VertexBuffer.h>
 #include <glove/VertexFormats.h>
@@ -9,6 +11,11 @@
 /**
  * @brief A model representing one single mesh and accompanying texture maps.
  * Supports drawing and instanced drawing.
+ *
+ * The mesh is made up of submeshes, each with its own range of the index
+ * buffer, base vertex, material and bounds. They can be drawn all at once, or
+ * one at a time, e.g. to set material uniforms or skip the ones that are
+ * culled.
  * FIXME: Texture maps are not loaded automatically
  */
 class Model {
@@ -16,14 +23,166 @@ class Model {
 	/**
 	 * @brief Construct a new Model object from a model file.
 	 *
-	 * @param model_path Path to assimp compatible model file.
+	 * OBJ files are loaded with the built-in loader, and any other format with
+	 * assimp, if glove was built with it. The imported mesh is optimized for
+	 * the vertex cache, simplified into a chain of levels of detail and cached
+	 * in a binary file next to the model file. Later constructions load the
+	 * cache instead of importing the model again.
+	 * @see loadObj
+	 * @see optimizeMesh
+	 * @see generateLods
+	 * @see MeshCache
+	 *
+	 * @param model_path Path to an OBJ or assimp compatible model file.
 	 */
 	explicit Model(const std::string &model_path);
 
 	/**
-	 * @brief Draw the model.
+	 * @brief Construct a new Model object from a mesh in memory, e.g. one
+	 * loaded on another thread with loadMesh.
+	 * @param mesh The mesh to upload.
+	 */
+	explicit Model(const MeshData &mesh);
+
+	/**
+	 * @brief Load the mesh of a model file into memory, the same way the
+	 * constructor does, but without creating any OpenGL objects. Safe to call
+	 * from any thread.
+	 * @see ModelLoader
+	 * @param model_path Path to an OBJ or assimp compatible model file.
+	 * @return The mesh, ready to be uploaded.
+	 */
+	static auto loadMesh(const std::string &model_path) -> MeshData;
+
+	/**
+	 * @brief Draw the model, for every instance if instancing is enabled.
+	 * @param lod Level of detail to draw, 0 is full detail.
 	 */
-	void draw();
+	void draw(size_t lod = 0);
+
+	/**
+	 * @brief Draw the parts of the model that are inside a view frustum.
+	 * The bounds of the whole model are tested first, then the bounds of every
+	 * submesh if there is more than one.
+	 * @param frustum View frustum in world space.
+	 * @param transform Model to world space transform.
+	 * @param lod Level of detail to draw, 0 is full detail.
+	 * @return Was any part of the model drawn?
+	 */
+	auto drawVisible(const Frustum &frustum, const glm::mat4 &transform,
+	                 size_t lod = 0) -> bool;
+
+	/**
+	 * @brief Record drawing the parts of the model that are inside a view
+	 * frustum into a command list, see drawVisible. Does not touch OpenGL, so
+	 * it may be called from any thread.
+	 * @param list Command list to record into.
+	 * @param frustum View frustum in world space.
+	 * @param transform Model to world space transform.
+	 * @param lod Level of detail to draw, 0 is full detail.
+	 * @return Was any part of the model recorded?
+	 */
+	auto recordVisible(class CommandList &list, const Frustum &frustum,
+	                   const glm::mat4 &transform, size_t lod = 0) const
+	    -> bool;
+
+	/**
+	 * @brief Draw one submesh of the model, for every instance if instancing
+	 * is enabled.
+	 * @param index Index of the submesh, see getSubmeshes.
+	 * @param lod Level of detail to draw, 0 is full detail.
+	 */
+	void drawSubmesh(size_t index, size_t lod = 0);
+
+	/**
+	 * @brief Draw a range of the instances of the model.
+	 * @note Instancing MUST be enabled.
+	 * @param lod Level of detail to draw, 0 is full detail.
+	 * @param first_instance First instance to draw.
+	 * @param instance_count Number of instances to draw.
+	 */
+	void drawInstances(size_t lod, GLuint first_instance,
+	                   GLuint instance_count);
+
+	/**
+	 * @brief Draw with parameters read from an indirect draw buffer.
+	 * @see indirectCommands
+	 * @param commands Buffer of DrawElementsIndirectCommand.
+	 * @param first_command First command in the buffer to draw.
+	 * @param command_count Number of commands to draw.
+	 */
+	void drawIndirect(const Buffer &commands, size_t first_command,
+	                  size_t command_count);
+
+	/**
+	 * @brief Build the indirect draw commands for one level of detail, one per
+	 * submesh. The instance counts start out as zero, to be filled in later,
+	 * e.g. by a compute shader.
+	 * @param lod Level of detail to draw, 0 is full detail.
+	 * @param base_instance First instance the commands draw.
+	 * @return One command per submesh.
+	 */
+	[[nodiscard]] auto indirectCommands(size_t lod, GLuint base_instance) const
+	    -> std::vector<DrawElementsIndirectCommand>;
+
+	/**
+	 * @brief Pick the coarsest level of detail that looks the same as full
+	 * detail on screen.
+	 * @param pixels_per_unit How many pixels one model space unit covers on
+	 * screen.
+	 * @param max_error How far off the surface may be on screen, in pixels.
+	 * @return Level of detail to draw.
+	 */
+	[[nodiscard]] auto selectLod(float pixels_per_unit,
+	                             float max_error = 1.0f) const -> size_t;
+
+	/**
+	 * @brief Get the number of levels of detail, including full detail.
+	 * @return Number of levels of detail.
+	 */
+	[[nodiscard]] auto getLodCount() const -> size_t {
+		return m_lod_errors.size();
+	}
+
+	/**
+	 * @brief Get the error of every level of detail, in model space units.
+	 * @see selectLod
+	 * @return One error per level of detail, starting with full detail.
+	 */
+	[[nodiscard]] auto getLodErrors() const -> const std::vector<float> & {
+		return m_lod_errors;
+	}
+
+	/**
+	 * @brief Get the bounds of the model in model space.
+	 * @return Axis aligned bounding box.
+	 */
+	[[nodiscard]] auto getBounds() const -> const Bounds & { return m_bounds; }
+
+	/**
+	 * @brief Get how much optimizing the mesh improved its vertex cache use.
+	 * @return Vertex cache efficiency before and after, all zero for meshes
+	 * that were not optimized.
+	 */
+	[[nodiscard]] auto getOptimizerStats() const -> const MeshOptimizerStats & {
+		return m_stats;
+	}
+
+	/**
+	 * @brief Get the submeshes of the model.
+	 * @return The submeshes, in the order they are drawn.
+	 */
+	[[nodiscard]] auto getSubmeshes() const -> const std::vector<Submesh> & {
+		return m_submeshes;
+	}
+
+	/**
+	 * @brief Get the material of a submesh.
+	 * @param submesh One of the model's submeshes.
+	 * @return The submesh's material.
+	 */
+	[[nodiscard]] auto getMaterial(const Submesh &submesh) const
+	    -> const Material &;
 
 	/**
 	 * @brief Associate instancing information with the model.
@@ -42,8 +201,29 @@ class Model {
 	template <typename InstanceFormat>
 	void uploadInstanceData(const std::vector<InstanceFormat> &instance_data);
 
+	/**
+	 * @brief Get the buffer with per instance data.
+	 * @note Instancing MUST be enabled.
+	 * @return The buffer name.
+	 */
+	[[nodiscard]] auto getInstanceBuffer() const -> GLuint {
+		return m_vbo->getInstanceBuffer();
+	}
+
+  private:
+	/**
+	 * @brief Store the submeshes, and find the error of every level of detail.
+	 * @param submeshes Submeshes of the mesh.
+	 */
+	void setSubmeshes(std::vector<Submesh> submeshes);
+
   private:
 	std::unique_ptr<VertexBuffer<Vertex3DNormTex>>
-	                         m_vbo;     ///< Internal VBO containing the mesh.
-	std::unique_ptr<Texture> m_texture; ///< Internal Texture.
+	                         m_vbo;        ///< Internal VBO containing the mesh.
+	std::unique_ptr<Texture> m_texture;    ///< Internal Texture.
+	Bounds                   m_bounds;     ///< Bounds of the mesh.
+	std::vector<Submesh>     m_submeshes;  ///< Ranges of the index buffer.
+	std::vector<Material>    m_materials;  ///< Materials used by submeshes.
+	std::vector<float>       m_lod_errors; ///< Error of every level of detail.
+	MeshOptimizerStats       m_stats;      ///< Vertex cache efficiency.
 };
@@ -0,0 +1,129 @@
+#pragma once
+
+#include <chrono>
+#include <exception>
+#include <future>
+#include <glove/Model.h>
+#include <glove/ThreadPool.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * @brief A model that is loaded in the background.
+ * Until the model is uploaded, a placeholder model is drawn in its place, or
+ * nothing if there is no placeholder.
+ * @see ModelLoader
+ */
+class AsyncModel {
+  public:
+	/**
+	 * @brief Construct a handle to a model being loaded.
+	 * @param mesh Future with the mesh of the model.
+	 * @param placeholder Model to draw until the model is ready, may be null.
+	 */
+	AsyncModel(std::future<MeshData> mesh, std::shared_ptr<Model> placeholder);
+
+	AsyncModel(const AsyncModel &other) = delete;
+
+	AsyncModel(const AsyncModel &&other) = delete;
+
+	auto operator=(const AsyncModel &other) = delete;
+
+	auto operator=(const AsyncModel &&other) = delete;
+
+	/**
+	 * @brief Upload the model, if the mesh has been loaded.
+	 * @note MUST be called on the thread with the OpenGL context.
+	 * @throw Whatever loading the mesh threw, on this and every later call.
+	 * @return Is the model ready?
+	 */
+	auto finalize() -> bool;
+
+	/**
+	 * @brief Is the model loaded and uploaded?
+	 * @return Is the model ready?
+	 */
+	[[nodiscard]] auto ready() const -> bool { return m_model != nullptr; }
+
+	/**
+	 * @brief Get the model to draw right now.
+	 * @return The model if it is ready, else the placeholder, which may be
+	 * null.
+	 */
+	[[nodiscard]] auto get() const -> Model * {
+		return m_model ? m_model.get() : m_placeholder.get();
+	}
+
+	/**
+	 * @brief Draw the model, or the placeholder if it is not ready yet.
+	 * @param lod Level of detail to draw, 0 is full detail.
+	 */
+	void draw(size_t lod = 0);
+
+  private:
+	std::future<MeshData>  m_mesh;        ///< Mesh being loaded.
+	std::unique_ptr<Model> m_model;       ///< The model, once uploaded.
+	std::shared_ptr<Model> m_placeholder; ///< Drawn until the model is ready.
+	std::exception_ptr     m_error;       ///< Why the model failed, if it did.
+};
+
+/**
+ * @brief Loads models on worker threads, and uploads them on the main thread
+ * within a time budget per frame.
+ *
+ * Importing, optimizing and simplifying a model can take hundreds of
+ * milliseconds. That all happens on a worker thread, so that only creating the
+ * OpenGL buffers, which needs the context, is left for the main thread.
+ */
+class ModelLoader {
+  public:
+	/**
+	 * @brief Construct a model loader.
+	 * @param thread_count Number of worker threads.
+	 */
+	explicit ModelLoader(size_t thread_count = 1);
+
+	ModelLoader(const ModelLoader &other) = delete;
+
+	ModelLoader(const ModelLoader &&other) = delete;
+
+	auto operator=(const ModelLoader &other) = delete;
+
+	auto operator=(const ModelLoader &&other) = delete;
+
+	/**
+	 * @brief Start loading a model in the background.
+	 * @see Model::loadMesh
+	 * @param model_path Path to an OBJ or assimp compatible model file.
+	 * @param placeholder Model to draw until the model is ready, may be null.
+	 * @return Handle to the model.
+	 */
+	auto load(const std::string &    model_path,
+	          std::shared_ptr<Model> placeholder = nullptr)
+	    -> std::shared_ptr<AsyncModel>;
+
+	/**
+	 * @brief Upload the models that have finished loading, until the budget
+	 * runs out. Models are uploaded whole, so one large model can overrun the
+	 * budget, but no more models are uploaded after that.
+	 * @note MUST be called on the thread with the OpenGL context, e.g. once
+	 * per frame.
+	 * @throw Whatever loading a model threw. The failed model is no longer
+	 * pending, and the rest are uploaded by the next calls.
+	 * @param budget Time to spend on uploads.
+	 * @return Number of models still loading.
+	 */
+	auto finalize(std::chrono::microseconds budget) -> size_t;
+
+	/**
+	 * @brief Get the number of models that are not uploaded yet.
+	 * @return Number of models still loading.
+	 */
+	[[nodiscard]] auto pending() const -> size_t { return m_pending.size(); }
+
+  private:
+	ThreadPool m_pool; ///< Worker threads loading meshes.
+	std::vector<std::shared_ptr<AsyncModel>>
+	    m_pending; ///< Models not uploaded yet, in the order they were loaded.
+};
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <glove/Mesh.h>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Load a Wavefront OBJ file, and the MTL files it references.
+ *
+ * # Parsing
+ * The file is memory mapped and split into chunks of whole lines, which are
+ * parsed in parallel. Only the parts of the format used for static meshes are
+ * supported: "v", "vt", "vn", "f", "usemtl" and "mtllib". Everything else is
+ * ignored.
+ *
+ * # Output
+ * Faces are triangulated as fans, and every unique combination of position,
+ * texture coordinate and normal becomes one vertex. A new submesh is started
+ * every time the material changes. Missing normals are generated by averaging
+ * the normals of the faces sharing a vertex.
+ *
+ * @throws std::runtime_error If the file can not be opened.
+ * @param path Path to the OBJ file.
+ * @return The loaded mesh.
+ */
+auto loadObj(const std::string &path) -> MeshData;
+
+/**
+ * @brief Load the materials in a Wavefront MTL file.
+ *
+ * Only the diffuse color ("Kd"), opacity ("d" or "Tr") and diffuse map
+ * ("map_Kd") are read.
+ *
+ * @param path Path to the MTL file.
+ * @return The materials in the file, or none if the file could not be opened.
+ */
+auto loadMtl(const std::string &path) -> std::vector<Material>;
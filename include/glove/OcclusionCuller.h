@@ -0,0 +1,202 @@
+#pragma once
+
+#include <array>
+#include <cmath>
+#include <glm/glm.hpp>
+#include <glove/Mesh.h>
+#include <glove/ThreadPool.h>
+#include <vector>
+
+/**
+ * @brief Default resolution of the occlusion depth buffer. The width must be a
+ * multiple of 4.
+ */
+const glm::ivec2 gOcclusionResolution(256, 144);
+
+/**
+ * @brief Culls objects hidden behind occluders, on the CPU.
+ *
+ * The occluders, e.g. the walls of a level, are rasterized into a low
+ * resolution depth buffer four pixels at a time with SSE, split into bands of
+ * rows across threads. Every triangle is written at the depth of its farthest
+ * vertex, so that the buffer never holds anything closer than the occluders
+ * really are. Objects are then tested by the screen rectangle and nearest
+ * depth of their bounding box, and are only culled if every pixel of the
+ * rectangle is in front of them.
+ *
+ * Occluders are rasterized conservatively, only writing pixels they cover
+ * entirely, so an object peeking out past them is never culled. A pixel may
+ * also be covered by two occluders sharing an edge, like the two triangles of
+ * a wall quad, in which case it gets the depth of the farther one. Occluders
+ * less than a pixel of the buffer wide hide nothing at all.
+ *
+ * # Usage
+ * ```
+ * culler.setOccluders(wall_triangles);
+ * // Every frame
+ * culler.render(projection * view);
+ * if (culler.isVisible(bounds, transform)) {
+ *     // Draw
+ * }
+ * ```
+ */
+class OcclusionCuller {
+  public:
+	/**
+	 * @brief Allocate the depth buffer and start the rasterizing threads.
+	 * @param resolution Resolution of the depth buffer, the width a multiple
+	 * of 4.
+	 * @param thread_count Number of threads rasterizing.
+	 */
+	explicit OcclusionCuller(glm::ivec2 resolution   = gOcclusionResolution,
+	                         size_t     thread_count = 2);
+
+	OcclusionCuller(const OcclusionCuller &other) = delete;
+
+	OcclusionCuller(const OcclusionCuller &&other) = delete;
+
+	auto operator=(const OcclusionCuller &other) = delete;
+
+	auto operator=(const OcclusionCuller &&other) = delete;
+
+	/**
+	 * @brief Set the occluders. Only triangles sharing the exact corners of
+	 * an edge cover the pixels straddling it together.
+	 * @param triangles Triangle list in world space, three vertices per
+	 * triangle.
+	 */
+	void setOccluders(std::vector<glm::vec3> triangles);
+
+	/**
+	 * @brief Rasterize the occluders as seen through a camera.
+	 * @param view_projection Projection matrix multiplied with the view matrix.
+	 */
+	void render(const glm::mat4 &view_projection);
+
+	/**
+	 * @brief Test if an axis aligned box is at least partially visible past
+	 * the occluders.
+	 * @param min Minimum corner of the box in world space.
+	 * @param max Maximum corner of the box in world space.
+	 * @return Is the box visible?
+	 */
+	[[nodiscard]] auto isVisible(const glm::vec3 &min,
+	                             const glm::vec3 &max) const -> bool;
+
+	/**
+	 * @brief Test if transformed bounds are at least partially visible past
+	 * the occluders.
+	 * @param bounds Bounds in model space.
+	 * @param transform Model to world space transform.
+	 * @return Are the bounds visible?
+	 */
+	[[nodiscard]] auto isVisible(const Bounds &   bounds,
+	                             const glm::mat4 &transform) const -> bool;
+
+	/**
+	 * @brief Get the depth buffer, the distance along the view direction to
+	 * the nearest occluder of every pixel, bottom row first.
+	 * @return The depth buffer.
+	 */
+	[[nodiscard]] auto getDepth() const -> const std::vector<float> & {
+		return m_depth;
+	}
+
+  private:
+	/**
+	 * @brief Edge function a * x + b * y + c of a line in pixels, positive on
+	 * the inside.
+	 */
+	struct EdgeFunction {
+		float a, b, c; ///< Coefficients.
+
+		/**
+		 * @brief The line through two points, positive on its left.
+		 */
+		static auto between(glm::vec2 from, glm::vec2 to) -> EdgeFunction {
+			const auto a = from.y - to.y;
+			const auto b = to.x - from.x;
+			return {a, b, -(a * from.x + b * from.y)};
+		}
+
+		/**
+		 * @brief Pull the line in by half a pixel, so that it is only positive
+		 * at the centers of pixels entirely inside.
+		 */
+		[[nodiscard]] auto pulledIn() const -> EdgeFunction {
+			return {a, b, c - 0.5f * (std::abs(a) + std::abs(b))};
+		}
+
+		/**
+		 * @brief Evaluate the line at a point.
+		 */
+		auto operator()(float x, float y) const -> float {
+			return a * x + b * y + c;
+		}
+	};
+
+	/**
+	 * @brief An edge shared with a neighboring occluder, pixels across it are
+	 * covered if they are inside the neighbor.
+	 */
+	struct SharedEdge {
+		EdgeFunction inside;      ///< Pixels entirely on this side.
+		EdgeFunction neighbor[2]; ///< Other edges of the neighbor, pulled in.
+	};
+
+	/**
+	 * @brief An occluder after clipping and projection, in pixels.
+	 */
+	struct ScreenPolygon {
+		glm::vec2    lo, hi;       ///< Bounds in pixels.
+		float        depth;        ///< Depth of the farthest corner.
+		int          edge_count;   ///< Number of edges.
+		EdgeFunction edges[4];     ///< Edges, pulled in unless shared.
+		int          shared_count; ///< Number of shared edges.
+		SharedEdge   shared[3];    ///< Edges shared with neighbors.
+	};
+
+	/**
+	 * @brief Clip an occluder against the near plane and project it.
+	 * @param triangle Index of the occluder triangle.
+	 */
+	void addTriangle(size_t triangle);
+
+	/**
+	 * @brief Project a neighbor of an occluder across one of its edges.
+	 * @param triangle Index of the occluder triangle.
+	 * @param edge Edge of the occluder, lying on the line "line".
+	 * @param line Edge function of the edge, positive inside the occluder.
+	 * @param shared Edge to fill in.
+	 * @param depth Depth of the neighbor's farthest corner.
+	 * @return Does the neighbor cover the other side of the edge?
+	 */
+	auto addNeighbor(size_t triangle, int edge, const EdgeFunction &line,
+	                 SharedEdge &shared, float &depth) const -> bool;
+
+	/**
+	 * @brief Test if the box spanned by eight corners is visible.
+	 * @param corners Corners in world space.
+	 * @return Is the box visible?
+	 */
+	[[nodiscard]] auto isVisible(const glm::vec3 (&corners)[8]) const -> bool;
+
+	/**
+	 * @brief Rasterize the occluders overlapping a band of rows.
+	 * @param first_row First row of the band.
+	 * @param end_row One past the last row of the band.
+	 */
+	void rasterize(int first_row, int end_row);
+
+  private:
+	glm::ivec2             m_resolution; ///< Size of the depth buffer.
+	std::vector<float>     m_depth;      ///< Depth of the nearest occluders.
+	std::vector<glm::vec3> m_occluders;  ///< Occluder triangles.
+	std::vector<std::array<size_t, 3>>
+	    m_neighbors; ///< Occluder across every edge of every occluder.
+	std::vector<glm::vec4>     m_clip;     ///< Occluder corners in clip space.
+	std::vector<ScreenPolygon> m_polygons; ///< Projected occluders.
+	glm::mat4  m_view_projection; ///< Camera of the depth buffer.
+	ThreadPool m_pool;            ///< Threads rasterizing the bands.
+	size_t     m_band_count;      ///< Number of bands to split rows into.
+};
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <glove/ShaderProgram.h>
+#include <vector>
+
+/**
+ * @brief The fields of a sort key, from most to least significant.
+ */
+struct SortKeyFields {
+	uint32_t pass;     ///< Render pass, 4 bits.
+	uint32_t layer;    ///< Layer within the pass, 4 bits.
+	uint32_t program;  ///< Id of the shader program, 10 bits.
+	uint32_t material; ///< Id of the material, 12 bits.
+	uint32_t mesh;     ///< Id of the mesh, 10 bits.
+	float    depth;    ///< Depth in [0, 1], quantized to 24 bits.
+	bool     back_to_front = false; ///< Sort far to near, for transparency.
+};
+
+/**
+ * @brief Sets the state shared by many draws, e.g. material uniforms and
+ * textures, or issues a draw. Gets the program in use.
+ */
+using RenderCallback = std::function<void(ShaderProgram &)>;
+
+/**
+ * @brief One draw submitted to a RenderQueue.
+ */
+struct RenderItem {
+	uint64_t       key;     ///< Sort key, see RenderQueue::makeKey.
+	ShaderProgram *program; ///< Program to draw with.
+	const RenderCallback
+	    *material; ///< Binds the material, or nullptr. Must outlive the flush.
+	RenderCallback draw; ///< Sets the per draw uniforms and draws.
+};
+
+/**
+ * @brief A sort key and the index of the item it belongs to.
+ */
+struct SortEntry {
+	uint64_t key;   ///< Sort key.
+	uint32_t index; ///< Index of the item.
+};
+
+/**
+ * @brief Collects the draws of a frame, and submits them sorted by a packed
+ * 64-bit key.
+ *
+ * The key orders draws by pass, layer, program, material, mesh and depth, in
+ * that order. Sorting by it groups the draws that share state, so that only
+ * the state that differs between neighbours is changed, and draws opaque
+ * geometry front to back within a group, so that early depth testing rejects
+ * more fragments.
+ *
+ * The keys are sorted with a least significant digit radix sort, which does
+ * not compare keys and skips the digits every key has in common.
+ *
+ * # Usage
+ * ```
+ * queue.submit({RenderQueue::makeKey({0, 0, program_id, material_id, mesh_id,
+ *                                     depth}),
+ *               &program, &material, [&](ShaderProgram &shader) {
+ *                   shader.setUniform("u_transform", transform);
+ *                   mesh.draw();
+ *               }});
+ * queue.flush();
+ * ```
+ */
+class RenderQueue {
+  public:
+	/**
+	 * @brief Pack the fields of a sort key. Fields are masked to their width.
+	 * @param fields The fields.
+	 * @return The sort key.
+	 */
+	static auto makeKey(const SortKeyFields &fields) -> uint64_t;
+
+	/**
+	 * @brief Sort entries by key, keeping the order of equal keys.
+	 * @param entries The entries to sort.
+	 * @param scratch Buffer to sort through, resized to fit. Reuse it between
+	 * sorts to avoid allocating.
+	 */
+	static void radixSort(std::vector<SortEntry> &entries,
+	                      std::vector<SortEntry> &scratch);
+
+	/**
+	 * @brief Add a draw to the queue.
+	 * @param item The draw.
+	 */
+	void submit(RenderItem item);
+
+	/**
+	 * @brief Sort and issue all the queued draws, then empty the queue.
+	 * Programs are only used, and materials only bound, when they differ from
+	 * the previous draw's.
+	 */
+	void flush();
+
+	/**
+	 * @brief Get the number of queued draws.
+	 * @return Number of draws.
+	 */
+	[[nodiscard]] auto size() const -> size_t { return m_items.size(); }
+
+  private:
+	std::vector<RenderItem> m_items;   ///< Queued draws.
+	std::vector<SortEntry>  m_entries; ///< Keys of the draws, for sorting.
+	std::vector<SortEntry>  m_scratch; ///< Second buffer of the radix sort.
+};
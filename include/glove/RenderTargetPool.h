@@ -0,0 +1,148 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+#include <glove/Framebuffer.h>
+#include <memory>
+#include <vector>
+
+/**
+ * @brief Description of a render target, what the pool matches targets by.
+ */
+struct RenderTargetDesc {
+	AttachmentType type;       ///< Color, depth or depth stencil.
+	glm::ivec2     dimensions; ///< Width and height in pixels.
+	GLsizei        samples;    ///< Samples per pixel, 1 for no multisampling.
+
+	auto operator==(const RenderTargetDesc &other) const -> bool {
+		return type == other.type && dimensions == other.dimensions &&
+		       samples == other.samples;
+	}
+};
+
+/**
+ * @brief A texture leased from a RenderTargetPool.
+ * The texture goes back to the pool when the lease is destroyed, so it must
+ * not be used after that.
+ */
+class RenderTarget {
+  public:
+	/**
+	 * @brief Lease a texture from a pool.
+	 * @param pool The pool the texture goes back to.
+	 * @param desc Description of the texture.
+	 * @param texture The texture.
+	 */
+	RenderTarget(class RenderTargetPool &pool, const RenderTargetDesc &desc,
+	             GLuint texture);
+
+	RenderTarget(const RenderTarget &other) = delete;
+
+	RenderTarget(const RenderTarget &&other) = delete;
+
+	auto operator=(const RenderTarget &other) = delete;
+
+	auto operator=(const RenderTarget &&other) = delete;
+
+	/**
+	 * @brief Return the texture to the pool.
+	 */
+	~RenderTarget();
+
+	/**
+	 * @brief Bind the texture to a texture slot, e.g. to sample a shadow map.
+	 * @param slot Texture slot.
+	 */
+	void bindToSlot(GLuint slot) const;
+
+	/**
+	 * @brief Get the description of the texture.
+	 * @return The description.
+	 */
+	[[nodiscard]] auto getDesc() const -> const RenderTargetDesc & {
+		return m_desc;
+	}
+
+	/**
+	 * @brief Get the texture.
+	 * @return The texture name.
+	 */
+	[[nodiscard]] auto getTexture() const -> GLuint { return m_texture; }
+
+  private:
+	class RenderTargetPool &m_pool;    ///< Pool the texture goes back to.
+	RenderTargetDesc        m_desc;    ///< Description of the texture.
+	GLuint                  m_texture; ///< The leased texture.
+};
+
+/**
+ * @brief A pool of textures to render to, handed out by description.
+ *
+ * Render passes lease the targets they need for as long as they need them,
+ * and targets with the same description are reused by later passes and
+ * frames. Targets nobody has leased for a few frames are freed, so the old
+ * sizes go away some frames after a resize, while resizing back and forth
+ * reuses what is still in the pool.
+ */
+class RenderTargetPool {
+  public:
+	RenderTargetPool() = default;
+
+	RenderTargetPool(const RenderTargetPool &other) = delete;
+
+	RenderTargetPool(const RenderTargetPool &&other) = delete;
+
+	auto operator=(const RenderTargetPool &other) = delete;
+
+	auto operator=(const RenderTargetPool &&other) = delete;
+
+	/**
+	 * @brief Free all the targets.
+	 * @note All leases MUST be destroyed before the pool.
+	 */
+	~RenderTargetPool();
+
+	/**
+	 * @brief Lease a target matching a description, reusing a free one if
+	 * there is one.
+	 * @param desc Description of the target.
+	 * @return Lease of the target.
+	 */
+	auto acquire(const RenderTargetDesc &desc) -> std::unique_ptr<RenderTarget>;
+
+	/**
+	 * @brief Mark the end of a frame, freeing targets that have not been
+	 * leased for a while.
+	 */
+	void endFrame();
+
+	/**
+	 * @brief Get the number of targets in the pool, leased or free.
+	 * @return Number of targets.
+	 */
+	[[nodiscard]] auto size() const -> size_t {
+		return m_free.size() + m_leased;
+	}
+
+	/**
+	 * @brief Put a leased texture back into the pool. Called by the lease when
+	 * it is destroyed.
+	 * @param desc Description of the texture.
+	 * @param texture The texture.
+	 */
+	void release(const RenderTargetDesc &desc, GLuint texture);
+
+  private:
+	/**
+	 * @brief A target that is not leased.
+	 */
+	struct FreeTarget {
+		RenderTargetDesc desc;      ///< Description of the texture.
+		GLuint           texture;   ///< The texture.
+		uint64_t         last_used; ///< Frame it was last released.
+	};
+
+	std::vector<FreeTarget> m_free;      ///< Targets ready to be leased.
+	size_t                  m_leased{0}; ///< Number of leased targets.
+	uint64_t                m_frame{0};  ///< Number of frames ended.
+};
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <optional>
+
+/**
+ * @brief A fixed-capacity queue between one producer and one consumer, that
+ * neither locks nor allocates.
+ *
+ * The producer only writes the head and the consumer only writes the tail,
+ * the cursor of the next element to read. Each reads the other's with acquire
+ * ordering, so an element is fully written before the consumer sees it, and
+ * fully read before the producer overwrites it.
+ *
+ * # Usage
+ * ```
+ * auto ring = RingBuffer<Input, 256>();
+ * ring.push(input); // On the producer
+ * while (const auto input = ring.pop()) // On the consumer
+ *     // Use the input
+ * ```
+ */
+template <typename T, size_t Capacity>
+class RingBuffer {
+	static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0,
+	              "The capacity must be a power of two");
+
+  public:
+	RingBuffer() = default;
+
+	RingBuffer(const RingBuffer &other) = delete;
+
+	RingBuffer(const RingBuffer &&other) = delete;
+
+	auto operator=(const RingBuffer &other) = delete;
+
+	auto operator=(const RingBuffer &&other) = delete;
+
+	/**
+	 * @brief Add an element. Only called by the producer.
+	 * @param value The element.
+	 * @return False if the ring is full, and the element was dropped.
+	 */
+	auto push(const T &value) -> bool {
+		const auto head = m_head.load(std::memory_order_relaxed);
+		if (head - m_tail.load(std::memory_order_acquire) == Capacity)
+			return false;
+
+		m_elements[head & (Capacity - 1)] = value;
+		m_head.store(head + 1, std::memory_order_release);
+
+		return true;
+	}
+
+	/**
+	 * @brief Take the oldest element. Only called by the consumer.
+	 * @return The element, or nothing if the ring is empty.
+	 */
+	auto pop() -> std::optional<T> {
+		const auto tail = m_tail.load(std::memory_order_relaxed);
+		if (tail == m_head.load(std::memory_order_acquire))
+			return std::nullopt;
+
+		auto value = m_elements[tail & (Capacity - 1)];
+		m_tail.store(tail + 1, std::memory_order_release);
+
+		return value;
+	}
+
+	/**
+	 * @brief Is the ring empty? Exact only on the consumer.
+	 * @return Is there nothing to pop?
+	 */
+	[[nodiscard]] auto empty() const -> bool {
+		return m_tail.load(std::memory_order_relaxed) ==
+		       m_head.load(std::memory_order_acquire);
+	}
+
+  private:
+	// The cursors are on separate cache lines, so the producer and consumer
+	// do not invalidate each other's line on every push and pop
+	std::array<T, Capacity>         m_elements{}; ///< Indexed modulo.
+	alignas(64) std::atomic<size_t> m_head{0};    ///< Elements pushed.
+	alignas(64) std::atomic<size_t> m_tail{0};    ///< Elements popped.
+};
@@ -31,10 +31,11 @@ class ShaderProgram {
 	 * Construct a shader program from multiple shader stages.
 	 *
 	 * The shaders stage is determent based on the file extension.
-	 * Eg. .vert for vertex shader and .geom for geometry shader.
+	 * Eg. .vert for vertex shader and .geom for geometry shader. A compute
+	 * program is made from a single .comp shader.
 	 *
 	 * @note Does not handle being passed multiple shaders for the same stage.
-	 * @note Does not handle tessellation or compute shaders
+	 * @note Does not handle tessellation shaders
 	 *
 	 * @param paths An array of paths to the shader source code.
 	 */
@@ -59,6 +60,17 @@ class ShaderProgram {
 	 */
 	void use() const;
 
+	/**
+	 * Use the program and dispatch compute work groups.
+	 * @note The program MUST be a compute program.
+	 *
+	 * @param groups_x Number of work groups in x.
+	 * @param groups_y Number of work groups in y.
+	 * @param groups_z Number of work groups in z.
+	 */
+	void dispatch(GLuint groups_x, GLuint groups_y = 1,
+	              GLuint groups_z = 1) const;
+
 	void setUniform(const std::string &name, const unsigned int x);
 
 	void setUniform(const std::string &name, const float x);
@@ -79,7 +91,27 @@ class ShaderProgram {
 
 	void setUniform(const std::string &name, const DirectionalLight &v);
 
+	/**
+	 * Set a whole uniform array, starting at the first element. Nothing is
+	 * set for no values, or an array the compiler optimized out.
+	 * @param name Name of the array, without any brackets.
+	 * @param v Values of the elements.
+	 */
+	void setUniform(const std::string &name, const std::vector<float> &v);
+
+	void setUniform(const std::string &name, const std::vector<glm::vec4> &v);
+
+	void setUniform(const std::string &name, const std::vector<glm::mat4> &v);
+
   private:
+	/**
+	 * Find a uniform array by the name of its first element.
+	 * @param name Name of the array, without any brackets.
+	 * @return The array, or nullptr if it is not in the program.
+	 */
+	[[nodiscard]] auto findArray(const std::string &name) const
+	    -> const UniformSpec *;
+
 	GLuint                                       m_program;
 	std::unordered_map<std::string, UniformSpec> m_uniforms;
 };
@@ -0,0 +1,218 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+#include <map>
+#include <optional>
+#include <utility>
+
+/**
+ * @brief Number of GL calls the state cache has issued and skipped.
+ */
+struct StateCacheStats {
+	size_t issued;  ///< Calls that changed state and reached the driver.
+	size_t skipped; ///< Calls that would not have changed anything.
+};
+
+/**
+ * @brief Remembers the OpenGL state glove has set, and drops the calls that
+ * would not change it.
+ *
+ * Tracks the bound program, vertex array, framebuffers, viewport, textures
+ * per texture unit, the enabled capabilities, and the blend, depth, color and
+ * cull state. Anything that has not been set through the cache since the last
+ * "invalidate" is unknown, and always set.
+ *
+ * NOTE: Everything in glove changes this state through the cache. Changing it
+ * behind the cache's back makes it skip calls that it should not, so raw GL
+ * calls must be followed by "invalidate".
+ *
+ * There is only one OpenGL context, so there is only one cache, see "get".
+ *
+ * # Usage
+ * ```
+ * auto &state = StateCache::get();
+ * state.useProgram(program);
+ * state.setEnabled(GL_DEPTH_TEST, true);
+ * ```
+ */
+class StateCache {
+  public:
+	StateCache(const StateCache &other) = delete;
+
+	StateCache(const StateCache &&other) = delete;
+
+	auto operator=(const StateCache &other) = delete;
+
+	auto operator=(const StateCache &&other) = delete;
+
+	/**
+	 * @brief Get the cache of the current context.
+	 * @return The cache.
+	 */
+	static auto get() -> StateCache &;
+
+	/**
+	 * @brief Forget all the state, e.g. when a new context is made current.
+	 */
+	void invalidate();
+
+	/**
+	 * @brief Start counting a new frame.
+	 * The counts of the frame that ended are kept for "lastFrame".
+	 */
+	void endFrame();
+
+	/**
+	 * @brief Get the counts of the last whole frame.
+	 * @return Issued and skipped calls.
+	 */
+	[[nodiscard]] auto lastFrame() const -> StateCacheStats {
+		return m_last_frame;
+	}
+
+	/**
+	 * @brief Use a shader program, see glUseProgram.
+	 * @param program The program.
+	 */
+	void useProgram(GLuint program);
+
+	/**
+	 * @brief Bind a vertex array, see glBindVertexArray.
+	 * @param vao The vertex array.
+	 */
+	void bindVertexArray(GLuint vao);
+
+	/**
+	 * @brief Bind a framebuffer, see glBindFramebuffer.
+	 * @param target GL_FRAMEBUFFER, GL_READ_FRAMEBUFFER or
+	 * GL_DRAW_FRAMEBUFFER.
+	 * @param fbo The framebuffer.
+	 */
+	void bindFramebuffer(GLenum target, GLuint fbo);
+
+	/**
+	 * @brief Set the viewport, see glViewport.
+	 * @param viewport Position and size in pixels.
+	 */
+	void setViewport(glm::ivec4 viewport);
+
+	/**
+	 * @brief Bind a texture to a texture unit, for sampling, see
+	 * glBindTextureUnit.
+	 * @param unit Texture unit, or slot.
+	 * @param target Target of the texture, e.g. GL_TEXTURE_2D.
+	 * @param texture The texture.
+	 */
+	void bindTexture(GLuint unit, GLenum target, GLuint texture);
+
+	/**
+	 * @brief Bind a texture to the active texture unit, for creating or
+	 * editing it.
+	 * @param target Target of the texture, e.g. GL_TEXTURE_2D.
+	 * @param texture The texture.
+	 */
+	void bindTexture(GLenum target, GLuint texture);
+
+	/**
+	 * @brief Enable or disable a capability, see glEnable.
+	 * @param capability The capability, e.g. GL_DEPTH_TEST.
+	 * @param enabled Should it be enabled?
+	 */
+	void setEnabled(GLenum capability, bool enabled);
+
+	/**
+	 * @brief Set the blend function, see glBlendFunc.
+	 * @param source Source factor.
+	 * @param destination Destination factor.
+	 */
+	void setBlendFunc(GLenum source, GLenum destination);
+
+	/**
+	 * @brief Set the depth comparison, see glDepthFunc.
+	 * @param func The comparison.
+	 */
+	void setDepthFunc(GLenum func);
+
+	/**
+	 * @brief Enable or disable writing depth, see glDepthMask.
+	 * @param write Should depth be written?
+	 */
+	void setDepthMask(bool write);
+
+	/**
+	 * @brief Enable or disable writing color, see glColorMask.
+	 * @param write Should all the color channels be written?
+	 */
+	void setColorMask(bool write);
+
+	/**
+	 * @brief Set which faces are culled, see glCullFace.
+	 * @param mode GL_FRONT, GL_BACK or GL_FRONT_AND_BACK.
+	 */
+	void setCullFace(GLenum mode);
+
+	/**
+	 * @brief Delete a program, and forget it if it is in use.
+	 * @param program The program.
+	 */
+	void deleteProgram(GLuint program);
+
+	/**
+	 * @brief Delete a vertex array, and forget it if it is bound.
+	 * @param vao The vertex array.
+	 */
+	void deleteVertexArray(GLuint vao);
+
+	/**
+	 * @brief Delete a framebuffer, and forget it if it is bound.
+	 * @param fbo The framebuffer.
+	 */
+	void deleteFramebuffer(GLuint fbo);
+
+	/**
+	 * @brief Delete textures, and forget the units they are bound to.
+	 * @param count Number of textures.
+	 * @param textures The textures.
+	 */
+	void deleteTextures(GLsizei count, const GLuint *textures);
+
+  private:
+	StateCache();
+
+	/**
+	 * @brief Count a call, and remember the new value if it changes anything.
+	 * @param cached The remembered value.
+	 * @param value The new value.
+	 * @return Should the call be issued?
+	 */
+	template <typename T>
+	auto change(std::optional<T> &cached, const T &value) -> bool {
+		if (cached == value) {
+			m_frame.skipped++;
+			return false;
+		}
+
+		m_frame.issued++;
+		cached = value;
+		return true;
+	}
+
+  private:
+	std::optional<GLuint>     m_program;      ///< Program in use.
+	std::optional<GLuint>     m_vao;          ///< Bound vertex array.
+	std::optional<GLuint>     m_read_fbo;     ///< Bound read framebuffer.
+	std::optional<GLuint>     m_draw_fbo;     ///< Bound draw framebuffer.
+	std::optional<glm::ivec4> m_viewport;     ///< The viewport.
+	std::map<std::pair<GLuint, GLenum>, std::optional<GLuint>>
+	    m_textures; ///< Texture bound to every unit and target.
+	std::map<GLenum, std::optional<bool>>
+	    m_capabilities; ///< Enabled capabilities.
+	std::optional<std::pair<GLenum, GLenum>> m_blend_func; ///< Blend factors.
+	std::optional<GLenum> m_depth_func;  ///< Depth comparison.
+	std::optional<bool>   m_depth_mask;  ///< Is depth written?
+	std::optional<bool>   m_color_mask;  ///< Is color written?
+	std::optional<GLenum> m_cull_face;   ///< Culled faces.
+	StateCacheStats       m_frame;       ///< Counts of the current frame.
+	StateCacheStats       m_last_frame;  ///< Counts of the last whole frame.
+};
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+/**
+ * @brief A fixed set of worker threads running jobs from a shared queue.
+ *
+ * Jobs must not touch OpenGL, as the context is only current on the main
+ * thread.
+ */
+class ThreadPool {
+  public:
+	/**
+	 * @brief Start the worker threads.
+	 * @param thread_count Number of worker threads, at least one.
+	 */
+	explicit ThreadPool(size_t thread_count = 1);
+
+	ThreadPool(const ThreadPool &other) = delete;
+
+	ThreadPool(const ThreadPool &&other) = delete;
+
+	auto operator=(const ThreadPool &other) = delete;
+
+	auto operator=(const ThreadPool &&other) = delete;
+
+	/**
+	 * @brief Finish the jobs that are running, drop the ones that have not
+	 * started and join the worker threads.
+	 * Futures of dropped jobs report a broken promise.
+	 */
+	~ThreadPool();
+
+	/**
+	 * @brief Queue a job to run on one of the worker threads.
+	 * @tparam Job Callable taking no arguments.
+	 * @param job The job to run.
+	 * @return Future with the result of the job, or the exception it threw.
+	 */
+	template <typename Job>
+	auto submit(Job &&job) -> std::future<std::invoke_result_t<Job>> {
+		using Result = std::invoke_result_t<Job>;
+
+		// std::function must be copyable, the packaged task is not
+		auto task = std::make_shared<std::packaged_task<Result()>>(
+		    std::forward<Job>(job));
+		auto future = task->get_future();
+
+		{
+			std::lock_guard lock(m_mutex);
+			m_jobs.emplace([task]() { (*task)(); });
+		}
+		m_condition.notify_one();
+
+		return future;
+	}
+
+  private:
+	/**
+	 * @brief Run jobs until the pool is destroyed.
+	 */
+	void work();
+
+  private:
+	std::vector<std::thread>          m_threads;   ///< Worker threads.
+	std::queue<std::function<void()>> m_jobs;      ///< Jobs not yet started.
+	std::mutex                        m_mutex;     ///< Guards the job queue.
+	std::condition_variable           m_condition; ///< Signals new jobs.
+	bool                              m_stopping;  ///< Are workers stopping?
+};
@@ -1,8 +1,21 @@
 #pragma once
 
 #include <GL/glew.h>
+#include <glove/Buffer.h>
 #include <vector>
 
+/**
+ * @brief Parameters of one indexed draw, as read by glDrawElementsIndirect
+ * from an indirect draw buffer.
+ */
+struct DrawElementsIndirectCommand {
+	GLuint index_count;    ///< Number of indices to draw.
+	GLuint instance_count; ///< Number of instances to draw.
+	GLuint first_index;    ///< Offset of the first index to draw.
+	GLint  base_vertex;    ///< Value added to every index.
+	GLuint base_instance;  ///< First instance to draw.
+};
+
 /**
  * @brief VertexBuffer is a class for representing a vertex buffer and freeing
  * the resources on deconstruction.
@@ -35,6 +48,18 @@ class VertexBuffer {
 	VertexBuffer(const std::vector<VertexFormat> &vertices,
 	             const std::vector<GLuint> &      indices);
 
+	/**
+	 * @brief Construct a VBO containing both a vertex buffer and an index
+	 * buffer from raw arrays. Useful for uploading straight out of memory that
+	 * is not owned by a vector, e.g. a memory mapped file.
+	 * @param vertices Pointer to the first vertex.
+	 * @param vertex_count Number of vertices.
+	 * @param indices Pointer to the first index.
+	 * @param index_count Number of indices.
+	 */
+	VertexBuffer(const VertexFormat *vertices, size_t vertex_count,
+	             const GLuint *indices, size_t index_count);
+
 	VertexBuffer(const VertexBuffer &other) = delete;
 
 	VertexBuffer(const VertexBuffer &&other) = delete;
@@ -54,6 +79,50 @@ class VertexBuffer {
 	 */
 	void draw() const;
 
+	/**
+	 * @brief Draw a range of the index buffer, for every instance if
+	 * instancing is enabled.
+	 * @param index_offset Offset of the first index to draw.
+	 * @param index_count Number of indices to draw.
+	 * @param base_vertex Value added to every index.
+	 */
+	void drawRange(GLuint index_offset, GLuint index_count,
+	               GLint base_vertex = 0) const;
+
+	/**
+	 * @brief Draw a range of the index buffer for a range of the instances.
+	 * @note Instancing MUST be enabled.
+	 * @param index_offset Offset of the first index to draw.
+	 * @param index_count Number of indices to draw.
+	 * @param base_vertex Value added to every index.
+	 * @param first_instance First instance to draw.
+	 * @param instance_count Number of instances to draw.
+	 */
+	void drawRangeInstanced(GLuint index_offset, GLuint index_count,
+	                        GLint base_vertex, GLuint first_instance,
+	                        GLuint instance_count) const;
+
+	/**
+	 * @brief Record drawing a range of the index buffer into a command list,
+	 * see drawRange. Does not touch OpenGL.
+	 * @param list Command list to record into.
+	 * @param index_offset Offset of the first index to draw.
+	 * @param index_count Number of indices to draw.
+	 * @param base_vertex Value added to every index.
+	 */
+	void recordRange(class CommandList &list, GLuint index_offset,
+	                 GLuint index_count, GLint base_vertex = 0) const;
+
+	/**
+	 * @brief Draw with parameters read from an indirect draw buffer, so that
+	 * e.g. the instance counts can be written by a compute shader.
+	 * @param commands Buffer of DrawElementsIndirectCommand.
+	 * @param first_command First command in the buffer to draw.
+	 * @param command_count Number of commands to draw.
+	 */
+	void drawIndirect(const Buffer &commands, size_t first_command,
+	                  size_t command_count) const;
+
 	/**
 	 * @brief Upload new content to the whole buffer.
 	 * @param vertices Vertices to upload.
@@ -84,6 +153,16 @@ class VertexBuffer {
 	template <typename InstanceFormat>
 	void uploadInstanceData(const std::vector<InstanceFormat> &instance_data);
 
+	/**
+	 * @brief Get the VBO with per instance data, e.g. to write instances from
+	 * a compute shader.
+	 * @note Instancing MUST be enabled.
+	 * @return The buffer name.
+	 */
+	[[nodiscard]] auto getInstanceBuffer() const -> GLuint {
+		return m_instance_vbo;
+	}
+
   private:
 	bool m_indexed;   ///< Indicates whether the VBO has an associated index
 	                  ///< buffer and whether the VBO should be drawn using
@@ -2,7 +2,8 @@
 
 #include <GLFW/glfw3.h>
 #include <chrono>
-#include <deque>
+#include <glove/FramePacer.h>
+#include <glove/RingBuffer.h>
 #include <memory>
 #include <string>
 
@@ -67,9 +68,38 @@ enum class InputState {
 struct Input {
 	InputCode  code;
 	InputState state;
+	double     time; ///< GLFW time the event was received, in seconds.
 };
 
-using InputQueue = std::shared_ptr<std::deque<Input>>;
+/**
+ * @brief Number of input events a window holds before dropping new ones.
+ */
+constexpr size_t gInputCapacity = 256;
+
+/**
+ * @brief Input events in the order they were received. The window pushes
+ * them, and the game pops them whenever it is ready, so none are lost between
+ * frames.
+ */
+using InputQueue = std::shared_ptr<RingBuffer<Input, gInputCapacity>>;
+
+/**
+ * @brief Kind of OpenGL context a window creates.
+ */
+enum class ContextMode {
+	Debug,   ///< Debug context, reporting every message synchronously.
+	Release, ///< No debug output, and no error checking in the driver.
+};
+
+/**
+ * @brief Kind of context windows create by default, release in builds
+ * without asserts.
+ */
+#ifdef NDEBUG
+constexpr ContextMode gDefaultContextMode = ContextMode::Release;
+#else
+constexpr ContextMode gDefaultContextMode = ContextMode::Debug;
+#endif
 
 /**
  * @brief Window object that maintains a window and opengl context.
@@ -81,8 +111,10 @@ class Window {
 	 * @param title Title of the window.
 	 * @param width Width of the window.
 	 * @param height Height of the window.
+	 * @param mode Kind of context to create.
 	 */
-	Window(const std::string &title, uint32_t width, uint32_t height);
+	Window(const std::string &title, uint32_t width, uint32_t height,
+	       ContextMode mode = gDefaultContextMode);
 
 	Window(const Window &other) = delete;
 
@@ -96,6 +128,7 @@ class Window {
 
 	/**
 	 * @brief Poll for new events and indicate if the window should closed.
+	 * The events are pushed to the input queue.
 	 * @return Should the window be closed?
 	 */
 	auto pollEvents() -> bool;
@@ -152,6 +185,25 @@ class Window {
 	 */
 	[[nodiscard]] auto getDeltaTime() const -> float { return m_delta_time; }
 
+	/**
+	 * @brief Change how frames are presented, see FramePacer. Windows start
+	 * out with vsync.
+	 * @param mode How frames are presented.
+	 * @param rate Most frames per second, only used when capped.
+	 */
+	void setPresentMode(PresentMode mode, float rate = 0.0f) {
+		m_pacer->setMode(mode, rate);
+	}
+
+	/**
+	 * @brief Get the times the last frames were presented, oldest first.
+	 * @return Present times.
+	 */
+	[[nodiscard]] auto getPresentTimes() const
+	    -> const std::deque<FramePacer::TimePoint> & {
+		return m_pacer->getPresentTimes();
+	}
+
 	/**
 	 * @brief Get a shared pointer to the input queue.
 	 * @return A shared pointer to the input queue.
@@ -170,4 +222,6 @@ class Window {
 	float       m_delta_time = 0.016f;
 	GLFWwindow *m_window;
 	InputQueue  m_input_queue;
+
+	std::unique_ptr<FramePacer> m_pacer; ///< Paces the swaps.
 };
\ No newline at end of file
@@ -19,12 +19,36 @@
 
 // Reexport internal headers
 #include <glove/AnimatedSpriteSheet.h>
+#include <glove/Buffer.h>
+#include <glove/CascadedShadowMap.h>
+#include <glove/ClusteredLights.h>
+#include <glove/CommandList.h>
 #include <glove/Components.h>
+#include <glove/DynamicResolution.h>
+#include <glove/FrameGraph.h>
+#include <glove/FramePacer.h>
 #include <glove/Framebuffer.h>
+#include <glove/Frustum.h>
 #include <glove/GameState.h>
+#include <glove/GlTracer.h>
+#include <glove/GpuProfiler.h>
+#include <glove/GpuTimer.h>
+#include <glove/MappedFile.h>
+#include <glove/Mesh.h>
+#include <glove/MeshCache.h>
+#include <glove/MeshOptimizer.h>
+#include <glove/MeshSimplifier.h>
 #include <glove/Model.h>
+#include <glove/ModelLoader.h>
+#include <glove/ObjLoader.h>
+#include <glove/OcclusionCuller.h>
+#include <glove/RenderQueue.h>
+#include <glove/RenderTargetPool.h>
+#include <glove/RingBuffer.h>
 #include <glove/ShaderProgram.h>
+#include <glove/StateCache.h>
 #include <glove/Texture.h>
+#include <glove/ThreadPool.h>
 #include <glove/VertexBuffer.h>
 #include <glove/VertexFormats.h>
 #include <glove/Window.h>
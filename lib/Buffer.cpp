@@ -0,0 +1,30 @@
+#include <cassert>
+#include <glove/Buffer.h>
+
+Buffer::Buffer(size_t size, GLenum usage) : m_size(size) {
+	glGenBuffers(1, &m_buffer);
+
+	// The copy write target is not used for anything else, so binding to it
+	// does not disturb any other state
+	glBindBuffer(GL_COPY_WRITE_BUFFER, m_buffer);
+	glBufferData(GL_COPY_WRITE_BUFFER, size, nullptr, usage);
+
+	const GLuint zero = 0;
+	glClearBufferData(GL_COPY_WRITE_BUFFER, GL_R32UI, GL_RED_INTEGER,
+	                  GL_UNSIGNED_INT, &zero);
+}
+
+Buffer::~Buffer() { glDeleteBuffers(1, &m_buffer); }
+
+void Buffer::bind(GLenum target) const { glBindBuffer(target, m_buffer); }
+
+void Buffer::bindBase(GLenum target, GLuint index) const {
+	glBindBufferBase(target, index, m_buffer);
+}
+
+void Buffer::upload(const void *data, size_t size, size_t offset) {
+	assert(offset + size <= m_size);
+
+	glBindBuffer(GL_COPY_WRITE_BUFFER, m_buffer);
+	glBufferSubData(GL_COPY_WRITE_BUFFER, offset, size, data);
+}
@@ -0,0 +1,184 @@
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <glove/CascadedShadowMap.h>
+#include <glove/StateCache.h>
+
+/**
+ * @brief Where the first cascade starts. The camera's own near plane is far
+ * too close for the logarithmic splits to be useful.
+ */
+static constexpr float gCascadeNear = 0.1f;
+
+/**
+ * @brief Blend between logarithmic and uniform splits, 1 is fully
+ * logarithmic. See "Parallel-Split Shadow Maps" by Zhang et al.
+ */
+static constexpr float gSplitLambda = 0.75f;
+
+/**
+ * @brief Size of the region a cascade covers, relative to its slice of the
+ * camera frustum. The region stays put while the slice moves around inside it,
+ * so the static casters are not drawn again every time the camera moves.
+ */
+static constexpr float gRegionScale = 1.5f;
+
+/**
+ * @brief Allocate a depth array texture with one layer per cascade.
+ */
+static auto create_depth_array(GLsizei resolution, size_t layers) -> GLuint {
+	GLuint texture;
+	glGenTextures(1, &texture);
+	StateCache::get().bindTexture(GL_TEXTURE_2D_ARRAY, texture);
+	glTexStorage3D(GL_TEXTURE_2D_ARRAY, 1, GL_DEPTH_COMPONENT32F, resolution,
+	               resolution, static_cast<GLsizei>(layers));
+
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+	return texture;
+}
+
+CascadedShadowMap::CascadedShadowMap(GLsizei resolution, size_t cascade_count,
+                                     float max_distance)
+    : m_framebuffer(std::make_unique<Framebuffer>()),
+      m_static_texture(create_depth_array(resolution, cascade_count)),
+      m_texture(create_depth_array(resolution, cascade_count)),
+      m_resolution(resolution), m_max_distance(max_distance),
+      m_matrices(cascade_count, glm::mat4(1.0f)), m_splits(cascade_count),
+      m_pixels_per_unit(cascade_count),
+      m_origins(cascade_count, glm::vec3(0.0f)), m_extents(cascade_count, 0.0f),
+      m_light_direction(0.0f), m_cached(cascade_count, false) {
+	assert(cascade_count > 0 && cascade_count <= gMaxCascades);
+}
+
+CascadedShadowMap::~CascadedShadowMap() {
+	auto &state = StateCache::get();
+	state.deleteTextures(1, &m_static_texture);
+	state.deleteTextures(1, &m_texture);
+}
+
+void CascadedShadowMap::update(const CameraComponent &camera,
+                               const glm::mat4 &      view,
+                               const glm::vec3 &      light_direction) {
+	const auto cascade_count = m_matrices.size();
+	const auto inverse_view  = glm::inverse(view);
+	const auto tan_half_fov  = std::tan(glm::radians(camera.vfov) / 2.0f);
+
+	// The regions are in light space, so they all move with the light
+	if (light_direction != m_light_direction) {
+		std::fill(begin(m_extents), end(m_extents), 0.0f);
+		m_light_direction = light_direction;
+	}
+
+	// The light only rotates the world, the cascades are placed in light
+	// space afterwards, so that moving the camera only translates them
+	const auto up =
+	    std::abs(light_direction.y) > 0.99f ? glm::vec3(0.0f, 0.0f, 1.0f)
+	                                        : glm::vec3(0.0f, 1.0f, 0.0f);
+	const auto light_view =
+	    glm::lookAt(glm::vec3(0.0f), -light_direction, up);
+
+	auto slice_near = gCascadeNear;
+	for (size_t i = 0; i < cascade_count; ++i) {
+		const auto fraction =
+		    static_cast<float>(i + 1) / static_cast<float>(cascade_count);
+		const auto logarithmic =
+		    gCascadeNear * std::pow(m_max_distance / gCascadeNear, fraction);
+		const auto uniform =
+		    gCascadeNear + (m_max_distance - gCascadeNear) * fraction;
+		const auto slice_far =
+		    gSplitLambda * logarithmic + (1.0f - gSplitLambda) * uniform;
+
+		// Corners of the slice of the camera frustum, in world space
+		std::array<glm::vec3, 8> corners;
+		auto                     center = glm::vec3(0.0f);
+		for (size_t k = 0; k < 8; ++k) {
+			const auto depth  = k < 4 ? slice_near : slice_far;
+			const auto height = depth * tan_half_fov;
+			const auto width  = height * camera.aspect;
+			const auto corner =
+			    glm::vec4((k & 1) ? width : -width, (k & 2) ? height : -height,
+			              -depth, 1.0f);
+			corners[k] = glm::vec3(inverse_view * corner);
+			center += corners[k] / 8.0f;
+		}
+
+		// A sphere around the slice keeps the same size as the camera turns.
+		// Rounding it up hides the float noise in the radius.
+		auto radius = 0.0f;
+		for (const auto &corner : corners)
+			radius = std::max(radius, glm::distance(corner, center));
+		radius = std::ceil(radius * 16.0f) / 16.0f;
+
+		// Only move the region once the sphere leaves it, or the sphere
+		// changed size with the camera's projection. The new region is
+		// snapped to whole texels in light space.
+		const auto extent = radius * gRegionScale;
+		const auto center_in_light =
+		    glm::vec3(light_view * glm::vec4(center, 1.0f));
+		const auto offset = glm::abs(center_in_light - m_origins[i]);
+		if (m_extents[i] != extent ||
+		    std::max({offset.x, offset.y, offset.z}) + radius > extent) {
+			const auto texel = 2.0f * extent / static_cast<float>(m_resolution);
+			m_origins[i] = glm::floor(center_in_light / texel) * texel;
+			m_extents[i] = extent;
+			m_cached[i]  = false;
+		}
+
+		// Reach back towards the light to catch casters outside the region
+		const auto &origin     = m_origins[i];
+		const auto  projection = glm::ortho(
+		    origin.x - extent, origin.x + extent, origin.y - extent,
+		    origin.y + extent, -(origin.z + extent + m_max_distance),
+		    -(origin.z - extent));
+
+		m_matrices[i]        = projection * light_view;
+		m_splits[i]          = slice_far;
+		m_pixels_per_unit[i] = static_cast<float>(m_resolution) / 2.0f / extent;
+
+		slice_near = slice_far;
+	}
+}
+
+auto CascadedShadowMap::beginStatic(size_t cascade) -> bool {
+	assert(cascade < m_matrices.size());
+
+	if (m_cached[cascade])
+		return false;
+
+	m_framebuffer->attachLayer(AttachmentType::Depth, m_static_texture,
+	                           static_cast<GLint>(cascade),
+	                           glm::ivec2(m_resolution));
+	m_framebuffer->bind();
+	m_framebuffer->clear();
+
+	// The caller draws the static casters right away
+	m_cached[cascade] = true;
+
+	return true;
+}
+
+void CascadedShadowMap::beginDynamic(size_t cascade) {
+	assert(cascade < m_matrices.size());
+
+	const auto layer = static_cast<GLint>(cascade);
+	glCopyImageSubData(m_static_texture, GL_TEXTURE_2D_ARRAY, 0, 0, 0, layer,
+	                   m_texture, GL_TEXTURE_2D_ARRAY, 0, 0, 0, layer,
+	                   m_resolution, m_resolution, 1);
+
+	m_framebuffer->attachLayer(AttachmentType::Depth, m_texture, layer,
+	                           glm::ivec2(m_resolution));
+	m_framebuffer->bind();
+}
+
+void CascadedShadowMap::invalidate() {
+	std::fill(begin(m_cached), end(m_cached), false);
+}
+
+void CascadedShadowMap::bindToSlot(GLuint slot) const {
+	StateCache::get().bindTexture(slot, GL_TEXTURE_2D_ARRAY, m_texture);
+}
@@ -0,0 +1,75 @@
+#include <algorithm>
+#include <cassert>
+#include <glove/ClusteredLights.h>
+
+/**
+ * @brief Local size of the binning compute shader, must match
+ * cluster_lights.comp.
+ */
+static constexpr size_t gClusterGroupSize = 64;
+
+ClusteredLights::ClusteredLights(size_t max_lights,
+                                 size_t max_lights_per_cluster,
+                                 glm::vec2 depth_range, glm::ivec3 grid)
+    : m_grid(grid), m_depth_range(depth_range), m_max_lights(max_lights),
+      m_max_lights_per_cluster(max_lights_per_cluster), m_light_count(0) {
+	assert(max_lights > 0 && max_lights_per_cluster > 0);
+	assert(depth_range.x > 0.0f && depth_range.x < depth_range.y);
+
+	const auto cluster_count = static_cast<size_t>(grid.x * grid.y * grid.z);
+
+	m_light_buffer = std::make_unique<Buffer>(max_lights * sizeof(PointLight));
+	m_count_buffer = std::make_unique<Buffer>(cluster_count * sizeof(GLuint),
+	                                          GL_DYNAMIC_COPY);
+	m_index_buffer = std::make_unique<Buffer>(
+	    cluster_count * max_lights_per_cluster * sizeof(GLuint),
+	    GL_DYNAMIC_COPY);
+
+	using namespace std::string_literals;
+	const auto shaders = {"resources/shaders/cluster_lights.comp"s};
+	m_shader           = std::make_unique<ShaderProgram>(shaders);
+}
+
+void ClusteredLights::setLights(const std::vector<PointLight> &lights) {
+	m_light_count = std::min(lights.size(), m_max_lights);
+	if (m_light_count > 0)
+		m_light_buffer->upload(lights.data(),
+		                       m_light_count * sizeof(PointLight));
+}
+
+void ClusteredLights::update(const glm::mat4 &view,
+                             const glm::mat4 &projection) {
+	m_shader->use();
+	m_shader->setUniform("u_grid", m_grid);
+	m_shader->setUniform("u_light_count", static_cast<GLuint>(m_light_count));
+	m_shader->setUniform("u_max_lights_per_cluster",
+	                     static_cast<GLuint>(m_max_lights_per_cluster));
+	m_shader->setUniform("u_depth_range", m_depth_range);
+	m_shader->setUniform("u_view", view);
+	m_shader->setUniform("u_inverse_projection", glm::inverse(projection));
+
+	m_light_buffer->bindBase(GL_SHADER_STORAGE_BUFFER, 3);
+	m_count_buffer->bindBase(GL_SHADER_STORAGE_BUFFER, 4);
+	m_index_buffer->bindBase(GL_SHADER_STORAGE_BUFFER, 5);
+
+	// One invocation per cluster, every one of them tests all the lights
+	const auto cluster_count =
+	    static_cast<size_t>(m_grid.x * m_grid.y * m_grid.z);
+	m_shader->dispatch(static_cast<GLuint>(
+	    (cluster_count + gClusterGroupSize - 1) / gClusterGroupSize));
+
+	// The fragment shaders read the clusters as storage buffers
+	glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+}
+
+void ClusteredLights::bindTo(ShaderProgram &shader, glm::ivec2 viewport) const {
+	m_light_buffer->bindBase(GL_SHADER_STORAGE_BUFFER, 3);
+	m_count_buffer->bindBase(GL_SHADER_STORAGE_BUFFER, 4);
+	m_index_buffer->bindBase(GL_SHADER_STORAGE_BUFFER, 5);
+
+	shader.setUniform("u_cluster_grid", m_grid);
+	shader.setUniform("u_cluster_depth_range", m_depth_range);
+	shader.setUniform("u_cluster_viewport", glm::vec2(viewport));
+	shader.setUniform("u_max_lights_per_cluster",
+	                  static_cast<GLuint>(m_max_lights_per_cluster));
+}
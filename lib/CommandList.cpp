@@ -0,0 +1,145 @@
+#include <cassert>
+#include <cstring>
+#include <glove/CommandList.h>
+#include <glove/StateCache.h>
+
+/**
+ * @brief Make a visitor out of lambdas, one per command type.
+ */
+template <typename... Ts> struct overloaded : Ts... {
+	using Ts::operator()...;
+};
+template <typename... Ts> overloaded(Ts...) -> overloaded<Ts...>;
+
+void CommandList::useProgram(ShaderProgram &program) {
+	m_commands.emplace_back(UseProgram{&program});
+}
+
+void CommandList::setUniform(const char *name, UniformValue value) {
+	m_commands.emplace_back(SetUniform{name, m_uniforms.size()});
+	m_uniforms.push_back(value);
+}
+
+void CommandList::bindTexture(GLuint unit, GLenum target, GLuint texture) {
+	m_commands.emplace_back(BindTexture{unit, target, texture});
+}
+
+void CommandList::setEnabled(GLenum capability, bool enabled) {
+	m_commands.emplace_back(SetEnabled{capability, enabled});
+}
+
+void CommandList::drawElements(GLuint vao, GLuint index_offset,
+                               GLuint index_count, GLint base_vertex,
+                               GLuint first_instance, GLuint instance_count) {
+	m_commands.emplace_back(DrawElements{vao, index_offset, index_count,
+	                                     base_vertex, first_instance,
+	                                     instance_count});
+}
+
+void CommandList::drawArrays(GLuint vao, GLint first, GLsizei count) {
+	m_commands.emplace_back(DrawArrays{vao, first, count});
+}
+
+void CommandList::upload(Buffer &buffer, const void *data, size_t size,
+                         size_t offset) {
+	assert(offset + size <= buffer.getSize());
+
+	const auto start = m_data.size();
+	m_data.resize(start + size);
+	std::memcpy(m_data.data() + start, data, size);
+
+	m_commands.emplace_back(Upload{&buffer, offset, start, size});
+}
+
+void CommandList::execute() const {
+	auto &state = StateCache::get();
+
+	ShaderProgram *program = nullptr;
+	for (const auto &command : m_commands) {
+		std::visit(
+		    overloaded{
+		        [&](const UseProgram &c) {
+			        c.program->use();
+			        program = c.program;
+		        },
+		        [&](const SetUniform &c) {
+			        assert(program != nullptr);
+			        std::visit(
+			            [&](const auto &value) {
+				            program->setUniform(c.name, value);
+			            },
+			            m_uniforms[c.value]);
+		        },
+		        [&](const BindTexture &c) {
+			        state.bindTexture(c.unit, c.target, c.texture);
+		        },
+		        [&](const SetEnabled &c) {
+			        state.setEnabled(c.capability, c.enabled);
+		        },
+		        [&](const DrawElements &c) {
+			        state.bindVertexArray(c.vao);
+			        glDrawElementsInstancedBaseVertexBaseInstance(
+			            GL_TRIANGLES, c.index_count, GL_UNSIGNED_INT,
+			            reinterpret_cast<const void *>(c.index_offset *
+			                                           sizeof(GLuint)),
+			            c.instance_count, c.base_vertex, c.first_instance);
+		        },
+		        [&](const DrawArrays &c) {
+			        state.bindVertexArray(c.vao);
+			        glDrawArraysInstanced(GL_TRIANGLES, c.first, c.count, 1);
+		        },
+		        [&](const Upload &c) {
+			        c.buffer->upload(m_data.data() + c.data, c.size, c.offset);
+		        },
+		    },
+		    command);
+	}
+}
+
+void CommandList::clear() {
+	m_commands.clear();
+	m_uniforms.clear();
+	m_data.clear();
+}
+
+CommandQueue::CommandQueue(size_t thread_count) : m_pool(thread_count) {}
+
+auto CommandQueue::record(std::function<void(CommandList &)> job) -> size_t {
+	const auto index = m_pending.size();
+	if (index == m_lists.size())
+		m_lists.emplace_back();
+
+	auto &list = m_lists[index];
+	list.clear();
+
+	m_pending.push_back(
+	    m_pool.submit([&list, job = std::move(job)]() { job(list); }));
+	m_executed.push_back(false);
+
+	return index;
+}
+
+void CommandQueue::execute(size_t index) {
+	assert(index < m_pending.size());
+	assert(!m_executed[index]);
+
+	m_pending[index].get();
+	m_lists[index].execute();
+	m_executed[index] = true;
+}
+
+void CommandQueue::execute() {
+	for (size_t i = 0; i < m_pending.size(); ++i)
+		if (!m_executed[i])
+			execute(i);
+}
+
+void CommandQueue::reset() {
+	// Wait for recordings nobody replayed, they still write to the lists
+	for (auto &pending : m_pending)
+		if (pending.valid())
+			pending.wait();
+
+	m_pending.clear();
+	m_executed.clear();
+}
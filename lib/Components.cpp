@@ -16,4 +16,17 @@ auto CameraComponent::view(const TransformComponent &transform) const
 
 auto CameraComponent::projection() const -> glm::mat4 {
 	return glm::perspective(glm::radians(vfov), aspect, 0.0001f, 100.0f);
+}
+
+auto CameraComponent::frustum(const TransformComponent &transform) const
+    -> Frustum {
+	return Frustum::fromMatrix(projection() * view(transform));
+}
+
+auto CameraComponent::pixelsPerUnit(float distance,
+                                    float viewport_height) const -> float {
+	// Height of the view frustum at the distance
+	const auto view_height = 2.0f * std::max(distance, 0.0001f) *
+	                         std::tan(glm::radians(vfov) / 2.0f);
+	return viewport_height / view_height;
 }
\ No newline at end of file
@@ -0,0 +1,69 @@
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <glove/DynamicResolution.h>
+
+/**
+ * @brief Weight of a new frame time in the smoothed frame time.
+ */
+static constexpr float gSmoothing = 0.1f;
+
+/**
+ * @brief Frame times between this fraction of the budget and the budget do not
+ * change the scale, so that it does not flip back and forth between steps.
+ */
+static constexpr float gHeadroom = 0.85f;
+
+/**
+ * @brief Largest change of the scale per update. Dropping is faster than
+ * rising, as a missed frame is worse than a blurry one.
+ */
+static constexpr float gMaxDrop = 0.9f;
+static constexpr float gMaxRise = 1.05f;
+
+/**
+ * @brief Size of the steps the scale moves in.
+ */
+static constexpr float gScaleStep = 1.0f / 16.0f;
+
+DynamicResolution::DynamicResolution(float budget_ms, float min_scale,
+                                     float max_scale)
+    : m_budget(budget_ms), m_min_scale(min_scale), m_max_scale(max_scale),
+      m_scale(max_scale), m_average(std::nullopt) {
+	assert(budget_ms > 0.0f);
+	assert(min_scale > 0.0f && min_scale <= max_scale);
+}
+
+auto DynamicResolution::update(float frame_ms) -> float {
+	m_average = m_average ? glm::mix(m_average.value(), frame_ms, gSmoothing)
+	                      : frame_ms;
+
+	const auto average = m_average.value();
+	if (average <= m_budget && average >= m_budget * gHeadroom)
+		return m_scale;
+
+	// Aim for the middle of the band, assuming the cost follows the pixels
+	const auto aim   = m_budget * (1.0f + gHeadroom) / 2.0f;
+	const auto ratio = std::clamp(std::sqrt(aim / std::max(average, 0.001f)),
+	                              gMaxDrop, gMaxRise);
+
+	// Round towards where the scale is going. Rounding to the nearest step
+	// would undo any change of less than half a step, which a small scale
+	// times the largest rise is, and leave the scale stuck there.
+	const auto steps   = m_scale * ratio / gScaleStep;
+	const auto snapped = ratio > 1.0f ? std::ceil(steps) : std::floor(steps);
+	const auto scale =
+	    std::clamp(snapped * gScaleStep, m_min_scale, m_max_scale);
+
+	// Predict what the new scale costs, so that the old frame times in the
+	// average do not push the scale past where it should go
+	m_average = average * (scale * scale) / (m_scale * m_scale);
+	m_scale   = scale;
+
+	return m_scale;
+}
+
+auto DynamicResolution::scale(glm::ivec2 dimensions) const -> glm::ivec2 {
+	const auto scaled = glm::round(glm::vec2(dimensions) * m_scale);
+	return glm::max(glm::ivec2(scaled), glm::ivec2(1));
+}
@@ -0,0 +1,186 @@
+#include <algorithm>
+#include <cassert>
+#include <glove/FrameGraph.h>
+#include <string>
+
+auto FrameGraph::PassBuilder::create(const RenderTargetDesc &desc)
+    -> FrameResource {
+	const auto resource = m_graph.m_resources.size();
+	m_graph.m_resources.push_back(
+	    {m_graph.m_passes[m_pass].name + "/" +
+	         std::to_string(m_graph.m_passes[m_pass].creates.size()),
+	     desc, m_pass});
+	m_graph.m_passes[m_pass].creates.push_back(resource);
+
+	return resource;
+}
+
+auto FrameGraph::PassBuilder::read(FrameResource resource) -> FrameResource {
+	assert(resource < m_graph.m_resources.size());
+
+	m_graph.m_passes[m_pass].reads.push_back(resource);
+	return resource;
+}
+
+auto FrameGraph::PassBuilder::write(FrameResource resource) -> FrameResource {
+	assert(resource < m_graph.m_resources.size());
+
+	m_graph.m_passes[m_pass].writes.push_back(resource);
+	return resource;
+}
+
+void FrameGraph::PassBuilder::sideEffect() {
+	m_graph.m_passes[m_pass].side_effect = true;
+}
+
+auto FrameGraph::PassContext::getTarget(FrameResource resource) const
+    -> const RenderTarget & {
+	assert(resource < m_graph.m_targets.size() &&
+	       m_graph.m_targets[resource] && "Target is not alive in this pass");
+
+	return *m_graph.m_targets[resource];
+}
+
+FrameGraph::FrameGraph(RenderTargetPool &pool) : m_pool(pool) {}
+
+auto FrameGraph::importResource(const std::string &name) -> FrameResource {
+	m_resources.push_back({name, std::nullopt, 0});
+	return m_resources.size() - 1;
+}
+
+void FrameGraph::addPass(const std::string &name, const SetupFunction &setup,
+                         ExecuteFunction execute) {
+	m_passes.push_back({name, {}, {}, {}, false});
+	m_executes.push_back(std::move(execute));
+
+	auto builder = PassBuilder(*this, m_passes.size() - 1);
+	setup(builder);
+}
+
+void FrameGraph::compile() {
+	if (m_compile_count > 0 && m_passes == m_compiled_passes &&
+	    m_resources == m_compiled_resources)
+		return;
+
+	m_compiled_passes    = m_passes;
+	m_compiled_resources = m_resources;
+	m_steps.clear();
+	m_compile_count++;
+
+	// Walk backwards from the side effects, keeping the passes that produce
+	// what the kept passes use. Writes keep earlier writers too, as they
+	// build on what those wrote.
+	std::vector<bool> needed(m_resources.size(), false);
+	std::vector<bool> kept(m_passes.size(), false);
+	for (size_t i = m_passes.size(); i-- > 0;) {
+		const auto &pass = m_passes[i];
+		const auto  produces_needed =
+		    std::any_of(begin(pass.creates), end(pass.creates),
+		                [&](auto r) { return needed[r]; }) ||
+		    std::any_of(begin(pass.writes), end(pass.writes),
+		                [&](auto r) { return needed[r]; });
+		if (!pass.side_effect && !produces_needed)
+			continue;
+
+		kept[i] = true;
+		for (const auto resource : pass.reads)
+			needed[resource] = true;
+		for (const auto resource : pass.writes)
+			needed[resource] = true;
+	}
+
+	// The last kept pass using every transient target
+	std::vector<std::optional<size_t>> last_use(m_resources.size());
+	for (size_t i = 0; i < m_passes.size(); ++i) {
+		if (!kept[i])
+			continue;
+		for (const auto *uses :
+		     {&m_passes[i].creates, &m_passes[i].reads, &m_passes[i].writes})
+			for (const auto resource : *uses)
+				last_use[resource] = i;
+	}
+
+	auto alive     = size_t(0);
+	m_peak_targets = 0;
+	for (size_t i = 0; i < m_passes.size(); ++i) {
+		if (!kept[i])
+			continue;
+
+		const auto &pass = m_passes[i];
+		auto        step = Step{i, pass.creates, {}, {}, nullptr};
+
+		// Created targets first, so that the color attachments are in the
+		// order the pass declared them
+		for (const auto *uses : {&pass.creates, &pass.writes})
+			for (const auto resource : *uses)
+				if (m_resources[resource].desc)
+					step.attaches.push_back(resource);
+
+		for (size_t r = 0; r < m_resources.size(); ++r)
+			if (m_resources[r].desc && last_use[r] == i)
+				step.releases.push_back(r);
+
+		alive += step.acquires.size();
+		m_peak_targets = std::max(m_peak_targets, alive);
+		alive -= step.releases.size();
+
+		m_steps.push_back(std::move(step));
+	}
+}
+
+void FrameGraph::execute() {
+	compile();
+
+	m_targets.resize(m_resources.size());
+	for (auto &step : m_steps) {
+		if (m_profiler)
+			m_profiler->begin(m_passes[step.pass].name);
+
+		for (const auto resource : step.acquires)
+			m_targets[resource] =
+			    m_pool.acquire(m_resources[resource].desc.value());
+
+		if (!step.attaches.empty()) {
+			if (!step.framebuffer)
+				step.framebuffer = std::make_unique<Framebuffer>();
+
+			// The leased textures may differ from frame to frame
+			size_t color_index = 0;
+			for (const auto resource : step.attaches) {
+				const auto &target = *m_targets[resource];
+				const auto  type   = target.getDesc().type;
+				const auto  index =
+				    type == AttachmentType::Color ? color_index++ : 0;
+				step.framebuffer->attach(target, index);
+
+				if (std::find(begin(step.acquires), end(step.acquires),
+				              resource) != end(step.acquires))
+					step.framebuffer->clearAttachment(type, index);
+			}
+			step.framebuffer->bind();
+		}
+
+		m_executes[step.pass](PassContext(*this, step.framebuffer.get()));
+
+		// Nothing reads the content again, so the driver may drop it
+		for (const auto resource : step.releases) {
+			glInvalidateTexImage(m_targets[resource]->getTexture(), 0);
+			m_targets[resource].reset();
+		}
+
+		if (m_profiler)
+			m_profiler->end();
+	}
+
+	m_resources.clear();
+	m_passes.clear();
+	m_executes.clear();
+}
+
+auto FrameGraph::getCompiledPasses() const -> std::vector<std::string> {
+	std::vector<std::string> names;
+	for (const auto &step : m_steps)
+		names.push_back(m_compiled_passes[step.pass].name);
+
+	return names;
+}
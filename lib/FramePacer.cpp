@@ -0,0 +1,96 @@
+#include <GLFW/glfw3.h>
+#include <cassert>
+#include <glove/FramePacer.h>
+#include <thread>
+
+/**
+ * @brief How long before a deadline the pacer stops sleeping and spins.
+ */
+static constexpr auto gSpinTime = std::chrono::microseconds(1500);
+
+/**
+ * @brief Longest the pacer waits for the GPU before checking again.
+ */
+static constexpr GLuint64 gFenceTimeout = 100000000; // 100 ms
+
+/**
+ * @brief Get the swap interval of a mode.
+ */
+static auto swap_interval(PresentMode mode) -> int {
+	switch (mode) {
+		case PresentMode::VSync: return 1;
+		case PresentMode::AdaptiveVSync: {
+			// A negative interval only tears if the extension is there
+			const auto tear =
+			    glfwExtensionSupported("WGL_EXT_swap_control_tear") ||
+			    glfwExtensionSupported("GLX_EXT_swap_control_tear");
+			return tear ? -1 : 1;
+		}
+		case PresentMode::Uncapped:
+		case PresentMode::Capped: return 0;
+	}
+
+	return 1;
+}
+
+FramePacer::FramePacer(PresentMode mode, float rate, size_t frames_in_flight)
+    : m_mode(mode), m_period(0), m_deadline(Clock::now()),
+      m_frames_in_flight(frames_in_flight) {
+	assert(frames_in_flight > 0);
+
+	setMode(mode, rate);
+}
+
+FramePacer::~FramePacer() {
+	for (const auto fence : m_fences)
+		glDeleteSync(fence);
+}
+
+void FramePacer::setMode(PresentMode mode, float rate) {
+	assert(mode != PresentMode::Capped || rate > 0.0f);
+
+	const auto period = std::chrono::duration<double>(
+	    mode == PresentMode::Capped ? 1.0 / static_cast<double>(rate) : 0.0);
+
+	m_mode     = mode;
+	m_period   = std::chrono::duration_cast<Clock::duration>(period);
+	m_deadline = Clock::now();
+
+	glfwSwapInterval(swap_interval(mode));
+}
+
+void FramePacer::beforeSwap() {
+	if (m_mode != PresentMode::Capped)
+		return;
+
+	// A frame that misses its deadline by more than a whole period starts
+	// over, rather than rushing the next ones to catch up
+	m_deadline += m_period;
+	const auto now = Clock::now();
+	if (now > m_deadline + m_period)
+		m_deadline = now;
+
+	if (m_deadline - now > gSpinTime)
+		std::this_thread::sleep_until(m_deadline - gSpinTime);
+	while (Clock::now() < m_deadline)
+		std::this_thread::yield();
+}
+
+void FramePacer::afterSwap() {
+	m_presents.push_back(Clock::now());
+	if (m_presents.size() > gPresentHistory)
+		m_presents.pop_front();
+
+	m_fences.push_back(glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0));
+	while (m_fences.size() > m_frames_in_flight) {
+		// The flush makes sure the fence is ever reached
+		GLenum status;
+		do {
+			status = glClientWaitSync(
+			    m_fences.front(), GL_SYNC_FLUSH_COMMANDS_BIT, gFenceTimeout);
+		} while (status == GL_TIMEOUT_EXPIRED);
+
+		glDeleteSync(m_fences.front());
+		m_fences.pop_front();
+	}
+}
@@ -1,4 +1,8 @@
+#include <algorithm>
+#include <cassert>
 #include <glove/Framebuffer.h>
+#include <glove/RenderTargetPool.h>
+#include <glove/StateCache.h>
 
 Framebuffer::Framebuffer()
     : m_depth_attachment(std::nullopt),
@@ -11,7 +15,12 @@ Framebuffer::Framebuffer(GLuint fbo)
       m_depth_stencil_attachment(std::nullopt),
       m_dimensions(glm::ivec2(1280, 720)) {}
 
-Framebuffer::~Framebuffer() { glDeleteFramebuffers(1, &m_fbo); }
+Framebuffer::~Framebuffer() {
+	auto &state = StateCache::get();
+	state.deleteFramebuffer(m_fbo);
+	state.deleteTextures(static_cast<GLsizei>(m_owned_textures.size()),
+	                     m_owned_textures.data());
+}
 
 auto Framebuffer::defaultFramebuffer() -> std::unique_ptr<Framebuffer> {
 	return std::unique_ptr<Framebuffer>(new Framebuffer(0));
@@ -22,8 +31,9 @@ auto Framebuffer::valid() const -> bool {
 }
 
 void Framebuffer::bind(GLenum target) const {
-	glViewport(0, 0, m_dimensions.x, m_dimensions.y);
-	glBindFramebuffer(target, m_fbo);
+	auto &state = StateCache::get();
+	state.setViewport(glm::ivec4(0, 0, m_dimensions.x, m_dimensions.y));
+	state.bindFramebuffer(target, m_fbo);
 }
 
 void Framebuffer::addAttachment(AttachmentType type, glm::ivec2 dimensions) {
@@ -34,7 +44,8 @@ void Framebuffer::addAttachment(AttachmentType type, glm::ivec2 dimensions) {
 	// Create texture
 	GLuint tex;
 	glGenTextures(1, &tex);
-	glBindTexture(GL_TEXTURE_2D, tex);
+	StateCache::get().bindTexture(GL_TEXTURE_2D, tex);
+	m_owned_textures.push_back(tex);
 
 	GLenum attachment;
 	GLint  internal_format;
@@ -75,6 +86,56 @@ void Framebuffer::addAttachment(AttachmentType type, glm::ivec2 dimensions) {
 	glFramebufferTexture2D(GL_FRAMEBUFFER, attachment, GL_TEXTURE_2D, tex, 0);
 }
 
+void Framebuffer::attach(const RenderTarget &target, size_t color_index) {
+	const auto &desc = target.getDesc();
+	attach(desc.type, target.getTexture(), desc.dimensions, color_index);
+}
+
+/**
+ * @brief Get the attachment point of a type of attachment.
+ */
+static auto attachment_point(AttachmentType type, size_t color_index)
+    -> GLenum {
+	switch (type) {
+		case AttachmentType::Color: return GL_COLOR_ATTACHMENT0 + color_index;
+		case AttachmentType::Depth: return GL_DEPTH_ATTACHMENT;
+		case AttachmentType::DepthStencil: return GL_DEPTH_STENCIL_ATTACHMENT;
+	}
+
+	return GL_NONE;
+}
+
+void Framebuffer::attach(AttachmentType type, GLuint texture,
+                         glm::ivec2 dimensions, size_t color_index) {
+	trackAttachment(type, texture, color_index);
+	glNamedFramebufferTexture(m_fbo, attachment_point(type, color_index),
+	                          texture, 0);
+	m_dimensions = dimensions;
+}
+
+void Framebuffer::attachLayer(AttachmentType type, GLuint texture, GLint layer,
+                              glm::ivec2 dimensions) {
+	trackAttachment(type, texture, 0);
+	glNamedFramebufferTextureLayer(m_fbo, attachment_point(type, 0), texture,
+	                               0, layer);
+	m_dimensions = dimensions;
+}
+
+void Framebuffer::trackAttachment(AttachmentType type, GLuint texture,
+                                  size_t color_index) {
+	switch (type) {
+		case AttachmentType::Color:
+			if (m_color_attachments.size() <= color_index)
+				m_color_attachments.resize(color_index + 1, 0);
+			m_color_attachments[color_index] = texture;
+			break;
+		case AttachmentType::Depth: m_depth_attachment = texture; break;
+		case AttachmentType::DepthStencil:
+			m_depth_stencil_attachment = texture;
+			break;
+	}
+}
+
 void Framebuffer::clear() const {
 	glClear((!m_color_attachments.empty() ? GL_COLOR_BUFFER_BIT : 0) |
 	        (m_depth_attachment.has_value() ? GL_DEPTH_BUFFER_BIT : 0) |
@@ -83,24 +144,53 @@ void Framebuffer::clear() const {
 	             : 0));
 }
 
+void Framebuffer::clearAttachment(AttachmentType type,
+                                  size_t         color_index) const {
+	const GLfloat black[] = {0.0f, 0.0f, 0.0f, 0.0f};
+	const GLfloat depth   = 1.0f;
+
+	switch (type) {
+		case AttachmentType::Color:
+			glClearNamedFramebufferfv(m_fbo, GL_COLOR,
+			                          static_cast<GLint>(color_index), black);
+			break;
+		case AttachmentType::Depth:
+			glClearNamedFramebufferfv(m_fbo, GL_DEPTH, 0, &depth);
+			break;
+		case AttachmentType::DepthStencil:
+			glClearNamedFramebufferfi(m_fbo, GL_DEPTH_STENCIL, 0, depth, 0);
+			break;
+	}
+}
+
 void Framebuffer::resize(int width, int height) {
 	// Default framebuffer is resized by glfw
 	if (m_fbo != 0) {
 		// Manually resize framebuffer by reallocating all the attachments
+		auto &     state = StateCache::get();
+		const auto owned = [&](GLuint texture) {
+			return std::find(begin(m_owned_textures), end(m_owned_textures),
+			                 texture) != end(m_owned_textures);
+		};
+
 		for (const auto &attachment : m_color_attachments) {
-			glBindTexture(GL_TEXTURE_2D, attachment);
+			if (!owned(attachment))
+				continue;
+			state.bindTexture(GL_TEXTURE_2D, attachment);
 			glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB8, width, height, 0, GL_RGB,
 			             GL_UNSIGNED_BYTE, nullptr);
 		}
 
-		if (m_depth_attachment) {
-			glBindTexture(GL_TEXTURE_2D, m_depth_attachment.value());
+		if (m_depth_attachment && owned(m_depth_attachment.value())) {
+			state.bindTexture(GL_TEXTURE_2D, m_depth_attachment.value());
 			glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT, width, height, 0,
 			             GL_DEPTH_COMPONENT, GL_FLOAT, nullptr);
 		}
 
-		if (m_depth_stencil_attachment) {
-			glBindTexture(GL_TEXTURE_2D, m_depth_stencil_attachment.value());
+		if (m_depth_stencil_attachment &&
+		    owned(m_depth_stencil_attachment.value())) {
+			state.bindTexture(GL_TEXTURE_2D,
+			                  m_depth_stencil_attachment.value());
 			glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH24_STENCIL8, width, height,
 			             0, GL_DEPTH_STENCIL, GL_UNSIGNED_INT_24_8, nullptr);
 		}
@@ -109,19 +199,19 @@ void Framebuffer::resize(int width, int height) {
 }
 
 void Framebuffer::blit(const Framebuffer *source, glm::ivec4 source_extents,
-                       glm::ivec4 destination_extents) {
+                       glm::ivec4 destination_extents, GLenum filter) {
 	source->bind(GL_READ_FRAMEBUFFER);
 	this->bind(GL_DRAW_FRAMEBUFFER);
 	glBlitFramebuffer(source_extents.x, source_extents.y, source_extents.z,
 	                  source_extents.w, destination_extents.x,
 	                  destination_extents.y, destination_extents.z,
-	                  destination_extents.w, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+	                  destination_extents.w, GL_COLOR_BUFFER_BIT, filter);
 }
 
 void Framebuffer::bindDepthAttachmentToSlot(GLuint slot) const {
 	assert(m_depth_attachment.has_value() &&
 	       "Framebuffer does not have a depth attachment to bind to slot");
 
-	glActiveTexture(GL_TEXTURE0 + slot);
-	glBindTexture(GL_TEXTURE_2D, m_depth_attachment.value());
+	StateCache::get().bindTexture(slot, GL_TEXTURE_2D,
+	                              m_depth_attachment.value());
 }
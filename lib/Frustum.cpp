@@ -0,0 +1,76 @@
+#include <algorithm>
+#include <glove/Frustum.h>
+
+auto Frustum::fromMatrix(const glm::mat4 &view_projection) -> Frustum {
+	// glm matrices are column major, so gather the rows first
+	std::array<glm::vec4, 4> rows;
+	for (int i = 0; i < 4; ++i) {
+		rows[i] = glm::vec4(view_projection[0][i], view_projection[1][i],
+		                    view_projection[2][i], view_projection[3][i]);
+	}
+
+	auto frustum      = Frustum{};
+	frustum.planes[0] = rows[3] + rows[0];
+	frustum.planes[1] = rows[3] - rows[0];
+	frustum.planes[2] = rows[3] + rows[1];
+	frustum.planes[3] = rows[3] - rows[1];
+	frustum.planes[4] = rows[3] + rows[2];
+	frustum.planes[5] = rows[3] - rows[2];
+
+	// Normalize, so that the planes give actual distances
+	for (auto &plane : frustum.planes) {
+		plane /= glm::length(glm::vec3(plane));
+	}
+
+	return frustum;
+}
+
+auto Frustum::intersectsSphere(const glm::vec3 &center, float radius) const
+    -> bool {
+	for (const auto &plane : planes) {
+		if (glm::dot(glm::vec3(plane), center) + plane.w < -radius)
+			return false;
+	}
+
+	return true;
+}
+
+auto Frustum::intersectsBox(const glm::vec3 &min, const glm::vec3 &max) const
+    -> bool {
+	for (const auto &plane : planes) {
+		// Test the corner furthest along the plane's normal
+		const auto corner = glm::vec3(plane.x > 0.0f ? max.x : min.x,
+		                              plane.y > 0.0f ? max.y : min.y,
+		                              plane.z > 0.0f ? max.z : min.z);
+		if (glm::dot(glm::vec3(plane), corner) + plane.w < 0.0f)
+			return false;
+	}
+
+	return true;
+}
+
+auto Frustum::intersects(const Bounds &bounds, const glm::mat4 &transform) const
+    -> bool {
+	// The sphere grows by the largest scale of the transform
+	const auto scale = std::max({glm::length(glm::vec3(transform[0])),
+	                             glm::length(glm::vec3(transform[1])),
+	                             glm::length(glm::vec3(transform[2]))});
+	const auto center = glm::vec3(transform * glm::vec4(bounds.center, 1.0f));
+	if (!intersectsSphere(center, bounds.radius * scale))
+		return false;
+
+	// Transform the box into a world space box around it, see "Transforming
+	// Axis-Aligned Bounding Boxes" by Arvo
+	const auto box_center = (bounds.min + bounds.max) * 0.5f;
+	const auto box_extent = (bounds.max - bounds.min) * 0.5f;
+
+	const auto world_center =
+	    glm::vec3(transform * glm::vec4(box_center, 1.0f));
+	auto world_extent = glm::vec3(0.0f);
+	for (int i = 0; i < 3; ++i) {
+		world_extent += glm::abs(glm::vec3(transform[i])) * box_extent[i];
+	}
+
+	return intersectsBox(world_center - world_extent,
+	                     world_center + world_extent);
+}
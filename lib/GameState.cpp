@@ -1,6 +1,22 @@
+#include <algorithm>
 #include <glove/GameState.h>
+#include <glove/GlTracer.h>
+#include <glove/StateCache.h>
 #include <utility>
 
+void TickClock::advance(float dt) {
+	m_ticks = std::min(m_ticks + dt / gTickLength,
+	                   static_cast<float>(gMaxTicksPerFrame));
+}
+
+auto TickClock::tick() -> bool {
+	if (m_ticks < 1.0f)
+		return false;
+
+	m_ticks -= 1.0f;
+	return true;
+}
+
 Core::Core(std::unique_ptr<IGameState> initial_state) {
 	m_gamestates.push_back(std::move(initial_state));
 
@@ -22,6 +38,9 @@ void Core::run() {
 
 	auto prev_time_point = std::chrono::steady_clock::now();
 
+	// The simulation runs in fixed ticks, independent of the frame rate
+	auto clock = TickClock();
+
 	// Main game loop
 	while (!m_window->pollEvents()) {
 		/*
@@ -45,10 +64,11 @@ void Core::run() {
 		const auto dt   = (now - prev_time_point).count() / 1000000000.0f;
 		prev_time_point = now;
 
-		while (!input->empty()) {
-			auto key = input->back();
-			input->pop_back();
-			trans = m_gamestates[current]->input(key);
+		clock.advance(dt);
+
+		// Oldest first, in the order they were received
+		while (const auto event = input->pop()) {
+			trans = m_gamestates[current]->input(event.value());
 			if (std::holds_alternative<Pop>(trans)) {
 				goto pop_state;
 			} else if (std::holds_alternative<Push>(trans)) {
@@ -58,18 +78,23 @@ void Core::run() {
 			} // Else None -> nop
 		}
 
-		trans = m_gamestates[current]->update(dt);
-		if (std::holds_alternative<Pop>(trans)) {
-			goto pop_state;
-		} else if (std::holds_alternative<Push>(trans)) {
-			goto push_state;
-		} else if (std::holds_alternative<Transition>(trans)) {
-			goto transition_state;
-		} // Else None -> nop
+		while (clock.tick()) {
+			trans = m_gamestates[current]->update(gTickLength);
+			if (std::holds_alternative<Pop>(trans)) {
+				goto pop_state;
+			} else if (std::holds_alternative<Push>(trans)) {
+				goto push_state;
+			} else if (std::holds_alternative<Transition>(trans)) {
+				goto transition_state;
+			} // Else None -> nop
+		}
 
-		m_gamestates[current]->render();
+		// What is left is how far the game is towards the next tick
+		m_gamestates[current]->render(clock.alpha());
 
 		m_window->swapBuffers();
+		StateCache::get().endFrame();
+		GlTracer::get().endFrame();
 
 		continue;
 
@@ -101,4 +126,5 @@ void Core::setupState() {
 	// Set properties from the manifest
 	const auto manifest = top->manifest();
 	m_window->setTitle(manifest.title);
+	m_window->setPresentMode(manifest.present_mode, manifest.frame_rate);
 }
@@ -0,0 +1,160 @@
+#include <glove/GlTracer.h>
+#include <sstream>
+#include <type_traits>
+
+/**
+ * @brief Counts of the current frame. Kept outside of the tracer, so the
+ * traced entry points can reach it without going through "get".
+ */
+static GlCallStats gFrame = {0, 0, 0, 0, 0, 0};
+
+/**
+ * @brief The entry point GLEW loaded, before it was swapped for a traced one.
+ */
+template <auto &Pointer>
+static std::remove_reference_t<decltype(Pointer)> gReal = nullptr;
+
+/**
+ * @brief Traced entry points, counting the call before forwarding it.
+ */
+template <typename Function> struct Traced;
+
+template <typename R, typename... Args>
+struct Traced<R(GLAPIENTRY *)(Args...)> {
+	template <auto &Pointer, size_t GlCallStats::*Counter>
+	static auto GLAPIENTRY call(Args... args) -> R {
+		gFrame.*Counter += 1;
+		return gReal<Pointer>(args...);
+	}
+};
+
+/**
+ * @brief Swap a GLEW entry point for a traced one, or back.
+ */
+template <auto &Pointer, size_t GlCallStats::*Counter>
+static void swap(bool enabled) {
+	using Function = std::remove_reference_t<decltype(Pointer)>;
+
+	if (enabled) {
+		gReal<Pointer> = Pointer;
+		Pointer = &Traced<Function>::template call<Pointer, Counter>;
+	} else {
+		Pointer = gReal<Pointer>;
+	}
+}
+
+// Uploads also count their bytes, so they are traced by hand
+
+static void GLAPIENTRY trace_buffer_data(GLenum target, GLsizeiptr size,
+                                         const void *data, GLenum usage) {
+	gFrame.uploads++;
+	gFrame.uploaded += data ? static_cast<size_t>(size) : 0;
+	gReal<glBufferData>(target, size, data, usage);
+}
+
+static void GLAPIENTRY trace_buffer_sub_data(GLenum target, GLintptr offset,
+                                             GLsizeiptr  size,
+                                             const void *data) {
+	gFrame.uploads++;
+	gFrame.uploaded += static_cast<size_t>(size);
+	gReal<glBufferSubData>(target, offset, size, data);
+}
+
+static void GLAPIENTRY trace_named_buffer_sub_data(GLuint buffer,
+                                                   GLintptr    offset,
+                                                   GLsizeiptr  size,
+                                                   const void *data) {
+	gFrame.uploads++;
+	gFrame.uploaded += static_cast<size_t>(size);
+	gReal<glNamedBufferSubData>(buffer, offset, size, data);
+}
+
+/**
+ * @brief Swap a GLEW entry point for one traced by hand, or back.
+ */
+template <auto &Pointer>
+static void swap(bool enabled,
+                 std::remove_reference_t<decltype(Pointer)> traced) {
+	if (enabled) {
+		gReal<Pointer> = Pointer;
+		Pointer        = traced;
+	} else {
+		Pointer = gReal<Pointer>;
+	}
+}
+
+/**
+ * @brief Swap all the traced entry points.
+ */
+static void swap_all(bool enabled) {
+	constexpr auto draws      = &GlCallStats::draws;
+	constexpr auto dispatches = &GlCallStats::dispatches;
+	constexpr auto binds      = &GlCallStats::binds;
+	constexpr auto uniforms   = &GlCallStats::uniforms;
+	constexpr auto uploads    = &GlCallStats::uploads;
+
+	swap<glDrawArraysInstanced, draws>(enabled);
+	swap<glDrawArraysIndirect, draws>(enabled);
+	swap<glDrawElementsBaseVertex, draws>(enabled);
+	swap<glDrawElementsInstanced, draws>(enabled);
+	swap<glDrawElementsInstancedBaseVertexBaseInstance, draws>(enabled);
+	swap<glDrawElementsIndirect, draws>(enabled);
+	swap<glMultiDrawElementsIndirect, draws>(enabled);
+	swap<glDispatchCompute, dispatches>(enabled);
+
+	swap<glUseProgram, binds>(enabled);
+	swap<glBindVertexArray, binds>(enabled);
+	swap<glBindBuffer, binds>(enabled);
+	swap<glBindBufferBase, binds>(enabled);
+	swap<glBindFramebuffer, binds>(enabled);
+	swap<glBindTextureUnit, binds>(enabled);
+
+	swap<glUniform1i, uniforms>(enabled);
+	swap<glUniform2i, uniforms>(enabled);
+	swap<glUniform3i, uniforms>(enabled);
+	swap<glUniform4i, uniforms>(enabled);
+	swap<glUniform1f, uniforms>(enabled);
+	swap<glUniform2f, uniforms>(enabled);
+	swap<glUniform3f, uniforms>(enabled);
+	swap<glUniform4f, uniforms>(enabled);
+	swap<glUniform1fv, uniforms>(enabled);
+	swap<glUniform4fv, uniforms>(enabled);
+	swap<glUniformMatrix4fv, uniforms>(enabled);
+
+	swap<glBufferData>(enabled, trace_buffer_data);
+	swap<glBufferSubData>(enabled, trace_buffer_sub_data);
+	swap<glNamedBufferSubData>(enabled, trace_named_buffer_sub_data);
+	swap<glTextureSubImage2D, uploads>(enabled);
+}
+
+GlTracer::GlTracer() : m_enabled(false), m_last_frame{0, 0, 0, 0, 0, 0} {}
+
+auto GlTracer::get() -> GlTracer & {
+	static GlTracer tracer;
+	return tracer;
+}
+
+void GlTracer::setEnabled(bool enabled) {
+	if (enabled == m_enabled)
+		return;
+
+	swap_all(enabled);
+	m_enabled = enabled;
+}
+
+void GlTracer::endFrame() {
+	m_last_frame = gFrame;
+	gFrame       = {0, 0, 0, 0, 0, 0};
+}
+
+auto GlTracer::report() const -> std::string {
+	std::ostringstream out;
+	out << "Draws:      " << m_last_frame.draws << "\n"
+	    << "Dispatches: " << m_last_frame.dispatches << "\n"
+	    << "Binds:      " << m_last_frame.binds << "\n"
+	    << "Uniforms:   " << m_last_frame.uniforms << "\n"
+	    << "Uploads:    " << m_last_frame.uploads << " ("
+	    << m_last_frame.uploaded << " bytes)\n";
+
+	return out.str();
+}
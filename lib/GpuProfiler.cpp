@@ -0,0 +1,130 @@
+#include <algorithm>
+#include <cassert>
+#include <glove/GpuProfiler.h>
+#include <iomanip>
+#include <numeric>
+#include <sstream>
+
+GpuProfiler::GpuProfiler() : m_frames{}, m_current(0) {}
+
+GpuProfiler::~GpuProfiler() {
+	for (auto &frame : m_frames)
+		glDeleteQueries(static_cast<GLsizei>(frame.queries.size()),
+		                frame.queries.data());
+}
+
+void GpuProfiler::begin(const std::string &name) {
+	const auto [scope, inserted] = m_scopes.try_emplace(name, m_stats.size());
+	if (inserted) {
+		m_stats.push_back({name, 0.0f, 0.0f, 0.0f});
+		m_histories.push_back({{}, 0, 0});
+	}
+
+	auto &frame = m_frames[m_current];
+	m_open.push_back(frame.samples.size());
+	frame.samples.push_back({scope->second, timestamp(), 0});
+}
+
+void GpuProfiler::end() {
+	assert(!m_open.empty() && "Ended a scope that was never begun");
+
+	auto &frame = m_frames[m_current];
+	frame.samples[m_open.back()].end = timestamp();
+	m_open.pop_back();
+}
+
+void GpuProfiler::endFrame() {
+	assert(m_open.empty() && "A scope is still open at the end of the frame");
+
+	m_frames[m_current].pending = !m_frames[m_current].samples.empty();
+	m_current                   = (m_current + 1) % m_frames.size();
+
+	// Walk from the oldest frame to the newest. Timestamps are written in
+	// order, so a frame is done once its last query is.
+	for (size_t i = 0; i < m_frames.size(); ++i) {
+		auto &frame = m_frames[(m_current + i) % m_frames.size()];
+		if (!frame.pending)
+			continue;
+
+		GLint available = GL_FALSE;
+		glGetQueryObjectiv(frame.queries[frame.used - 1],
+		                   GL_QUERY_RESULT_AVAILABLE, &available);
+		if (available == GL_FALSE)
+			break;
+
+		read(frame);
+	}
+
+	// The ring is full, the oldest frame is dropped rather than waited for
+	auto &frame   = m_frames[m_current];
+	frame.pending = false;
+	frame.used    = 0;
+	frame.samples.clear();
+}
+
+auto GpuProfiler::report() const -> std::string {
+	size_t width = 0;
+	for (const auto &stats : m_stats)
+		width = std::max(width, stats.name.size());
+
+	std::ostringstream out;
+	out << std::fixed << std::setprecision(2);
+	for (const auto &stats : m_stats)
+		out << std::left << std::setw(static_cast<int>(width)) << stats.name
+		    << std::right << "  avg " << std::setw(6) << stats.average
+		    << " ms  max " << std::setw(6) << stats.maximum << " ms\n";
+
+	return out.str();
+}
+
+auto GpuProfiler::timestamp() -> size_t {
+	auto &frame = m_frames[m_current];
+	if (frame.used == frame.queries.size()) {
+		GLuint query;
+		glGenQueries(1, &query);
+		frame.queries.push_back(query);
+	}
+
+	glQueryCounter(frame.queries[frame.used], GL_TIMESTAMP);
+
+	return frame.used++;
+}
+
+void GpuProfiler::read(Frame &frame) {
+	std::vector<GLuint64> timestamps(frame.used);
+	for (size_t i = 0; i < frame.used; ++i)
+		glGetQueryObjectui64v(frame.queries[i], GL_QUERY_RESULT,
+		                      &timestamps[i]);
+	frame.pending = false;
+
+	// Sum the runs of every scope, then add the sums to the histories
+	std::vector<float> times(m_stats.size(), -1.0f);
+	for (const auto &sample : frame.samples) {
+		const auto nanoseconds =
+		    timestamps[sample.end] - timestamps[sample.begin];
+		times[sample.scope] = std::max(times[sample.scope], 0.0f) +
+		                      static_cast<float>(nanoseconds) / 1000000.0f;
+	}
+
+	for (size_t scope = 0; scope < times.size(); ++scope) {
+		if (times[scope] < 0.0f)
+			continue;
+
+		auto &     history = m_histories[scope];
+		const auto slot    = history.next;
+
+		history.times[slot] = times[scope];
+		history.next        = (slot + 1) % gGpuProfilerWindow;
+		history.count       = std::min(history.count + 1, gGpuProfilerWindow);
+
+		// The ring is only partly filled until the window has passed
+		const auto first = std::begin(history.times);
+		const auto last  = first + static_cast<ptrdiff_t>(history.count);
+
+		auto &stats   = m_stats[scope];
+		stats.average = std::accumulate(first, last, 0.0f) /
+		                static_cast<float>(history.count);
+		stats.maximum = *std::max_element(first, last);
+		stats.latest  = times[scope];
+	}
+}
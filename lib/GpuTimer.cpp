@@ -0,0 +1,40 @@
+#include <glove/GpuTimer.h>
+
+GpuTimer::GpuTimer() : m_pending{}, m_next(0), m_latest(std::nullopt) {
+	glGenQueries(static_cast<GLsizei>(m_queries.size()), m_queries.data());
+}
+
+GpuTimer::~GpuTimer() {
+	glDeleteQueries(static_cast<GLsizei>(m_queries.size()), m_queries.data());
+}
+
+void GpuTimer::begin() {
+	// The ring is full, the oldest result is dropped rather than waited for
+	m_pending[m_next] = false;
+	glBeginQuery(GL_TIME_ELAPSED, m_queries[m_next]);
+}
+
+void GpuTimer::end() {
+	glEndQuery(GL_TIME_ELAPSED);
+	m_pending[m_next] = true;
+	m_next            = (m_next + 1) % m_queries.size();
+
+	// Walk from the oldest query to the newest, so the last one read is the
+	// most recent
+	for (size_t i = 0; i < m_queries.size(); ++i) {
+		const auto index = (m_next + i) % m_queries.size();
+		if (!m_pending[index])
+			continue;
+
+		GLint available = GL_FALSE;
+		glGetQueryObjectiv(m_queries[index], GL_QUERY_RESULT_AVAILABLE,
+		                   &available);
+		if (available == GL_FALSE)
+			break;
+
+		GLuint64 nanoseconds = 0;
+		glGetQueryObjectui64v(m_queries[index], GL_QUERY_RESULT, &nanoseconds);
+		m_pending[index] = false;
+		m_latest         = static_cast<float>(nanoseconds) / 1000000.0f;
+	}
+}
@@ -0,0 +1,102 @@
+#include <cstring>
+#include <glove/MappedFile.h>
+
+#ifdef _WIN32
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile(const std::byte *data, size_t size, void *handle)
+    : m_data(data), m_size(size), m_handle(handle) {}
+
+#ifdef _WIN32
+
+auto MappedFile::open(const std::string &path) -> std::unique_ptr<MappedFile> {
+	HANDLE file =
+	    CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+	                OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+		return nullptr;
+
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(file, &size) || size.QuadPart == 0) {
+		CloseHandle(file);
+		return nullptr;
+	}
+
+	HANDLE mapping =
+	    CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	// The mapping keeps the file alive on its own
+	CloseHandle(file);
+	if (mapping == nullptr)
+		return nullptr;
+
+	const auto *data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	if (data == nullptr) {
+		CloseHandle(mapping);
+		return nullptr;
+	}
+
+	return std::unique_ptr<MappedFile>(
+	    new MappedFile(static_cast<const std::byte *>(data),
+	                   static_cast<size_t>(size.QuadPart), mapping));
+}
+
+MappedFile::~MappedFile() {
+	UnmapViewOfFile(m_data);
+	CloseHandle(m_handle);
+}
+
+#else
+
+auto MappedFile::open(const std::string &path) -> std::unique_ptr<MappedFile> {
+	const int fd = ::open(path.c_str(), O_RDONLY);
+	if (fd < 0)
+		return nullptr;
+
+	struct stat info {};
+	if (fstat(fd, &info) != 0 || info.st_size == 0) {
+		::close(fd);
+		return nullptr;
+	}
+
+	const auto size = static_cast<size_t>(info.st_size);
+	void *     data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+	// The mapping keeps the file alive on its own
+	::close(fd);
+	if (data == MAP_FAILED)
+		return nullptr;
+
+	return std::unique_ptr<MappedFile>(
+	    new MappedFile(static_cast<const std::byte *>(data), size, nullptr));
+}
+
+MappedFile::~MappedFile() {
+	munmap(const_cast<std::byte *>(m_data), m_size);
+}
+
+#endif
+
+auto hashBytes(const std::byte *data, size_t size) -> uint64_t {
+	constexpr uint64_t prime = 0x100000001b3ull;
+	uint64_t           hash  = 0xcbf29ce484222325ull;
+
+	// Consume whole words first, then the remaining tail byte by byte
+	size_t i = 0;
+	for (; i + sizeof(uint64_t) <= size; i += sizeof(uint64_t)) {
+		uint64_t word;
+		std::memcpy(&word, data + i, sizeof(uint64_t));
+		hash = (hash ^ word) * prime;
+	}
+	for (; i < size; ++i) {
+		hash = (hash ^ static_cast<uint64_t>(data[i])) * prime;
+	}
+
+	return hash;
+}
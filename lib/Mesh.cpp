@@ -0,0 +1,43 @@
+#include <glove/Mesh.h>
+
+/**
+ * @brief Compute the bounds of some points.
+ * @param count Number of points.
+ * @param point Function returning the i-th point.
+ */
+template <typename PointFn>
+static auto bound_points(size_t count, PointFn point) -> Bounds {
+	if (count == 0)
+		return {glm::vec3(0.0f), glm::vec3(0.0f), glm::vec3(0.0f), 0.0f};
+
+	auto bounds = Bounds{point(0), point(0), glm::vec3(0.0f), 0.0f};
+	for (size_t i = 1; i < count; ++i) {
+		bounds.min = glm::min(bounds.min, point(i));
+		bounds.max = glm::max(bounds.max, point(i));
+	}
+
+	// Center the sphere on the box, and grow it to fit the points, which is
+	// usually tighter than the sphere around the box
+	bounds.center = (bounds.min + bounds.max) * 0.5f;
+	for (size_t i = 0; i < count; ++i) {
+		bounds.radius =
+		    std::max(bounds.radius, glm::distance(bounds.center, point(i)));
+	}
+
+	return bounds;
+}
+
+auto computeBounds(const std::vector<Vertex3DNormTex> &vertices) -> Bounds {
+	return bound_points(vertices.size(), [&](size_t i) -> const glm::vec3 & {
+		return vertices[i].pos;
+	});
+}
+
+auto computeBounds(const MeshData &mesh, const Submesh &submesh) -> Bounds {
+	const auto point = [&](size_t i) -> const glm::vec3 & {
+		return mesh.vertices[mesh.indices[submesh.index_offset + i] +
+		                     submesh.base_vertex]
+		    .pos;
+	};
+	return bound_points(submesh.index_count, point);
+}
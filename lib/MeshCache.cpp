@@ -0,0 +1,289 @@
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <glove/MeshCache.h>
+#include <iostream>
+#include <optional>
+#include <type_traits>
+
+static_assert(std::is_trivially_copyable_v<Vertex3DNormTex>);
+static_assert(std::is_trivially_copyable_v<Submesh>);
+static_assert(std::is_trivially_copyable_v<Bounds>);
+static_assert(std::is_trivially_copyable_v<MeshOptimizerStats>);
+
+static constexpr char gCacheMagic[8] = {'G', 'L', 'V', 'M',
+                                       'E', 'S', 'H', '\0'};
+
+/**
+ * @brief Header at the very start of every cache file.
+ */
+struct CacheHeader {
+	char     magic[8];       ///< Always "GLVMESH\0".
+	uint32_t version;        ///< "MeshCache::version" of the writer.
+	uint32_t vertex_stride;  ///< Size of one vertex in bytes.
+	uint64_t source_size;    ///< Size of the source file in bytes.
+	int64_t  source_time;    ///< Modification time of the source file.
+	uint64_t source_hash;    ///< Hash of the source file contents.
+	uint32_t vertex_count;   ///< Number of vertices following the header.
+	uint32_t index_count;    ///< Number of indices following the vertices.
+	uint32_t submesh_count;  ///< Number of submeshes following the indices.
+	uint32_t material_count; ///< Number of materials following the submeshes.
+	uint32_t material_size;  ///< Size of all the materials in bytes.
+	uint32_t reserved;       ///< Padding, always zero.
+	Bounds   bounds;         ///< Bounds of the whole mesh.
+	MeshOptimizerStats
+	    optimizer_stats; ///< Vertex cache efficiency of the optimized mesh.
+};
+
+static_assert(sizeof(CacheHeader) % alignof(Vertex3DNormTex) == 0);
+
+/**
+ * @brief Get the modification time of a file in an opaque but comparable
+ * format.
+ */
+static auto modification_time(const std::string &path) -> int64_t {
+	std::error_code ec;
+	const auto      time = std::filesystem::last_write_time(path, ec);
+	return ec ? 0 : static_cast<int64_t>(time.time_since_epoch().count());
+}
+
+/**
+ * @brief Compute the expected size of a cache file from its header.
+ */
+static auto expected_size(const CacheHeader &header) -> size_t {
+	return sizeof(CacheHeader) +
+	       header.vertex_count * sizeof(Vertex3DNormTex) +
+	       header.index_count * sizeof(GLuint) +
+	       header.submesh_count * sizeof(Submesh) + header.material_size;
+}
+
+/**
+ * @brief Serialize materials as a sequence of records containing the name
+ * length, the name, the diffuse color, the diffuse map length and the diffuse
+ * map.
+ */
+static auto serialize_materials(const std::vector<Material> &materials)
+    -> std::string {
+	std::string bytes;
+
+	const auto append = [&](const void *data, size_t size) {
+		bytes.append(static_cast<const char *>(data), size);
+	};
+	const auto append_string = [&](const std::string &string) {
+		const auto length = static_cast<uint32_t>(string.size());
+		append(&length, sizeof(length));
+		append(string.data(), string.size());
+	};
+
+	for (const auto &material : materials) {
+		append_string(material.name);
+		append(&material.diffuse_color, sizeof(material.diffuse_color));
+		append_string(material.diffuse_map);
+	}
+
+	return bytes;
+}
+
+/**
+ * @brief Deserialize materials written by "serialize_materials", checking
+ * every record against the end of the bytes.
+ * @return The materials, or nothing if the bytes are not exactly count records.
+ */
+static auto deserialize_materials(const char *it, const char *end,
+                                  uint32_t count)
+    -> std::optional<std::vector<Material>> {
+	// Every record is at least two lengths and a color, so a corrupt count
+	// is caught before it is allocated
+	constexpr auto min_record = 2 * sizeof(uint32_t) + sizeof(glm::vec4);
+	if (count > static_cast<size_t>(end - it) / min_record)
+		return std::nullopt;
+
+	const auto read = [&](void *data, size_t size) {
+		if (static_cast<size_t>(end - it) < size)
+			return false;
+		std::memcpy(data, it, size);
+		it += size;
+		return true;
+	};
+	const auto read_string = [&](std::string &string) {
+		uint32_t length;
+		if (!read(&length, sizeof(length)) ||
+		    static_cast<size_t>(end - it) < length)
+			return false;
+		string.assign(it, length);
+		it += length;
+		return true;
+	};
+
+	std::vector<Material> materials(count);
+	for (auto &material : materials) {
+		if (!read_string(material.name) ||
+		    !read(&material.diffuse_color, sizeof(material.diffuse_color)) ||
+		    !read_string(material.diffuse_map))
+			return std::nullopt;
+	}
+
+	// Bytes left over mean the records are not what was written either
+	if (it != end)
+		return std::nullopt;
+
+	return materials;
+}
+
+MeshCache::MeshCache(std::unique_ptr<MappedFile> file,
+                     std::vector<Material>       materials)
+    : m_file(std::move(file)), m_materials(std::move(materials)) {}
+
+auto MeshCache::cachePath(const std::string &source_path) -> std::string {
+	return source_path + ".meshcache";
+}
+
+auto MeshCache::load(const std::string &source_path)
+    -> std::unique_ptr<MeshCache> {
+	std::error_code ec;
+	const auto      source_size = std::filesystem::file_size(source_path, ec);
+	if (ec)
+		return nullptr;
+
+	auto file = MappedFile::open(cachePath(source_path));
+	if (file == nullptr || file->size() < sizeof(CacheHeader))
+		return nullptr;
+
+	CacheHeader header;
+	std::memcpy(&header, file->data(), sizeof(CacheHeader));
+
+	// Written by an incompatible version of glove, or truncated
+	if (std::memcmp(header.magic, gCacheMagic, sizeof(gCacheMagic)) != 0 ||
+	    header.version != version ||
+	    header.vertex_stride != sizeof(Vertex3DNormTex) ||
+	    file->size() != expected_size(header))
+		return nullptr;
+
+	// The materials are stored last. Their sizes are only known once read,
+	// so they are read now, and a corrupt table rejects the cache as well.
+	const auto *end =
+	    reinterpret_cast<const char *>(file->data()) + file->size();
+	auto materials = deserialize_materials(end - header.material_size, end,
+	                                       header.material_count);
+	if (!materials)
+		return nullptr;
+
+	// The source has changed since the cache was written
+	if (header.source_size != source_size)
+		return nullptr;
+
+	// Only hash the source if the cheap check is inconclusive. Copying the
+	// resources around changes the modification time, but not the contents.
+	if (header.source_time != modification_time(source_path)) {
+		const auto source = MappedFile::open(source_path);
+		if (source == nullptr ||
+		    hashBytes(source->data(), source->size()) != header.source_hash)
+			return nullptr;
+	}
+
+	return std::unique_ptr<MeshCache>(
+	    new MeshCache(std::move(file), std::move(materials.value())));
+}
+
+auto MeshCache::store(const std::string &source_path, const MeshData &mesh)
+    -> bool {
+	const auto source = MappedFile::open(source_path);
+	if (source == nullptr)
+		return false;
+
+	CacheHeader header = {};
+	std::memcpy(header.magic, gCacheMagic, sizeof(gCacheMagic));
+	header.version       = version;
+	header.vertex_stride = sizeof(Vertex3DNormTex);
+	header.source_size   = source->size();
+	header.source_time   = modification_time(source_path);
+	header.source_hash   = hashBytes(source->data(), source->size());
+	header.vertex_count  = static_cast<uint32_t>(mesh.vertices.size());
+	header.index_count   = static_cast<uint32_t>(mesh.indices.size());
+	header.submesh_count = static_cast<uint32_t>(mesh.submeshes.size());
+
+	const auto materials   = serialize_materials(mesh.materials);
+	header.material_count  = static_cast<uint32_t>(mesh.materials.size());
+	header.material_size   = static_cast<uint32_t>(materials.size());
+	header.bounds          = mesh.bounds;
+	header.optimizer_stats = mesh.optimizer_stats;
+
+	// Write to a temporary file and move it into place, so that a reader
+	// never observes a half written cache
+	const auto path      = cachePath(source_path);
+	const auto temp_path = path + ".tmp";
+	{
+		std::ofstream file(temp_path, std::ofstream::binary);
+		if (!file.is_open()) {
+			std::cout << "Warning: Failed to write mesh cache: " << path
+			          << std::endl;
+			return false;
+		}
+
+		file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+		file.write(reinterpret_cast<const char *>(mesh.vertices.data()),
+		           mesh.vertices.size() * sizeof(Vertex3DNormTex));
+		file.write(reinterpret_cast<const char *>(mesh.indices.data()),
+		           mesh.indices.size() * sizeof(GLuint));
+		file.write(reinterpret_cast<const char *>(mesh.submeshes.data()),
+		           mesh.submeshes.size() * sizeof(Submesh));
+		file.write(materials.data(), materials.size());
+
+		if (!file.good())
+			return false;
+	}
+
+	std::error_code ec;
+	std::filesystem::rename(temp_path, path, ec);
+	return !ec;
+}
+
+auto MeshCache::vertices() const -> const Vertex3DNormTex * {
+	return reinterpret_cast<const Vertex3DNormTex *>(m_file->data() +
+	                                                  sizeof(CacheHeader));
+}
+
+auto MeshCache::vertexCount() const -> size_t {
+	return reinterpret_cast<const CacheHeader *>(m_file->data())
+	    ->vertex_count;
+}
+
+auto MeshCache::indices() const -> const GLuint * {
+	return reinterpret_cast<const GLuint *>(vertices() + vertexCount());
+}
+
+auto MeshCache::indexCount() const -> size_t {
+	return reinterpret_cast<const CacheHeader *>(m_file->data())->index_count;
+}
+
+auto MeshCache::submeshes() const -> std::vector<Submesh> {
+	const auto count =
+	    reinterpret_cast<const CacheHeader *>(m_file->data())->submesh_count;
+	const auto *first =
+	    reinterpret_cast<const Submesh *>(indices() + indexCount());
+	return std::vector<Submesh>(first, first + count);
+}
+
+auto MeshCache::materials() const -> const std::vector<Material> & {
+	return m_materials;
+}
+
+auto MeshCache::bounds() const -> Bounds {
+	return reinterpret_cast<const CacheHeader *>(m_file->data())->bounds;
+}
+
+auto MeshCache::optimizerStats() const -> MeshOptimizerStats {
+	return reinterpret_cast<const CacheHeader *>(m_file->data())
+	    ->optimizer_stats;
+}
+
+auto MeshCache::toMeshData() const -> MeshData {
+	MeshData mesh;
+	mesh.vertices.assign(vertices(), vertices() + vertexCount());
+	mesh.indices.assign(indices(), indices() + indexCount());
+	mesh.submeshes       = submeshes();
+	mesh.materials       = materials();
+	mesh.bounds          = bounds();
+	mesh.optimizer_stats = optimizerStats();
+	return mesh;
+}
@@ -0,0 +1,419 @@
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <glove/MappedFile.h>
+#include <glove/MeshOptimizer.h>
+#include <limits>
+#include <map>
+#include <numeric>
+#include <unordered_map>
+
+/**
+ * @brief Hash a vertex by its bytes.
+ */
+struct VertexBitsHash {
+	auto operator()(const Vertex3DNormTex &vertex) const -> size_t {
+		return static_cast<size_t>(hashBytes(
+		    reinterpret_cast<const std::byte *>(&vertex), sizeof(vertex)));
+	}
+};
+
+/**
+ * @brief Compare vertices by their bytes, so that e.g. -0.0 and 0.0 are kept
+ * apart like the GPU would.
+ */
+struct VertexBitsEqual {
+	auto operator()(const Vertex3DNormTex &a, const Vertex3DNormTex &b) const
+	    -> bool {
+		return std::memcmp(&a, &b, sizeof(Vertex3DNormTex)) == 0;
+	}
+};
+
+/**
+ * @brief Find the number of vertices a triangle list refers to.
+ */
+static auto referenced_vertex_count(const std::vector<GLuint> &indices)
+    -> size_t {
+	return indices.empty()
+	           ? 0
+	           : *std::max_element(begin(indices), end(indices)) + size_t(1);
+}
+
+/**
+ * @brief Pick the next vertex to fan around in Tipsify.
+ * Prefers the vertex among the candidates that has been in the cache the
+ * longest, as long as all its remaining triangles fit in the cache. Falls back
+ * to the recently emitted vertices, and finally to any vertex with triangles
+ * left.
+ */
+static auto tipsify_next_vertex(const std::vector<GLuint> & candidates,
+                                const std::vector<uint32_t> &live,
+                                const std::vector<size_t> &  cache_time,
+                                size_t timestamp, size_t cache_size,
+                                std::vector<GLuint> &dead_end, size_t &cursor)
+    -> int64_t {
+	int64_t best     = -1;
+	int64_t priority = -1;
+	for (const auto vertex : candidates) {
+		if (live[vertex] == 0)
+			continue;
+
+		// Would emitting all the vertex' triangles keep it in the cache?
+		const auto age             = timestamp - cache_time[vertex];
+		int64_t    vertex_priority = 0;
+		if (age + 2 * live[vertex] <= cache_size)
+			vertex_priority = static_cast<int64_t>(age);
+
+		if (vertex_priority > priority) {
+			priority = vertex_priority;
+			best     = vertex;
+		}
+	}
+
+	if (best != -1)
+		return best;
+
+	while (!dead_end.empty()) {
+		const auto vertex = dead_end.back();
+		dead_end.pop_back();
+		if (live[vertex] > 0)
+			return vertex;
+	}
+
+	for (; cursor < live.size(); ++cursor) {
+		if (live[cursor] > 0)
+			return static_cast<int64_t>(cursor++);
+	}
+
+	return -1;
+}
+
+auto analyzeVertexCache(const std::vector<GLuint> &indices, size_t vertex_count,
+                        size_t cache_size) -> VertexCacheStats {
+	if (indices.empty())
+		return {0.0f, 0.0f};
+
+	// A vertex is in the cache if fewer than cache_size misses happened since
+	// it was last loaded
+	std::vector<size_t> cache_time(vertex_count, 0);
+	std::vector<bool>   referenced(vertex_count, false);
+	size_t              timestamp = cache_size + 1;
+	size_t              misses    = 0;
+
+	for (const auto index : indices) {
+		referenced[index] = true;
+		if (timestamp - cache_time[index] > cache_size) {
+			cache_time[index] = timestamp++;
+			misses++;
+		}
+	}
+
+	const auto unique = std::count(begin(referenced), end(referenced), true);
+	return {static_cast<float>(misses) / static_cast<float>(indices.size() / 3),
+	        static_cast<float>(misses) / static_cast<float>(unique)};
+}
+
+void weldVertices(std::vector<Vertex3DNormTex> &vertices,
+                  std::vector<GLuint> &         indices) {
+	std::unordered_map<Vertex3DNormTex, GLuint, VertexBitsHash, VertexBitsEqual>
+	    unique;
+	unique.reserve(vertices.size());
+
+	std::vector<Vertex3DNormTex> welded;
+	welded.reserve(vertices.size());
+
+	for (auto &index : indices) {
+		const auto [it, inserted] = unique.try_emplace(
+		    vertices[index], static_cast<GLuint>(welded.size()));
+		if (inserted)
+			welded.push_back(vertices[index]);
+		index = it->second;
+	}
+
+	vertices = std::move(welded);
+}
+
+void optimizeVertexCache(std::vector<GLuint> &indices, size_t vertex_count,
+                         size_t cache_size) {
+	const auto triangle_count = indices.size() / 3;
+	if (triangle_count == 0)
+		return;
+
+	// Vertex to triangle adjacency, stored as one array with offsets
+	std::vector<uint32_t> live(vertex_count, 0);
+	for (const auto index : indices)
+		live[index]++;
+
+	std::vector<size_t> offsets(vertex_count + 1, 0);
+	std::partial_sum(begin(live), end(live), begin(offsets) + 1);
+
+	std::vector<uint32_t> adjacency(indices.size());
+	{
+		auto fill = offsets;
+		for (size_t i = 0; i < indices.size(); ++i)
+			adjacency[fill[indices[i]]++] = static_cast<uint32_t>(i / 3);
+	}
+
+	std::vector<size_t> cache_time(vertex_count, 0);
+	std::vector<bool>   emitted(triangle_count, false);
+	std::vector<GLuint> dead_end;
+	std::vector<GLuint> candidates;
+	std::vector<GLuint> result;
+	result.reserve(indices.size());
+
+	size_t  timestamp = cache_size + 1;
+	size_t  cursor    = 1;
+	int64_t fanning   = 0;
+
+	while (fanning >= 0) {
+		candidates.clear();
+
+		// Emit every remaining triangle around the fanning vertex
+		for (auto i = offsets[fanning]; i < offsets[fanning + 1]; ++i) {
+			const auto triangle = adjacency[i];
+			if (emitted[triangle])
+				continue;
+
+			for (size_t k = 0; k < 3; ++k) {
+				const auto vertex = indices[triangle * 3 + k];
+				result.push_back(vertex);
+				dead_end.push_back(vertex);
+				candidates.push_back(vertex);
+				live[vertex]--;
+
+				if (timestamp - cache_time[vertex] > cache_size)
+					cache_time[vertex] = timestamp++;
+			}
+
+			emitted[triangle] = true;
+		}
+
+		fanning = tipsify_next_vertex(candidates, live, cache_time, timestamp,
+		                              cache_size, dead_end, cursor);
+	}
+
+	assert(result.size() == indices.size());
+	indices = std::move(result);
+}
+
+void optimizeOverdraw(std::vector<GLuint> &                indices,
+                      const std::vector<Vertex3DNormTex> &vertices,
+                      size_t                              cache_size) {
+	const auto triangle_count = indices.size() / 3;
+	if (triangle_count == 0)
+		return;
+
+	// Start a new cluster wherever all three vertices of a triangle miss the
+	// cache. Moving clusters around there does not hurt the cache efficiency.
+	std::vector<size_t> clusters;
+	{
+		std::vector<size_t> cache_time(vertices.size(), 0);
+		size_t              timestamp = cache_size + 1;
+
+		for (size_t i = 0; i < triangle_count; ++i) {
+			size_t misses = 0;
+			for (size_t k = 0; k < 3; ++k) {
+				const auto vertex = indices[i * 3 + k];
+				if (timestamp - cache_time[vertex] > cache_size) {
+					cache_time[vertex] = timestamp++;
+					misses++;
+				}
+			}
+
+			if (i == 0 || misses == 3)
+				clusters.push_back(i);
+		}
+	}
+
+	// Area weighted centroid of the whole mesh
+	auto centroid = glm::vec3(0.0f);
+	auto area     = 0.0f;
+	for (size_t i = 0; i < triangle_count; ++i) {
+		const auto &a = vertices[indices[i * 3 + 0]].pos;
+		const auto &b = vertices[indices[i * 3 + 1]].pos;
+		const auto &c = vertices[indices[i * 3 + 2]].pos;
+
+		const auto triangle_area = glm::length(glm::cross(b - a, c - a));
+		centroid += (a + b + c) * (triangle_area / 3.0f);
+		area += triangle_area;
+	}
+	if (area > 0.0f)
+		centroid /= area;
+
+	// Sort key of each cluster is how much its average normal faces away from
+	// the center of the mesh
+	std::vector<float> sort_keys(clusters.size());
+	for (size_t j = 0; j < clusters.size(); ++j) {
+		const auto first = clusters[j];
+		const auto last =
+		    j + 1 < clusters.size() ? clusters[j + 1] : triangle_count;
+
+		auto cluster_centroid = glm::vec3(0.0f);
+		auto cluster_normal   = glm::vec3(0.0f);
+		auto cluster_area     = 0.0f;
+		for (auto i = first; i < last; ++i) {
+			const auto &a = vertices[indices[i * 3 + 0]].pos;
+			const auto &b = vertices[indices[i * 3 + 1]].pos;
+			const auto &c = vertices[indices[i * 3 + 2]].pos;
+
+			const auto normal        = glm::cross(b - a, c - a);
+			const auto triangle_area = glm::length(normal);
+			cluster_centroid += (a + b + c) * (triangle_area / 3.0f);
+			cluster_normal += normal;
+			cluster_area += triangle_area;
+		}
+
+		if (cluster_area > 0.0f)
+			cluster_centroid /= cluster_area;
+		if (glm::length(cluster_normal) > 0.0f)
+			cluster_normal = glm::normalize(cluster_normal);
+
+		sort_keys[j] = glm::dot(cluster_centroid - centroid, cluster_normal);
+	}
+
+	std::vector<size_t> order(clusters.size());
+	std::iota(begin(order), end(order), 0);
+	std::stable_sort(begin(order), end(order), [&](size_t a, size_t b) {
+		return sort_keys[a] > sort_keys[b];
+	});
+
+	std::vector<GLuint> result;
+	result.reserve(indices.size());
+	for (const auto j : order) {
+		const auto first = clusters[j];
+		const auto last =
+		    j + 1 < clusters.size() ? clusters[j + 1] : triangle_count;
+		result.insert(end(result), begin(indices) + first * 3,
+		              begin(indices) + last * 3);
+	}
+
+	indices = std::move(result);
+}
+
+void optimizeVertexFetch(std::vector<Vertex3DNormTex> &vertices,
+                         std::vector<GLuint> &         indices) {
+	constexpr auto unused = std::numeric_limits<GLuint>::max();
+
+	std::vector<GLuint>          remap(vertices.size(), unused);
+	std::vector<Vertex3DNormTex> result;
+	result.reserve(vertices.size());
+
+	for (auto &index : indices) {
+		if (remap[index] == unused) {
+			remap[index] = static_cast<GLuint>(result.size());
+			result.push_back(vertices[index]);
+		}
+		index = remap[index];
+	}
+
+	vertices = std::move(result);
+}
+
+/**
+ * @brief Get the indices of a mesh with the base vertices applied, as if the
+ * whole mesh was drawn at once.
+ */
+static auto absolute_indices(const MeshData &mesh) -> std::vector<GLuint> {
+	std::vector<GLuint> indices;
+	indices.reserve(mesh.indices.size());
+	for (const auto &submesh : mesh.submeshes) {
+		for (size_t i = 0; i < submesh.index_count; ++i) {
+			indices.push_back(mesh.indices[submesh.index_offset + i] +
+			                  submesh.base_vertex);
+		}
+	}
+	return indices;
+}
+
+auto optimizeMesh(MeshData &mesh) -> MeshOptimizerStats {
+	if (mesh.submeshes.empty()) {
+		mesh.submeshes.push_back(
+		    {0, static_cast<uint32_t>(mesh.indices.size()), 0, 0});
+	}
+
+	auto stats = MeshOptimizerStats{};
+	{
+		const auto indices = absolute_indices(mesh);
+		stats.before =
+		    analyzeVertexCache(indices, referenced_vertex_count(indices));
+	}
+
+	// Submeshes sharing a base vertex share a segment of the vertex array,
+	// which ends where the next segment begins
+	std::map<uint32_t, std::vector<size_t>> segments;
+	for (size_t i = 0; i < mesh.submeshes.size(); ++i)
+		segments[mesh.submeshes[i].base_vertex].push_back(i);
+
+	MeshData result;
+	result.vertices.reserve(mesh.vertices.size());
+	result.indices.reserve(mesh.indices.size());
+	result.submeshes = mesh.submeshes;
+	result.materials = std::move(mesh.materials);
+
+	for (auto it = begin(segments); it != end(segments); ++it) {
+		const auto first = it->first;
+		const auto last  = std::next(it) != end(segments)
+		                       ? std::next(it)->first
+		                       : static_cast<uint32_t>(mesh.vertices.size());
+
+		std::vector<Vertex3DNormTex> vertices(begin(mesh.vertices) + first,
+		                                      begin(mesh.vertices) + last);
+
+		// Gather the indices of all the submeshes in the segment
+		std::vector<GLuint> indices;
+		for (const auto s : it->second) {
+			const auto &submesh = mesh.submeshes[s];
+			indices.insert(end(indices),
+			               begin(mesh.indices) + submesh.index_offset,
+			               begin(mesh.indices) + submesh.index_offset +
+			                   submesh.index_count);
+		}
+		assert(referenced_vertex_count(indices) <= vertices.size() &&
+		       "Submesh indices exceed the vertices of their base vertex");
+
+		weldVertices(vertices, indices);
+
+		// Triangles are only reordered within each submesh
+		size_t offset = 0;
+		for (const auto s : it->second) {
+			const auto count = mesh.submeshes[s].index_count;
+
+			std::vector<GLuint> submesh_indices(
+			    begin(indices) + offset, begin(indices) + offset + count);
+			optimizeVertexCache(submesh_indices, vertices.size());
+			optimizeOverdraw(submesh_indices, vertices);
+			std::copy(begin(submesh_indices), end(submesh_indices),
+			          begin(indices) + offset);
+
+			result.submeshes[s].index_offset =
+			    static_cast<uint32_t>(result.indices.size() + offset);
+			result.submeshes[s].base_vertex =
+			    static_cast<uint32_t>(result.vertices.size());
+			result.submeshes[s].lod_count = 0;
+			offset += count;
+		}
+
+		optimizeVertexFetch(vertices, indices);
+
+		result.vertices.insert(end(result.vertices), begin(vertices),
+		                       end(vertices));
+		result.indices.insert(end(result.indices), begin(indices),
+		                      end(indices));
+	}
+
+	result.bounds = computeBounds(result.vertices);
+	mesh          = std::move(result);
+
+	{
+		const auto indices = absolute_indices(mesh);
+		stats.after = analyzeVertexCache(indices, mesh.vertices.size());
+	}
+	mesh.optimizer_stats = stats;
+
+	return stats;
+}
+
+std::ostream &operator<<(std::ostream &os, const MeshOptimizerStats &stats) {
+	return os << "ACMR " << stats.before.acmr << " -> " << stats.after.acmr
+	          << ", ATVR " << stats.before.atvr << " -> " << stats.after.atvr;
+}
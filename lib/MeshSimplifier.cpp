@@ -0,0 +1,338 @@
+#include <algorithm>
+#include <glove/MappedFile.h>
+#include <glove/MeshOptimizer.h>
+#include <glove/MeshSimplifier.h>
+#include <numeric>
+#include <unordered_map>
+
+/**
+ * @brief Fraction of triangles kept from one level of detail to the next.
+ */
+static constexpr float gLodReduction = 0.5f;
+
+/**
+ * @brief Largest error allowed for any level of detail, relative to the size
+ * of the mesh.
+ */
+static constexpr float gMaxLodError = 0.05f;
+
+/**
+ * @brief Symmetric 4x4 matrix measuring the sum of squared distances to a set
+ * of planes, weighted by the area of the triangles they came from.
+ */
+struct Quadric {
+	double a2, ab, ac, ad;
+	double b2, bc, bd;
+	double c2, cd;
+	double d2;
+	double weight; ///< Total area of the planes.
+
+	/**
+	 * @brief Create the quadric of a plane.
+	 * @param normal Unit normal of the plane.
+	 * @param d Distance from the plane to the origin.
+	 * @param weight Weight of the plane.
+	 */
+	static auto plane(const glm::vec3 &normal, float d, float weight)
+	    -> Quadric {
+		const double a = normal.x, b = normal.y, c = normal.z, w = weight;
+		return {a * a * w, a * b * w, a * c * w, a * d * w, b * b * w,
+		        b * c * w, b * d * w, c * c * w, c * d * w, d * d * w, w};
+	}
+
+	auto operator+=(const Quadric &other) -> Quadric & {
+		a2 += other.a2, ab += other.ab, ac += other.ac, ad += other.ad;
+		b2 += other.b2, bc += other.bc, bd += other.bd;
+		c2 += other.c2, cd += other.cd;
+		d2 += other.d2;
+		weight += other.weight;
+		return *this;
+	}
+
+	/**
+	 * @brief Average squared distance from a point to the planes.
+	 */
+	[[nodiscard]] auto error(const glm::vec3 &p) const -> float {
+		const double x = p.x, y = p.y, z = p.z;
+		const auto   sum = a2 * x * x + b2 * y * y + c2 * z * z +
+		                 2.0 * (ab * x * y + ac * x * z + bc * y * z) +
+		                 2.0 * (ad * x + bd * y + cd * z) + d2;
+		return weight > 0.0 ? static_cast<float>(std::abs(sum) / weight)
+		                    : 0.0f;
+	}
+};
+
+/**
+ * @brief A candidate edge collapse, moving one vertex onto another.
+ */
+struct Collapse {
+	GLuint from; ///< Vertex that is removed.
+	GLuint to;   ///< Vertex it is moved onto.
+	float  cost; ///< Squared error introduced by the collapse.
+};
+
+/**
+ * @brief Find one representative vertex for every unique position, so that
+ * vertices split along attribute seams are treated as one.
+ */
+static auto weld_positions(const std::vector<Vertex3DNormTex> &vertices)
+    -> std::vector<GLuint> {
+	struct PositionHash {
+		auto operator()(const glm::vec3 &p) const -> size_t {
+			return static_cast<size_t>(
+			    hashBytes(reinterpret_cast<const std::byte *>(&p), sizeof(p)));
+		}
+	};
+
+	std::unordered_map<glm::vec3, GLuint, PositionHash> unique;
+	unique.reserve(vertices.size());
+
+	std::vector<GLuint> canonical(vertices.size());
+	for (size_t i = 0; i < vertices.size(); ++i) {
+		canonical[i] =
+		    unique.try_emplace(vertices[i].pos, static_cast<GLuint>(i))
+		        .first->second;
+	}
+
+	return canonical;
+}
+
+/**
+ * @brief Find the vertices that must not move, the ones on attribute seams and
+ * the ones on open borders.
+ */
+static auto find_locked(const std::vector<GLuint> &canonical,
+                        const std::vector<GLuint> &indices)
+    -> std::vector<bool> {
+	const auto        vertex_count = canonical.size();
+	std::vector<bool> locked(vertex_count, false);
+
+	// Vertices sharing a position with another vertex are on a seam
+	std::vector<uint32_t> twins(vertex_count, 0);
+	for (size_t i = 0; i < vertex_count; ++i)
+		twins[canonical[i]]++;
+
+	// Edges used by only one triangle are on a border
+	std::unordered_map<uint64_t, uint32_t> edges;
+	edges.reserve(indices.size());
+	for (size_t i = 0; i < indices.size(); i += 3) {
+		for (size_t k = 0; k < 3; ++k) {
+			const uint64_t a = canonical[indices[i + k]];
+			const uint64_t b = canonical[indices[i + (k + 1) % 3]];
+			edges[std::min(a, b) << 32 | std::max(a, b)]++;
+		}
+	}
+
+	std::vector<bool> border(vertex_count, false);
+	for (const auto &[edge, count] : edges) {
+		if (count == 1) {
+			border[edge >> 32]         = true;
+			border[edge & 0xffffffffu] = true;
+		}
+	}
+
+	for (size_t i = 0; i < vertex_count; ++i)
+		locked[i] = twins[canonical[i]] > 1 || border[canonical[i]];
+
+	return locked;
+}
+
+/**
+ * @brief Would moving a vertex flip any of the triangles around it?
+ */
+static auto flips(const std::vector<Vertex3DNormTex> &vertices,
+                  const std::vector<GLuint> &indices,
+                  const std::vector<size_t> &offsets,
+                  const std::vector<uint32_t> &adjacency, GLuint from,
+                  GLuint to) -> bool {
+	for (auto i = offsets[from]; i < offsets[from + 1]; ++i) {
+		const auto *triangle = &indices[adjacency[i] * 3];
+
+		// Triangles along the collapsed edge are removed anyway
+		if (triangle[0] == to || triangle[1] == to || triangle[2] == to)
+			continue;
+
+		glm::vec3 before[3], after[3];
+		for (size_t k = 0; k < 3; ++k) {
+			before[k] = vertices[triangle[k]].pos;
+			after[k]  = triangle[k] == from ? vertices[to].pos : before[k];
+		}
+
+		const auto normal_before =
+		    glm::cross(before[1] - before[0], before[2] - before[0]);
+		const auto normal_after =
+		    glm::cross(after[1] - after[0], after[2] - after[0]);
+		if (glm::dot(normal_before, normal_after) <= 0.0f)
+			return true;
+	}
+
+	return false;
+}
+
+auto simplifyMesh(const std::vector<Vertex3DNormTex> &vertices,
+                  const std::vector<GLuint> &indices, size_t target_index_count,
+                  float target_error) -> Simplification {
+	const auto vertex_count = vertices.size();
+	const auto canonical    = weld_positions(vertices);
+	const auto locked       = find_locked(canonical, indices);
+
+	// Every vertex starts out with the planes of the triangles around it,
+	// shared between all the vertices at the same position
+	std::vector<Quadric> quadrics(vertex_count, Quadric{});
+	for (size_t i = 0; i < indices.size(); i += 3) {
+		const auto &a = vertices[indices[i + 0]].pos;
+		const auto &b = vertices[indices[i + 1]].pos;
+		const auto &c = vertices[indices[i + 2]].pos;
+
+		const auto normal = glm::cross(b - a, c - a);
+		const auto area   = glm::length(normal);
+		if (area == 0.0f)
+			continue;
+
+		const auto unit    = normal / area;
+		const auto quadric = Quadric::plane(unit, -glm::dot(unit, a), area);
+		for (size_t k = 0; k < 3; ++k)
+			quadrics[canonical[indices[i + k]]] += quadric;
+	}
+
+	auto result = Simplification{indices, 0.0f};
+
+	const auto max_cost = target_error * target_error;
+	auto       max_seen = 0.0f;
+
+	std::vector<Collapse> collapses;
+	std::vector<GLuint>   remap(vertex_count);
+	std::vector<bool>     touched(vertex_count);
+	std::vector<uint32_t> adjacency;
+	std::vector<size_t>   offsets(vertex_count + 1);
+
+	// Collapse a batch of independent edges per pass, cheapest first
+	while (result.indices.size() > target_index_count) {
+		auto &current = result.indices;
+
+		collapses.clear();
+		for (size_t i = 0; i < current.size(); i += 3) {
+			for (size_t k = 0; k < 3; ++k) {
+				const auto from = current[i + k];
+				const auto to   = current[i + (k + 1) % 3];
+				if (locked[from] || canonical[from] == canonical[to])
+					continue;
+
+				auto quadric = quadrics[canonical[from]];
+				quadric += quadrics[canonical[to]];
+				collapses.push_back(
+				    {from, to, quadric.error(vertices[to].pos)});
+			}
+		}
+		if (collapses.empty())
+			break;
+
+		std::sort(begin(collapses), end(collapses),
+		          [](const Collapse &a, const Collapse &b) {
+			          return a.cost < b.cost;
+		          });
+
+		// Vertex to triangle adjacency for the flip test
+		std::fill(begin(offsets), end(offsets), 0);
+		for (const auto index : current)
+			offsets[index + 1]++;
+		std::partial_sum(begin(offsets), end(offsets), begin(offsets));
+		adjacency.resize(current.size());
+		{
+			auto fill = offsets;
+			for (size_t i = 0; i < current.size(); ++i)
+				adjacency[fill[current[i]]++] = static_cast<uint32_t>(i / 3);
+		}
+
+		std::iota(begin(remap), end(remap), 0);
+		std::fill(begin(touched), end(touched), false);
+
+		// Every collapse removes about two triangles
+		const auto excess    = (current.size() - target_index_count) / 3;
+		size_t     removed   = 0;
+		size_t     collapsed = 0;
+		for (const auto &collapse : collapses) {
+			if (collapse.cost > max_cost || removed >= excess)
+				break;
+			if (touched[canonical[collapse.from]] ||
+			    touched[canonical[collapse.to]])
+				continue;
+			if (flips(vertices, current, offsets, adjacency, collapse.from,
+			          collapse.to))
+				continue;
+
+			remap[collapse.from]              = collapse.to;
+			touched[canonical[collapse.from]] = true;
+			touched[canonical[collapse.to]]   = true;
+			quadrics[canonical[collapse.to]] +=
+			    quadrics[canonical[collapse.from]];
+			max_seen = std::max(max_seen, collapse.cost);
+			removed += 2;
+			collapsed++;
+		}
+		if (collapsed == 0)
+			break;
+
+		// Apply the collapses and drop the triangles that became degenerate
+		size_t write = 0;
+		for (size_t i = 0; i < current.size(); i += 3) {
+			const auto a = remap[current[i + 0]];
+			const auto b = remap[current[i + 1]];
+			const auto c = remap[current[i + 2]];
+			if (canonical[a] == canonical[b] || canonical[b] == canonical[c] ||
+			    canonical[c] == canonical[a])
+				continue;
+
+			current[write++] = a;
+			current[write++] = b;
+			current[write++] = c;
+		}
+		current.resize(write);
+	}
+
+	result.error = std::sqrt(max_seen);
+	return result;
+}
+
+void generateLods(MeshData &mesh) {
+	const auto size = glm::length(mesh.bounds.max - mesh.bounds.min);
+
+	for (auto &submesh : mesh.submeshes) {
+		submesh.lod_count = 0;
+
+		// The indices of a submesh only refer to the vertices after its base
+		const std::vector<Vertex3DNormTex> vertices(
+		    begin(mesh.vertices) + submesh.base_vertex, end(mesh.vertices));
+		std::vector<GLuint> indices(
+		    begin(mesh.indices) + submesh.index_offset,
+		    begin(mesh.indices) + submesh.index_offset + submesh.index_count);
+
+		auto error = 0.0f;
+		while (submesh.lod_count < gMaxLods) {
+			const auto budget = gMaxLodError * size - error;
+			if (budget <= 0.0f)
+				break;
+
+			const auto target = static_cast<size_t>(
+			    static_cast<float>(indices.size() / 3) * gLodReduction) * 3;
+			auto lod = simplifyMesh(vertices, indices, target, budget);
+
+			// Not worth another level if it barely got simpler
+			if (lod.indices.empty() ||
+			    lod.indices.size() > indices.size() * 9 / 10)
+				break;
+
+			optimizeVertexCache(lod.indices, vertices.size());
+
+			// Errors add up, as every level is simplified from the last one
+			error += lod.error;
+			submesh.lods[submesh.lod_count++] = {
+			    static_cast<uint32_t>(mesh.indices.size()),
+			    static_cast<uint32_t>(lod.indices.size()), error};
+			mesh.indices.insert(end(mesh.indices), begin(lod.indices),
+			                    end(lod.indices));
+
+			indices = std::move(lod.indices);
+		}
+	}
+}
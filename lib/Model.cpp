@@ -1,45 +1,74 @@
+#include <cctype>
+#include <filesystem>
+#include <glove/CommandList.h>
+#include <glove/MeshCache.h>
+#include <glove/MeshOptimizer.h>
+#include <glove/MeshSimplifier.h>
+#include <glove/Model.h>
+#include <glove/ObjLoader.h>
+#include <iostream>
+#include <stdexcept>
+
+#ifdef GLOVE_HAS_ASSIMP
 #include <assimp/Importer.hpp>
 #include <assimp/postprocess.h>
 #include <assimp/scene.h>
-#include <glove/Model.h>
-#include <iostream>
 
-void process_node(const aiScene *scene, const aiNode *node,
-                  std::vector<Vertex3DNormTex> &vertices,
-                  std::vector<uint32_t> &       indices) {
+/**
+ * @brief Append the meshes of a node and its children as submeshes.
+ * The indices of every submesh stay relative to the first vertex of its assimp
+ * mesh, and are offset by the submesh's base vertex when drawing.
+ */
+static void process_node(const aiScene *scene, const aiNode *node,
+                         MeshData &mesh) {
 	for (size_t i = 0; i < node->mNumMeshes; ++i) {
-		const auto *mesh = scene->mMeshes[node->mMeshes[i]];
+		const auto *ai_mesh = scene->mMeshes[node->mMeshes[i]];
 
-		for (size_t j = 0; j < mesh->mNumVertices; ++j) {
-			assert(mesh->HasPositions());
-			assert(mesh->HasNormals());
-			assert(mesh->HasTextureCoords(0));
+		auto submesh         = Submesh{};
+		submesh.index_offset = static_cast<uint32_t>(mesh.indices.size());
+		submesh.base_vertex  = static_cast<uint32_t>(mesh.vertices.size());
+		submesh.material     = ai_mesh->mMaterialIndex;
 
+		assert(ai_mesh->HasPositions());
+		assert(ai_mesh->HasNormals());
+		assert(ai_mesh->HasTextureCoords(0));
+
+		for (size_t j = 0; j < ai_mesh->mNumVertices; ++j) {
 			auto position =
-			    glm::vec3(mesh->mVertices[j].x, mesh->mVertices[j].y,
-			              mesh->mVertices[j].z);
-			auto normal = glm::vec3(mesh->mNormals[j].x, mesh->mNormals[j].y,
-			                        mesh->mNormals[j].z);
-			auto uv     = glm::vec2(mesh->mTextureCoords[0][j].x,
-                                mesh->mTextureCoords[0][j].y);
-
-			vertices.push_back({position, normal, uv});
+			    glm::vec3(ai_mesh->mVertices[j].x, ai_mesh->mVertices[j].y,
+			              ai_mesh->mVertices[j].z);
+			auto normal =
+			    glm::vec3(ai_mesh->mNormals[j].x, ai_mesh->mNormals[j].y,
+			              ai_mesh->mNormals[j].z);
+			auto uv = glm::vec2(ai_mesh->mTextureCoords[0][j].x,
+			                    ai_mesh->mTextureCoords[0][j].y);
+
+			mesh.vertices.push_back({position, normal, uv});
 		}
 
-		for (size_t j = 0; j < mesh->mNumFaces; ++j) {
-			const auto &face = mesh->mFaces[j];
+		for (size_t j = 0; j < ai_mesh->mNumFaces; ++j) {
+			const auto &face = ai_mesh->mFaces[j];
 			for (size_t k = 0; k < face.mNumIndices; ++k) {
-				indices.push_back(face.mIndices[k]);
+				mesh.indices.push_back(face.mIndices[k]);
 			}
 		}
+
+		submesh.index_count =
+		    static_cast<uint32_t>(mesh.indices.size()) - submesh.index_offset;
+		mesh.submeshes.push_back(submesh);
 	}
 
 	for (size_t i = 0; i < node->mNumChildren; ++i) {
-		process_node(scene, node->mChildren[i], vertices, indices);
+		process_node(scene, node->mChildren[i], mesh);
 	}
 }
 
-Model::Model(const std::string &model_path) {
+/**
+ * @brief Import a model file with assimp.
+ * @param model_path Path to assimp compatible model file.
+ * @return The imported mesh.
+ */
+static auto import_assimp(const std::string &model_path) -> MeshData {
 	Assimp::Importer importer;
 
 	const auto *scene =
@@ -54,14 +83,266 @@ Model::Model(const std::string &model_path) {
 	assert(!(scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE));
 	assert(scene->HasMeshes());
 
-	std::vector<Vertex3DNormTex> vertices;
-	std::vector<uint32_t>        indices;
-	process_node(scene, scene->mRootNode, vertices, indices);
+	// Reserve space for everything up front. The preset triangulates, so every
+	// face has exactly 3 indices.
+	size_t vertex_count = 0;
+	size_t index_count  = 0;
+	for (size_t i = 0; i < scene->mNumMeshes; ++i) {
+		vertex_count += scene->mMeshes[i]->mNumVertices;
+		index_count += scene->mMeshes[i]->mNumFaces * 3;
+	}
+
+	MeshData mesh;
+	mesh.vertices.reserve(vertex_count);
+	mesh.indices.reserve(index_count);
+	mesh.submeshes.reserve(scene->mNumMeshes);
+	process_node(scene, scene->mRootNode, mesh);
+	mesh.bounds = computeBounds(mesh.vertices);
+
+	// Texture paths are relative to the model file
+	const auto directory = std::filesystem::path(model_path).parent_path();
+	for (size_t i = 0; i < scene->mNumMaterials; ++i) {
+		const auto *ai_material = scene->mMaterials[i];
+
+		auto material          = Material{};
+		material.name          = ai_material->GetName().C_Str();
+		material.diffuse_color = glm::vec4(1.0f);
+
+		aiColor4D color;
+		if (ai_material->Get(AI_MATKEY_COLOR_DIFFUSE, color) ==
+		    aiReturn_SUCCESS)
+			material.diffuse_color =
+			    glm::vec4(color.r, color.g, color.b, color.a);
+
+		aiString texture;
+		if (ai_material->GetTextureCount(aiTextureType_DIFFUSE) > 0 &&
+		    ai_material->GetTexture(aiTextureType_DIFFUSE, 0, &texture) ==
+		        aiReturn_SUCCESS)
+			material.diffuse_map = (directory / texture.C_Str()).string();
+
+		mesh.materials.push_back(material);
+	}
+
+	return mesh;
+}
+#endif
+
+/**
+ * @brief Import a model file, using the native OBJ loader when possible.
+ * @param model_path Path to the model file.
+ * @return The imported mesh.
+ */
+static auto import_mesh(const std::string &model_path) -> MeshData {
+	auto extension = std::filesystem::path(model_path).extension().string();
+	std::transform(begin(extension), end(extension), begin(extension),
+	               [](unsigned char c) { return std::tolower(c); });
+
+	if (extension == ".obj")
+		return loadObj(model_path);
+
+#ifdef GLOVE_HAS_ASSIMP
+	return import_assimp(model_path);
+#else
+	std::cout << "Error: Unsupported model format: " << model_path
+	          << std::endl;
+	throw std::runtime_error("Error: Glove was built without assimp.");
+#endif
+}
+
+/**
+ * @brief Get the index range of a submesh at a level of detail. Submeshes with
+ * fewer levels use their coarsest one.
+ */
+static auto lod_range(const Submesh &submesh, size_t lod) -> Lod {
+	if (lod == 0 || submesh.lod_count == 0)
+		return {submesh.index_offset, submesh.index_count, 0.0f};
+
+	return submesh.lods[std::min<size_t>(lod, submesh.lod_count) - 1];
+}
+
+/**
+ * @brief Import, optimize and simplify a model file, and store the result in
+ * the mesh cache.
+ * @param model_path Path to the model file.
+ * @return The processed mesh.
+ */
+static auto import_and_cache(const std::string &model_path) -> MeshData {
+	auto mesh = import_mesh(model_path);
+	optimizeMesh(mesh);
+	generateLods(mesh);
+	for (auto &submesh : mesh.submeshes)
+		submesh.bounds = computeBounds(mesh, submesh);
+	MeshCache::store(model_path, mesh);
+
+	return mesh;
+}
+
+Model::Model(const std::string &model_path) {
+	// Upload straight from the mapped cache if there is a valid one
+	if (const auto cache = MeshCache::load(model_path)) {
+		m_vbo = std::make_unique<VertexBuffer<Vertex3DNormTex>>(
+		    cache->vertices(), cache->vertexCount(), cache->indices(),
+		    cache->indexCount());
+		m_bounds    = cache->bounds();
+		m_materials = cache->materials();
+		m_stats     = cache->optimizerStats();
+		setSubmeshes(cache->submeshes());
+		return;
+	}
+
+	auto mesh = import_and_cache(model_path);
+
+	m_vbo = std::make_unique<VertexBuffer<Vertex3DNormTex>>(mesh.vertices,
+	                                                        mesh.indices);
+	m_bounds    = mesh.bounds;
+	m_materials = std::move(mesh.materials);
+	m_stats     = mesh.optimizer_stats;
+	setSubmeshes(std::move(mesh.submeshes));
+}
+
+Model::Model(const MeshData &mesh) {
+	m_vbo = std::make_unique<VertexBuffer<Vertex3DNormTex>>(mesh.vertices,
+	                                                        mesh.indices);
+	m_bounds    = mesh.bounds;
+	m_materials = mesh.materials;
+	m_stats     = mesh.optimizer_stats;
+	setSubmeshes(mesh.submeshes);
+}
+
+auto Model::loadMesh(const std::string &model_path) -> MeshData {
+	if (const auto cache = MeshCache::load(model_path))
+		return cache->toMeshData();
+
+	return import_and_cache(model_path);
+}
 
-	m_vbo = std::make_unique<VertexBuffer<Vertex3DNormTex>>(vertices, indices);
+void Model::draw(size_t lod) {
+	for (size_t i = 0; i < m_submeshes.size(); ++i)
+		drawSubmesh(i, lod);
 }
 
-void Model::draw() { m_vbo->draw(); }
+auto Model::drawVisible(const Frustum &frustum, const glm::mat4 &transform,
+                        size_t lod) -> bool {
+	if (!frustum.intersects(m_bounds, transform))
+		return false;
+
+	// The submesh bounds are only worth testing if they are smaller
+	if (m_submeshes.size() == 1) {
+		drawSubmesh(0, lod);
+		return true;
+	}
+
+	auto drawn = false;
+	for (size_t i = 0; i < m_submeshes.size(); ++i) {
+		if (frustum.intersects(m_submeshes[i].bounds, transform)) {
+			drawSubmesh(i, lod);
+			drawn = true;
+		}
+	}
+
+	return drawn;
+}
+
+auto Model::recordVisible(CommandList &list, const Frustum &frustum,
+                          const glm::mat4 &transform, size_t lod) const
+    -> bool {
+	if (!frustum.intersects(m_bounds, transform))
+		return false;
+
+	auto recorded = false;
+	for (const auto &submesh : m_submeshes) {
+		if (m_submeshes.size() > 1 &&
+		    !frustum.intersects(submesh.bounds, transform))
+			continue;
+
+		const auto range = lod_range(submesh, lod);
+		m_vbo->recordRange(list, range.index_offset, range.index_count,
+		                   static_cast<GLint>(submesh.base_vertex));
+		recorded = true;
+	}
+
+	return recorded;
+}
+
+void Model::drawSubmesh(size_t index, size_t lod) {
+	assert(index < m_submeshes.size());
+
+	const auto &submesh = m_submeshes[index];
+	const auto  range   = lod_range(submesh, lod);
+	m_vbo->drawRange(range.index_offset, range.index_count,
+	                 static_cast<GLint>(submesh.base_vertex));
+}
+
+void Model::drawInstances(size_t lod, GLuint first_instance,
+                          GLuint instance_count) {
+	for (const auto &submesh : m_submeshes) {
+		const auto range = lod_range(submesh, lod);
+		m_vbo->drawRangeInstanced(range.index_offset, range.index_count,
+		                          static_cast<GLint>(submesh.base_vertex),
+		                          first_instance, instance_count);
+	}
+}
+
+void Model::drawIndirect(const Buffer &commands, size_t first_command,
+                         size_t command_count) {
+	m_vbo->drawIndirect(commands, first_command, command_count);
+}
+
+auto Model::indirectCommands(size_t lod, GLuint base_instance) const
+    -> std::vector<DrawElementsIndirectCommand> {
+	std::vector<DrawElementsIndirectCommand> commands;
+	commands.reserve(m_submeshes.size());
+
+	for (const auto &submesh : m_submeshes) {
+		const auto range = lod_range(submesh, lod);
+		commands.push_back({range.index_count, 0, range.index_offset,
+		                    static_cast<GLint>(submesh.base_vertex),
+		                    base_instance});
+	}
+
+	return commands;
+}
+
+auto Model::selectLod(float pixels_per_unit, float max_error) const
+    -> size_t {
+	// Pick the coarsest level that is still within the error on screen
+	size_t lod = 0;
+	while (lod + 1 < m_lod_errors.size() &&
+	       m_lod_errors[lod + 1] * pixels_per_unit <= max_error)
+		lod++;
+
+	return lod;
+}
+
+auto Model::getMaterial(const Submesh &submesh) const -> const Material & {
+	assert(submesh.material < m_materials.size());
+	return m_materials[submesh.material];
+}
+
+void Model::setSubmeshes(std::vector<Submesh> submeshes) {
+	m_submeshes = std::move(submeshes);
+
+	// Importers without materials get one default material
+	if (m_materials.empty())
+		m_materials.push_back({"default", glm::vec4(1.0f), ""});
+	for (auto &submesh : m_submeshes) {
+		if (submesh.material >= m_materials.size())
+			submesh.material = 0;
+	}
+
+	size_t lod_count = 1;
+	for (const auto &submesh : m_submeshes)
+		lod_count = std::max<size_t>(lod_count, submesh.lod_count + 1);
+
+	// The error of a level is the largest error of any submesh at that level
+	m_lod_errors.assign(lod_count, 0.0f);
+	for (size_t lod = 1; lod < lod_count; ++lod) {
+		for (const auto &submesh : m_submeshes) {
+			m_lod_errors[lod] =
+			    std::max(m_lod_errors[lod], lod_range(submesh, lod).error);
+		}
+	}
+}
 
 // template <typename InstanceFormat>
 // void Model::setInstanceArray(const std::vector<InstanceFormat> &instances) {
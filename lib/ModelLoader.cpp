@@ -0,0 +1,80 @@
+#include <algorithm>
+#include <glove/ModelLoader.h>
+
+AsyncModel::AsyncModel(std::future<MeshData> mesh,
+                       std::shared_ptr<Model> placeholder)
+    : m_mesh(std::move(mesh)), m_placeholder(std::move(placeholder)) {}
+
+auto AsyncModel::finalize() -> bool {
+	if (m_model)
+		return true;
+
+	// Getting the mesh leaves the future invalid, even if the load failed
+	if (m_error)
+		std::rethrow_exception(m_error);
+
+	if (m_mesh.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+		return false;
+
+	try {
+		m_model = std::make_unique<Model>(m_mesh.get());
+	} catch (...) {
+		m_error = std::current_exception();
+		throw;
+	}
+	m_placeholder.reset();
+
+	return true;
+}
+
+void AsyncModel::draw(size_t lod) {
+	if (auto *model = get())
+		model->draw(lod);
+}
+
+ModelLoader::ModelLoader(size_t thread_count) : m_pool(thread_count) {}
+
+auto ModelLoader::load(const std::string &model_path,
+                       std::shared_ptr<Model> placeholder)
+    -> std::shared_ptr<AsyncModel> {
+	auto mesh = m_pool.submit(
+	    [model_path]() { return Model::loadMesh(model_path); });
+	auto model =
+	    std::make_shared<AsyncModel>(std::move(mesh), std::move(placeholder));
+	m_pending.push_back(model);
+
+	return model;
+}
+
+auto ModelLoader::finalize(std::chrono::microseconds budget) -> size_t {
+	using Clock = std::chrono::steady_clock;
+
+	// Nobody is waiting for models whose handles have all been dropped
+	m_pending.erase(std::remove_if(begin(m_pending), end(m_pending),
+	                               [](const auto &model) {
+		                               return model.use_count() == 1;
+	                               }),
+	                end(m_pending));
+
+	const auto start = Clock::now();
+	for (auto it = begin(m_pending); it != end(m_pending);) {
+		if (Clock::now() - start >= budget)
+			break;
+
+		// A failed model is never ready, so it is not waited for again
+		bool ready;
+		try {
+			ready = (*it)->finalize();
+		} catch (...) {
+			m_pending.erase(it);
+			throw;
+		}
+
+		if (ready)
+			it = m_pending.erase(it);
+		else
+			++it;
+	}
+
+	return m_pending.size();
+}
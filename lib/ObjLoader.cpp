@@ -0,0 +1,490 @@
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <glove/MappedFile.h>
+#include <glove/ObjLoader.h>
+#include <iostream>
+#include <stdexcept>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+
+/**
+ * @brief Chunks smaller than this are not worth a thread of their own.
+ */
+static constexpr size_t gMinChunkSize = 256 * 1024;
+
+/**
+ * @brief Material used for faces that do not specify one.
+ */
+static auto default_material(const std::string &name) -> Material {
+	return {name.empty() ? "default" : name, glm::vec4(0.8f, 0.8f, 0.8f, 1.0f),
+	        ""};
+}
+
+/**
+ * @brief One corner of a face, as zero based indices into the attribute
+ * arrays. Negative indices mean the attribute is missing.
+ */
+struct ObjCorner {
+	int32_t position;
+	int32_t texcoord;
+	int32_t normal;
+
+	auto operator==(const ObjCorner &other) const -> bool {
+		return position == other.position && texcoord == other.texcoord &&
+		       normal == other.normal;
+	}
+};
+
+struct ObjCornerHash {
+	auto operator()(const ObjCorner &corner) const -> size_t {
+		return static_cast<size_t>(corner.position) * 73856093u ^
+		       static_cast<size_t>(corner.texcoord) * 19349663u ^
+		       static_cast<size_t>(corner.normal) * 83492791u;
+	}
+};
+
+/**
+ * @brief A corner that used relative (negative) indices, which can only be
+ * resolved once it is known how many attributes precede the chunk.
+ */
+struct ObjRelativeCorner {
+	size_t  corner; ///< Index of the corner in the chunk.
+	uint8_t mask;   ///< Which attributes are relative. Bit 0 is position, 1
+	                ///< is texcoord and 2 is normal.
+};
+
+/**
+ * @brief A material switch ("usemtl") before a given corner.
+ */
+struct ObjMaterialSwitch {
+	size_t      corner; ///< First corner using the material.
+	std::string name;   ///< Name of the material.
+};
+
+/**
+ * @brief Everything parsed from one chunk of an OBJ file.
+ */
+struct ObjChunk {
+	std::vector<glm::vec3>         positions;
+	std::vector<glm::vec2>         texcoords;
+	std::vector<glm::vec3>         normals;
+	std::vector<ObjCorner>         corners; ///< Triangulated face corners.
+	std::vector<ObjRelativeCorner> relative;
+	std::vector<ObjMaterialSwitch> materials;
+	std::vector<std::string>       libraries; ///< Referenced MTL files.
+};
+
+static auto skip_spaces(const char *it, const char *end) -> const char * {
+	while (it < end && (*it == ' ' || *it == '\t'))
+		++it;
+	return it;
+}
+
+static auto skip_token(const char *it, const char *end) -> const char * {
+	while (it < end && *it != ' ' && *it != '\t')
+		++it;
+	return it;
+}
+
+/**
+ * @brief Get the rest of the line without surrounding whitespace.
+ */
+static auto rest_of_line(const char *it, const char *end) -> std::string {
+	it = skip_spaces(it, end);
+	while (end > it && (end[-1] == ' ' || end[-1] == '\t'))
+		--end;
+	return std::string(it, end);
+}
+
+static auto parse_float(const char *&it, const char *end) -> float {
+	it = skip_spaces(it, end);
+	// from_chars does not accept an explicit plus sign
+	if (it < end && *it == '+')
+		++it;
+
+	float      value  = 0.0f;
+	const auto result = std::from_chars(it, end, value);
+	it                = result.ptr;
+	return value;
+}
+
+static auto parse_int(const char *&it, const char *end) -> int32_t {
+	if (it < end && *it == '+')
+		++it;
+
+	int32_t    value  = 0;
+	const auto result = std::from_chars(it, end, value);
+	it                = result.ptr;
+	return value;
+}
+
+/**
+ * @brief Parse a face and append it to the chunk as a triangle fan.
+ */
+static void parse_face(const char *it, const char *end, ObjChunk &chunk,
+                       std::vector<ObjCorner> &face,
+                       std::vector<uint8_t> &  face_masks) {
+	const int32_t counts[3] = {static_cast<int32_t>(chunk.positions.size()),
+	                           static_cast<int32_t>(chunk.texcoords.size()),
+	                           static_cast<int32_t>(chunk.normals.size())};
+
+	face.clear();
+	face_masks.clear();
+
+	for (it = skip_spaces(it, end); it < end; it = skip_spaces(it, end)) {
+		// "p", "p/t", "p//n" or "p/t/n". OBJ indices start at 1, so 0 means
+		// the attribute is missing.
+		int32_t values[3] = {0, 0, 0};
+		for (int k = 0; k < 3; ++k) {
+			if (k > 0) {
+				if (it >= end || *it != '/')
+					break;
+				++it;
+			}
+			if (it < end && *it != '/' && *it != ' ' && *it != '\t')
+				values[k] = parse_int(it, end);
+		}
+		// Skip anything unexpected to avoid getting stuck
+		it = skip_token(it, end);
+
+		int32_t resolved[3];
+		uint8_t relative_mask = 0;
+		for (int k = 0; k < 3; ++k) {
+			if (values[k] > 0) {
+				resolved[k] = values[k] - 1;
+			} else if (values[k] < 0) {
+				resolved[k] = counts[k] + values[k];
+				relative_mask |= static_cast<uint8_t>(1u << k);
+			} else {
+				resolved[k] = -1;
+			}
+		}
+
+		face.push_back({resolved[0], resolved[1], resolved[2]});
+		face_masks.push_back(relative_mask);
+	}
+
+	for (size_t i = 1; i + 1 < face.size(); ++i) {
+		for (const auto k : {size_t(0), i, i + 1}) {
+			if (face_masks[k] != 0)
+				chunk.relative.push_back({chunk.corners.size(), face_masks[k]});
+			chunk.corners.push_back(face[k]);
+		}
+	}
+}
+
+/**
+ * @brief Parse a range of whole lines of an OBJ file.
+ */
+static void parse_chunk(const char *begin, const char *end, ObjChunk &chunk) {
+	std::vector<ObjCorner> face;
+	std::vector<uint8_t>   face_masks;
+
+	for (const char *line = begin; line < end;) {
+		const auto *eol = static_cast<const char *>(
+		    std::memchr(line, '\n', static_cast<size_t>(end - line)));
+		if (eol == nullptr)
+			eol = end;
+
+		const char *line_end = eol;
+		if (line_end > line && line_end[-1] == '\r')
+			--line_end;
+
+		const char *it      = skip_spaces(line, line_end);
+		const char *kw_end  = skip_token(it, line_end);
+		const auto  keyword = std::string_view(it, kw_end - it);
+		it                  = kw_end;
+
+		if (keyword == "v") {
+			const auto x = parse_float(it, line_end);
+			const auto y = parse_float(it, line_end);
+			const auto z = parse_float(it, line_end);
+			chunk.positions.emplace_back(x, y, z);
+		} else if (keyword == "vt") {
+			const auto u = parse_float(it, line_end);
+			const auto v = parse_float(it, line_end);
+			chunk.texcoords.emplace_back(u, v);
+		} else if (keyword == "vn") {
+			const auto x = parse_float(it, line_end);
+			const auto y = parse_float(it, line_end);
+			const auto z = parse_float(it, line_end);
+			chunk.normals.emplace_back(x, y, z);
+		} else if (keyword == "f") {
+			parse_face(it, line_end, chunk, face, face_masks);
+		} else if (keyword == "usemtl") {
+			chunk.materials.push_back(
+			    {chunk.corners.size(), rest_of_line(it, line_end)});
+		} else if (keyword == "mtllib") {
+			chunk.libraries.push_back(rest_of_line(it, line_end));
+		}
+
+		line = eol + 1;
+	}
+}
+
+/**
+ * @brief Split a file into roughly equal chunks of whole lines.
+ */
+static auto split_lines(const char *data, size_t size, size_t count)
+    -> std::vector<std::pair<const char *, const char *>> {
+	std::vector<std::pair<const char *, const char *>> ranges;
+	ranges.reserve(count);
+
+	const char *begin = data;
+	const char *last  = data + size;
+	for (size_t i = 1; i <= count && begin < last; ++i) {
+		const char *end = data + size * i / count;
+		if (end < begin)
+			end = begin;
+
+		// Move the end to the start of the next line
+		const auto *eol = static_cast<const char *>(
+		    std::memchr(end, '\n', static_cast<size_t>(last - end)));
+		end = eol != nullptr ? eol + 1 : last;
+
+		ranges.emplace_back(begin, end);
+		begin = end;
+	}
+
+	return ranges;
+}
+
+auto loadObj(const std::string &path) -> MeshData {
+	const auto file = MappedFile::open(path);
+	if (file == nullptr) {
+		std::cout << "Error: Failed to open OBJ file: " << path << std::endl;
+		throw std::runtime_error("Error: Failed to open file.");
+	}
+
+	const auto *data = reinterpret_cast<const char *>(file->data());
+	const auto  size = file->size();
+
+	// Parse chunks in parallel, with the calling thread taking the first one
+	const size_t max_chunks =
+	    std::max(1u, std::thread::hardware_concurrency());
+	const auto ranges = split_lines(
+	    data, size, std::clamp<size_t>(size / gMinChunkSize, 1, max_chunks));
+
+	std::vector<ObjChunk>    chunks(ranges.size());
+	std::vector<std::thread> workers;
+	workers.reserve(ranges.size());
+	for (size_t i = 1; i < ranges.size(); ++i) {
+		workers.emplace_back(parse_chunk, ranges[i].first, ranges[i].second,
+		                     std::ref(chunks[i]));
+	}
+	if (!ranges.empty())
+		parse_chunk(ranges[0].first, ranges[0].second, chunks[0]);
+	for (auto &worker : workers)
+		worker.join();
+
+	// Stitch the chunks together, and resolve the relative indices now that
+	// it is known how many attributes precede every chunk
+	size_t position_count = 0;
+	size_t texcoord_count = 0;
+	size_t normal_count   = 0;
+	size_t corner_count   = 0;
+	for (const auto &chunk : chunks) {
+		position_count += chunk.positions.size();
+		texcoord_count += chunk.texcoords.size();
+		normal_count += chunk.normals.size();
+		corner_count += chunk.corners.size();
+	}
+
+	std::vector<glm::vec3>         positions;
+	std::vector<glm::vec2>         texcoords;
+	std::vector<glm::vec3>         normals;
+	std::vector<ObjCorner>         corners;
+	std::vector<ObjMaterialSwitch> switches;
+	std::vector<std::string>       libraries;
+	positions.reserve(position_count);
+	texcoords.reserve(texcoord_count);
+	normals.reserve(normal_count);
+	corners.reserve(corner_count);
+
+	for (auto &chunk : chunks) {
+		const auto position_base = static_cast<int32_t>(positions.size());
+		const auto texcoord_base = static_cast<int32_t>(texcoords.size());
+		const auto normal_base   = static_cast<int32_t>(normals.size());
+		const auto corner_base   = corners.size();
+
+		for (const auto &relative : chunk.relative) {
+			auto &corner = chunk.corners[relative.corner];
+			if (relative.mask & 1u)
+				corner.position += position_base;
+			if (relative.mask & 2u)
+				corner.texcoord += texcoord_base;
+			if (relative.mask & 4u)
+				corner.normal += normal_base;
+		}
+
+		positions.insert(end(positions), begin(chunk.positions),
+		                 end(chunk.positions));
+		texcoords.insert(end(texcoords), begin(chunk.texcoords),
+		                 end(chunk.texcoords));
+		normals.insert(end(normals), begin(chunk.normals),
+		               end(chunk.normals));
+		corners.insert(end(corners), begin(chunk.corners),
+		               end(chunk.corners));
+
+		for (auto &material : chunk.materials) {
+			material.corner += corner_base;
+			switches.push_back(std::move(material));
+		}
+		for (auto &library : chunk.libraries)
+			libraries.push_back(std::move(library));
+	}
+
+	// Load the referenced materials
+	MeshData   mesh;
+	const auto directory = std::filesystem::path(path).parent_path();
+	for (const auto &library : libraries) {
+		auto materials = loadMtl((directory / library).string());
+		mesh.materials.insert(end(mesh.materials), begin(materials),
+		                      end(materials));
+	}
+
+	const auto material_index = [&](const std::string &name) -> uint32_t {
+		for (size_t i = 0; i < mesh.materials.size(); ++i) {
+			if (mesh.materials[i].name == name)
+				return static_cast<uint32_t>(i);
+		}
+		mesh.materials.push_back(default_material(name));
+		return static_cast<uint32_t>(mesh.materials.size() - 1);
+	};
+
+	// Faces before the first "usemtl" use the default material
+	if (switches.empty() || switches.front().corner != 0)
+		switches.insert(begin(switches), ObjMaterialSwitch{0, ""});
+
+	// Build the final vertices, one per unique corner
+	std::unordered_map<ObjCorner, GLuint, ObjCornerHash> unique;
+	unique.reserve(position_count);
+	mesh.vertices.reserve(position_count);
+	mesh.indices.reserve(corner_count);
+
+	std::vector<bool> missing_normal;
+	missing_normal.reserve(position_count);
+
+	for (size_t s = 0; s < switches.size(); ++s) {
+		const auto first = switches[s].corner;
+		const auto last =
+		    s + 1 < switches.size() ? switches[s + 1].corner : corners.size();
+		if (first == last)
+			continue;
+
+		auto submesh         = Submesh{};
+		submesh.index_offset = static_cast<uint32_t>(mesh.indices.size());
+		submesh.index_count  = static_cast<uint32_t>(last - first);
+		submesh.base_vertex  = 0;
+		submesh.material     = material_index(switches[s].name);
+		mesh.submeshes.push_back(submesh);
+
+		for (size_t i = first; i < last; ++i) {
+			auto corner = corners[i];
+			if (corner.position < 0 ||
+			    corner.position >= static_cast<int32_t>(positions.size())) {
+				std::cout << "Error: OBJ face references a missing vertex: "
+				          << path << std::endl;
+				throw std::runtime_error("Error: Malformed OBJ file.");
+			}
+			if (corner.texcoord >= static_cast<int32_t>(texcoords.size()))
+				corner.texcoord = -1;
+			if (corner.normal >= static_cast<int32_t>(normals.size()))
+				corner.normal = -1;
+
+			const auto [it, inserted] = unique.try_emplace(
+			    corner, static_cast<GLuint>(mesh.vertices.size()));
+			if (inserted) {
+				mesh.vertices.push_back(
+				    {positions[corner.position],
+				     corner.normal >= 0 ? normals[corner.normal]
+				                        : glm::vec3(0.0f),
+				     corner.texcoord >= 0 ? texcoords[corner.texcoord]
+				                          : glm::vec2(0.0f)});
+				missing_normal.push_back(corner.normal < 0);
+			}
+			mesh.indices.push_back(it->second);
+		}
+	}
+
+	// Generate smooth normals for the vertices that did not have any
+	if (std::find(begin(missing_normal), end(missing_normal), true) !=
+	    end(missing_normal)) {
+		for (size_t i = 0; i + 2 < mesh.indices.size(); i += 3) {
+			auto &a = mesh.vertices[mesh.indices[i + 0]];
+			auto &b = mesh.vertices[mesh.indices[i + 1]];
+			auto &c = mesh.vertices[mesh.indices[i + 2]];
+
+			// Area weighted face normal
+			const auto normal = glm::cross(b.pos - a.pos, c.pos - a.pos);
+			for (const auto index : {mesh.indices[i + 0], mesh.indices[i + 1],
+			                         mesh.indices[i + 2]}) {
+				if (missing_normal[index])
+					mesh.vertices[index].normal += normal;
+			}
+		}
+
+		for (size_t i = 0; i < mesh.vertices.size(); ++i) {
+			auto &normal = mesh.vertices[i].normal;
+			if (missing_normal[i] && glm::length(normal) > 0.0f)
+				normal = glm::normalize(normal);
+		}
+	}
+
+	mesh.bounds = computeBounds(mesh.vertices);
+
+	return mesh;
+}
+
+auto loadMtl(const std::string &path) -> std::vector<Material> {
+	std::vector<Material> materials;
+
+	std::ifstream file(path);
+	if (!file.is_open()) {
+		std::cout << "Warning: Failed to open material library: " << path
+		          << std::endl;
+		return materials;
+	}
+
+	const auto directory = std::filesystem::path(path).parent_path();
+
+	std::string line;
+	while (std::getline(file, line)) {
+		const char *end = line.data() + line.size();
+		if (end > line.data() && end[-1] == '\r')
+			--end;
+
+		const char *it      = skip_spaces(line.data(), end);
+		const char *kw_end  = skip_token(it, end);
+		const auto  keyword = std::string_view(it, kw_end - it);
+		it                  = kw_end;
+
+		if (keyword == "newmtl") {
+			materials.push_back(default_material(rest_of_line(it, end)));
+		} else if (materials.empty()) {
+			// Properties outside of a material are meaningless
+			continue;
+		} else if (keyword == "Kd") {
+			auto &     color = materials.back().diffuse_color;
+			const auto r     = parse_float(it, end);
+			const auto g     = parse_float(it, end);
+			const auto b     = parse_float(it, end);
+			color            = glm::vec4(r, g, b, color.w);
+		} else if (keyword == "d") {
+			materials.back().diffuse_color.w = parse_float(it, end);
+		} else if (keyword == "Tr") {
+			materials.back().diffuse_color.w = 1.0f - parse_float(it, end);
+		} else if (keyword == "map_Kd") {
+			// Texture options are not supported, the file name is always last
+			auto name = rest_of_line(it, end);
+			name      = name.substr(name.find_last_of(" \t") + 1);
+			materials.back().diffuse_map = (directory / name).string();
+		}
+	}
+
+	return materials;
+}
@@ -0,0 +1,460 @@
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <future>
+#include <glove/OcclusionCuller.h>
+#include <limits>
+#include <tuple>
+
+#if defined(__SSE__) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define GLOVE_OCCLUSION_SSE
+#include <xmmintrin.h>
+#endif
+
+/**
+ * @brief Distance along the view direction the occluders are clipped at. Much
+ * further out than the camera's near plane, so that the projected corners stay
+ * within a sane range of pixels.
+ */
+static constexpr float gClipDistance = 0.05f;
+
+/**
+ * @brief Bands of rows rasterized per thread, more than one to even out the
+ * work between threads.
+ */
+static constexpr size_t gBandsPerThread = 4;
+
+/**
+ * @brief Neighbor of an occluder edge that is not shared with another.
+ */
+static constexpr size_t gNoNeighbor = std::numeric_limits<size_t>::max();
+
+/**
+ * @brief Transform a point by a matrix.
+ */
+static auto transform_point(const glm::mat4 &m, const glm::vec3 &v)
+    -> glm::vec4 {
+#ifdef GLOVE_OCCLUSION_SSE
+	// The columns are contiguous, so the whole product is four multiply-adds
+	auto result = _mm_loadu_ps(&m[3][0]);
+	result = _mm_add_ps(result, _mm_mul_ps(_mm_loadu_ps(&m[0][0]),
+	                                       _mm_set1_ps(v.x)));
+	result = _mm_add_ps(result, _mm_mul_ps(_mm_loadu_ps(&m[1][0]),
+	                                       _mm_set1_ps(v.y)));
+	result = _mm_add_ps(result, _mm_mul_ps(_mm_loadu_ps(&m[2][0]),
+	                                       _mm_set1_ps(v.z)));
+
+	glm::vec4 out;
+	_mm_storeu_ps(&out[0], result);
+	return out;
+#else
+	return m * glm::vec4(v, 1.0f);
+#endif
+}
+
+/**
+ * @brief Project a point in clip space into pixels, bottom row first like
+ * OpenGL.
+ */
+static auto to_pixels(const glm::vec4 &clip, const glm::vec2 &size)
+    -> glm::vec2 {
+	return (glm::vec2(clip) / clip.w * 0.5f + 0.5f) * size;
+}
+
+/**
+ * @brief Twice the signed area of a polygon, positive if counter clockwise.
+ */
+static auto signed_area(const glm::vec2 *corners, int count) -> float {
+	auto area = 0.0f;
+	for (int i = 0; i < count; ++i) {
+		const auto &from = corners[i];
+		const auto &to   = corners[(i + 1) % count];
+		area += from.x * to.y - from.y * to.x;
+	}
+	return area;
+}
+
+/**
+ * @brief Order points by their coordinates.
+ */
+static auto point_less(const glm::vec3 &lhs, const glm::vec3 &rhs) -> bool {
+	return std::tie(lhs.x, lhs.y, lhs.z) < std::tie(rhs.x, rhs.y, rhs.z);
+}
+
+/**
+ * @brief Get the corners of a box.
+ */
+static void box_corners(const glm::vec3 &min, const glm::vec3 &max,
+                        glm::vec3 (&corners)[8]) {
+	for (int i = 0; i < 8; ++i)
+		corners[i] = glm::vec3((i & 1) ? max.x : min.x,
+		                       (i & 2) ? max.y : min.y,
+		                       (i & 4) ? max.z : min.z);
+}
+
+OcclusionCuller::OcclusionCuller(glm::ivec2 resolution, size_t thread_count)
+    : m_resolution(resolution),
+      m_depth(static_cast<size_t>(resolution.x * resolution.y),
+              std::numeric_limits<float>::infinity()),
+      m_view_projection(1.0f), m_pool(thread_count),
+      m_band_count(std::max<size_t>(thread_count, 1) * gBandsPerThread) {
+	assert(resolution.x > 0 && resolution.x % 4 == 0 && resolution.y > 0);
+}
+
+void OcclusionCuller::setOccluders(std::vector<glm::vec3> triangles) {
+	assert(triangles.size() % 3 == 0);
+	m_occluders = std::move(triangles);
+
+	// Pair up the edges found in exactly two triangles, whichever way they
+	// are wound
+	struct Edge {
+		glm::vec3 from, to;
+		size_t    triangle;
+		int       index;
+	};
+	std::vector<Edge> edges;
+	edges.reserve(m_occluders.size());
+	for (size_t i = 0; i < m_occluders.size(); ++i) {
+		const auto next = i - i % 3 + (i + 1) % 3;
+		auto       from = m_occluders[i];
+		auto       to   = m_occluders[next];
+		if (point_less(to, from))
+			std::swap(from, to);
+		edges.push_back({from, to, i / 3, static_cast<int>(i % 3)});
+	}
+
+	const auto less = [](const Edge &lhs, const Edge &rhs) {
+		if (point_less(lhs.from, rhs.from) || point_less(rhs.from, lhs.from))
+			return point_less(lhs.from, rhs.from);
+		return point_less(lhs.to, rhs.to);
+	};
+	std::sort(begin(edges), end(edges), less);
+
+	m_neighbors.assign(m_occluders.size() / 3,
+	                   {gNoNeighbor, gNoNeighbor, gNoNeighbor});
+	for (size_t i = 0; i < edges.size();) {
+		auto last = i + 1;
+		while (last < edges.size() && !less(edges[i], edges[last]))
+			++last;
+
+		if (last - i == 2 && edges[i].triangle != edges[i + 1].triangle) {
+			const auto &a = edges[i];
+			const auto &b = edges[i + 1];
+
+			m_neighbors[a.triangle][a.index] = b.triangle;
+			m_neighbors[b.triangle][b.index] = a.triangle;
+		}
+		i = last;
+	}
+}
+
+void OcclusionCuller::render(const glm::mat4 &view_projection) {
+	m_view_projection = view_projection;
+	std::fill(begin(m_depth), end(m_depth),
+	          std::numeric_limits<float>::infinity());
+
+	m_clip.resize(m_occluders.size());
+	for (size_t i = 0; i < m_occluders.size(); ++i)
+		m_clip[i] = transform_point(view_projection, m_occluders[i]);
+
+	m_polygons.clear();
+	for (size_t i = 0; i < m_occluders.size() / 3; ++i)
+		addTriangle(i);
+
+	// Every band only writes its own rows, so they need no synchronization
+	const auto rows = m_resolution.y;
+	const auto band_rows =
+	    (rows + static_cast<int>(m_band_count) - 1) /
+	    static_cast<int>(m_band_count);
+
+	std::vector<std::future<void>> bands;
+	for (auto first = 0; first < rows; first += band_rows) {
+		const auto last = std::min(first + band_rows, rows);
+		bands.push_back(
+		    m_pool.submit([this, first, last]() { rasterize(first, last); }));
+	}
+	for (auto &band : bands)
+		band.get();
+}
+
+void OcclusionCuller::addTriangle(size_t triangle) {
+	const auto *clip = m_clip.data() + triangle * 3;
+
+	// Entirely outside one side of the frustum
+	for (int axis = 0; axis < 2; ++axis) {
+		if (clip[0][axis] > clip[0].w && clip[1][axis] > clip[1].w &&
+		    clip[2][axis] > clip[2].w)
+			return;
+		if (clip[0][axis] < -clip[0].w && clip[1][axis] < -clip[1].w &&
+		    clip[2][axis] < -clip[2].w)
+			return;
+	}
+
+	// Clip against the plane w = gClipDistance, leaving at most four corners.
+	// Every side is on an edge of the triangle, or -1 on the plane.
+	glm::vec4 polygon[4];
+	int       sides[4];
+	auto      count = 0;
+	for (int i = 0; i < 3; ++i) {
+		const auto &current = clip[i];
+		const auto &next    = clip[(i + 1) % 3];
+		const auto  d0      = current.w - gClipDistance;
+		const auto  d1      = next.w - gClipDistance;
+
+		if (d0 >= 0.0f) {
+			polygon[count] = current;
+			sides[count++] = i;
+		}
+		if ((d0 >= 0.0f) != (d1 >= 0.0f)) {
+			polygon[count] = current + (next - current) * (d0 / (d0 - d1));
+			sides[count++] = d0 >= 0.0f ? -1 : i;
+		}
+	}
+	if (count < 3)
+		return;
+
+	const auto size = glm::vec2(m_resolution);
+	glm::vec2  pixels[4];
+	for (int i = 0; i < count; ++i)
+		pixels[i] = to_pixels(polygon[i], size);
+
+	// Wind every polygon the same way, so that inside is positive
+	const auto area = signed_area(pixels, count);
+	if (area == 0.0f)
+		return;
+
+	auto screen  = ScreenPolygon{};
+	screen.lo    = pixels[0];
+	screen.hi    = pixels[0];
+	screen.depth = std::max({clip[0].w, clip[1].w, clip[2].w});
+	for (int i = 0; i < count; ++i) {
+		const auto &from = pixels[i];
+		const auto &to   = pixels[(i + 1) % count];
+		const auto  line = area > 0.0f ? EdgeFunction::between(from, to)
+		                               : EdgeFunction::between(to, from);
+
+		screen.lo = glm::min(screen.lo, from);
+		screen.hi = glm::max(screen.hi, from);
+
+		// Pixels straddling an edge shared with a neighbor are covered by
+		// the two together, everywhere else the edge is pulled in
+		auto &shared = screen.shared[screen.shared_count];
+		auto  depth  = 0.0f;
+		if (sides[i] >= 0 &&
+		    addNeighbor(triangle, sides[i], line, shared, depth)) {
+			screen.shared_count++;
+			screen.depth = std::max(screen.depth, depth);
+			screen.edges[screen.edge_count++] = line;
+		} else {
+			screen.edges[screen.edge_count++] = line.pulledIn();
+		}
+	}
+	m_polygons.push_back(screen);
+}
+
+auto OcclusionCuller::addNeighbor(size_t triangle, int edge,
+                                  const EdgeFunction &line, SharedEdge &shared,
+                                  float &depth) const -> bool {
+	const auto neighbor = m_neighbors[triangle][edge];
+	if (neighbor == gNoNeighbor)
+		return false;
+
+	// Neighbors cut by the near plane are left alone, they are rare
+	const auto *clip = m_clip.data() + neighbor * 3;
+	for (int i = 0; i < 3; ++i)
+		if (clip[i].w < gClipDistance)
+			return false;
+
+	const auto &back = m_neighbors[neighbor];
+	const auto  from =
+	    static_cast<int>(std::find(begin(back), end(back), triangle) -
+	                     begin(back));
+	assert(from < 3);
+
+	const auto size = glm::vec2(m_resolution);
+	glm::vec2  pixels[3];
+	for (int i = 0; i < 3; ++i)
+		pixels[i] = to_pixels(clip[i], size);
+
+	// Only a neighbor on the other side of the edge covers what is across
+	// it, not one folded over onto this side
+	const auto &across = pixels[(from + 2) % 3];
+	if (line(across.x, across.y) >= 0.0f)
+		return false;
+
+	const auto area = signed_area(pixels, 3);
+	if (area == 0.0f)
+		return false;
+
+	for (int i = 0; i < 2; ++i) {
+		const auto &a = pixels[(from + 1 + i) % 3];
+		const auto &b = pixels[(from + 2 + i) % 3];
+
+		shared.neighbor[i] = (area > 0.0f ? EdgeFunction::between(a, b)
+		                                  : EdgeFunction::between(b, a))
+		                         .pulledIn();
+	}
+	shared.inside = line.pulledIn();
+	depth         = std::max({clip[0].w, clip[1].w, clip[2].w});
+	return true;
+}
+
+void OcclusionCuller::rasterize(int first_row, int end_row) {
+	const auto width = m_resolution.x;
+
+	for (const auto &polygon : m_polygons) {
+		// Pixels that may be inside, rounded out to groups of four
+		const auto &lo = polygon.lo;
+		const auto &hi = polygon.hi;
+		const auto x0 = std::max(static_cast<int>(std::floor(lo.x)), 0) & ~3;
+		const auto x1 = std::min(static_cast<int>(std::ceil(hi.x)), width);
+		const auto y0 = std::max(static_cast<int>(std::floor(lo.y)), first_row);
+		const auto y1 = std::min(static_cast<int>(std::ceil(hi.y)), end_row);
+		if (x0 >= x1 || y0 >= y1)
+			continue;
+
+		for (auto y = y0; y < y1; ++y) {
+			const auto py  = static_cast<float>(y) + 0.5f;
+			auto *     row = m_depth.data() + static_cast<size_t>(y * width);
+
+			// A pixel is inside every edge, and straddles a shared edge only
+			// if it is inside the neighbor too
+#ifdef GLOVE_OCCLUSION_SSE
+			const auto depth = _mm_set1_ps(polygon.depth);
+			const auto zero  = _mm_setzero_ps();
+			__m128     a4[13], row_c[13];
+			auto       lines = 0;
+
+			const auto load = [&](const EdgeFunction &line) {
+				a4[lines]      = _mm_set1_ps(line.a);
+				row_c[lines++] = _mm_set1_ps(line.b * py + line.c);
+			};
+			for (int e = 0; e < polygon.edge_count; ++e)
+				load(polygon.edges[e]);
+			for (int s = 0; s < polygon.shared_count; ++s) {
+				load(polygon.shared[s].inside);
+				load(polygon.shared[s].neighbor[0]);
+				load(polygon.shared[s].neighbor[1]);
+			}
+
+			for (auto x = x0; x < x1; x += 4) {
+				const auto px = _mm_add_ps(_mm_set1_ps(static_cast<float>(x)),
+				                           _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f));
+				const auto covers = [&](int line) {
+					return _mm_cmpge_ps(
+					    _mm_add_ps(_mm_mul_ps(a4[line], px), row_c[line]),
+					    zero);
+				};
+
+				auto inside = covers(0);
+				for (int e = 1; e < polygon.edge_count; ++e)
+					inside = _mm_and_ps(inside, covers(e));
+				for (int s = 0; s < polygon.shared_count; ++s) {
+					const auto line   = polygon.edge_count + 3 * s;
+					const auto across =
+					    _mm_and_ps(covers(line + 1), covers(line + 2));
+					inside = _mm_and_ps(inside,
+					                    _mm_or_ps(covers(line), across));
+				}
+				if (_mm_movemask_ps(inside) == 0)
+					continue;
+
+				const auto old     = _mm_loadu_ps(row + x);
+				const auto nearest = _mm_min_ps(old, depth);
+				_mm_storeu_ps(row + x,
+				              _mm_or_ps(_mm_and_ps(inside, nearest),
+				                        _mm_andnot_ps(inside, old)));
+			}
+#else
+			for (auto x = x0; x < x1; ++x) {
+				const auto px     = static_cast<float>(x) + 0.5f;
+				auto       inside = true;
+				for (int e = 0; e < polygon.edge_count; ++e)
+					inside &= polygon.edges[e](px, py) >= 0.0f;
+				for (int s = 0; s < polygon.shared_count; ++s) {
+					const auto &shared = polygon.shared[s];
+					inside &= shared.inside(px, py) >= 0.0f ||
+					          (shared.neighbor[0](px, py) >= 0.0f &&
+					           shared.neighbor[1](px, py) >= 0.0f);
+				}
+				if (inside)
+					row[x] = std::min(row[x], polygon.depth);
+			}
+#endif
+		}
+	}
+}
+
+auto OcclusionCuller::isVisible(const glm::vec3 &min,
+                                const glm::vec3 &max) const -> bool {
+	glm::vec3 corners[8];
+	box_corners(min, max, corners);
+	return isVisible(corners);
+}
+
+auto OcclusionCuller::isVisible(const Bounds &   bounds,
+                                const glm::mat4 &transform) const -> bool {
+	glm::vec3 corners[8];
+	box_corners(bounds.min, bounds.max, corners);
+	for (auto &corner : corners)
+		corner = glm::vec3(transform_point(transform, corner));
+	return isVisible(corners);
+}
+
+auto OcclusionCuller::isVisible(const glm::vec3 (&corners)[8]) const -> bool {
+	const auto size = glm::vec2(m_resolution);
+
+	auto lo      = glm::vec2(std::numeric_limits<float>::max());
+	auto hi      = glm::vec2(std::numeric_limits<float>::lowest());
+	auto nearest = std::numeric_limits<float>::max();
+	for (const auto &corner : corners) {
+		const auto clip = transform_point(m_view_projection, corner);
+
+		// Too close to project, nothing can be in front of it
+		if (clip.w < gClipDistance)
+			return true;
+
+		const auto pixel = to_pixels(clip, size);
+		lo               = glm::min(lo, pixel);
+		hi               = glm::max(hi, pixel);
+		nearest          = std::min(nearest, clip.w);
+	}
+
+	const auto x0 = std::max(static_cast<int>(std::floor(lo.x)), 0);
+	const auto x1 = std::min(static_cast<int>(std::floor(hi.x)),
+	                         m_resolution.x - 1);
+	const auto y0 = std::max(static_cast<int>(std::floor(lo.y)), 0);
+	const auto y1 = std::min(static_cast<int>(std::floor(hi.y)),
+	                         m_resolution.y - 1);
+	// Off screen, which is for the frustum culling to decide
+	if (x0 > x1 || y0 > y1)
+		return true;
+
+	// Visible if any pixel of the rectangle has its occluder behind the box
+	for (auto y = y0; y <= y1; ++y) {
+		const auto *row =
+		    m_depth.data() + static_cast<size_t>(y * m_resolution.x);
+
+#ifdef GLOVE_OCCLUSION_SSE
+		const auto box   = _mm_set1_ps(nearest);
+		const auto first = _mm_set1_ps(static_cast<float>(x0));
+		const auto last  = _mm_set1_ps(static_cast<float>(x1));
+		for (auto x = x0 & ~3; x <= x1; x += 4) {
+			const auto lanes = _mm_add_ps(_mm_set1_ps(static_cast<float>(x)),
+			                              _mm_setr_ps(0.0f, 1.0f, 2.0f, 3.0f));
+			const auto in_rect = _mm_and_ps(_mm_cmpge_ps(lanes, first),
+			                                _mm_cmple_ps(lanes, last));
+			const auto behind  = _mm_cmpgt_ps(_mm_loadu_ps(row + x), box);
+			if (_mm_movemask_ps(_mm_and_ps(in_rect, behind)) != 0)
+				return true;
+		}
+#else
+		for (auto x = x0; x <= x1; ++x)
+			if (row[x] > nearest)
+				return true;
+#endif
+	}
+
+	return false;
+}
@@ -0,0 +1,106 @@
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <glove/RenderQueue.h>
+#include <utility>
+
+/**
+ * @brief Widths of the key fields in bits, they add up to 64.
+ */
+static constexpr uint32_t gPassBits     = 4;
+static constexpr uint32_t gLayerBits    = 4;
+static constexpr uint32_t gProgramBits  = 10;
+static constexpr uint32_t gMaterialBits = 12;
+static constexpr uint32_t gMeshBits     = 10;
+static constexpr uint32_t gDepthBits    = 24;
+
+/**
+ * @brief Bits sorted per radix sort pass.
+ */
+static constexpr uint32_t gRadixBits = 8;
+
+/**
+ * @brief Append a field to a key.
+ */
+static auto append(uint64_t key, uint32_t value, uint32_t bits) -> uint64_t {
+	return (key << bits) | (value & ((1ull << bits) - 1));
+}
+
+auto RenderQueue::makeKey(const SortKeyFields &fields) -> uint64_t {
+	const auto max_depth = static_cast<float>((1u << gDepthBits) - 1);
+	const auto depth     = std::clamp(fields.depth, 0.0f, 1.0f);
+	auto       quantized = static_cast<uint32_t>(std::round(depth * max_depth));
+	if (fields.back_to_front)
+		quantized = static_cast<uint32_t>(max_depth) - quantized;
+
+	auto key = uint64_t(0);
+	key      = append(key, fields.pass, gPassBits);
+	key      = append(key, fields.layer, gLayerBits);
+	key      = append(key, fields.program, gProgramBits);
+	key      = append(key, fields.material, gMaterialBits);
+	key      = append(key, fields.mesh, gMeshBits);
+	key      = append(key, quantized, gDepthBits);
+
+	return key;
+}
+
+void RenderQueue::radixSort(std::vector<SortEntry> &entries,
+                            std::vector<SortEntry> &scratch) {
+	constexpr auto buckets = size_t(1) << gRadixBits;
+	constexpr auto mask    = buckets - 1;
+
+	scratch.resize(entries.size());
+	for (uint32_t shift = 0; shift < 64; shift += gRadixBits) {
+		std::array<size_t, buckets> counts{};
+		for (const auto &entry : entries)
+			counts[(entry.key >> shift) & mask]++;
+
+		// Every key has the same digit, the pass would not move anything
+		if (std::find(begin(counts), end(counts), entries.size()) !=
+		    end(counts))
+			continue;
+
+		// Scatter into place, stable within a bucket
+		auto offset = size_t(0);
+		for (auto &count : counts)
+			offset += std::exchange(count, offset);
+		for (const auto &entry : entries)
+			scratch[counts[(entry.key >> shift) & mask]++] = entry;
+
+		entries.swap(scratch);
+	}
+}
+
+void RenderQueue::submit(RenderItem item) {
+	assert(item.program != nullptr);
+
+	m_entries.push_back({item.key, static_cast<uint32_t>(m_items.size())});
+	m_items.push_back(std::move(item));
+}
+
+void RenderQueue::flush() {
+	radixSort(m_entries, m_scratch);
+
+	const ShaderProgram * program  = nullptr;
+	const RenderCallback *material = nullptr;
+	for (const auto &entry : m_entries) {
+		auto &item = m_items[entry.index];
+
+		// A new program has none of the previous material's uniforms
+		if (item.program != program) {
+			item.program->use();
+			program  = item.program;
+			material = nullptr;
+		}
+
+		if (item.material != material && item.material != nullptr)
+			(*item.material)(*item.program);
+		material = item.material;
+
+		item.draw(*item.program);
+	}
+
+	m_items.clear();
+	m_entries.clear();
+}
@@ -0,0 +1,108 @@
+#include <algorithm>
+#include <cassert>
+#include <glove/RenderTargetPool.h>
+#include <glove/StateCache.h>
+
+/**
+ * @brief Number of frames a target may go unused before it is freed.
+ */
+static constexpr uint64_t gMaxIdleFrames = 3;
+
+/**
+ * @brief Get the sized internal format of a type of attachment.
+ */
+static auto internal_format(AttachmentType type) -> GLenum {
+	switch (type) {
+		case AttachmentType::Color: return GL_RGB8;
+		case AttachmentType::Depth: return GL_DEPTH_COMPONENT32F;
+		case AttachmentType::DepthStencil: return GL_DEPTH24_STENCIL8;
+	}
+
+	return GL_NONE;
+}
+
+/**
+ * @brief Allocate a texture matching a description.
+ */
+static auto create_texture(const RenderTargetDesc &desc) -> GLuint {
+	GLuint texture;
+
+	if (desc.samples > 1) {
+		glGenTextures(1, &texture);
+		StateCache::get().bindTexture(GL_TEXTURE_2D_MULTISAMPLE, texture);
+		glTexStorage2DMultisample(GL_TEXTURE_2D_MULTISAMPLE, desc.samples,
+		                          internal_format(desc.type),
+		                          desc.dimensions.x, desc.dimensions.y,
+		                          GL_TRUE);
+		return texture;
+	}
+
+	glGenTextures(1, &texture);
+	StateCache::get().bindTexture(GL_TEXTURE_2D, texture);
+	glTexStorage2D(GL_TEXTURE_2D, 1, internal_format(desc.type),
+	               desc.dimensions.x, desc.dimensions.y);
+
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+	return texture;
+}
+
+RenderTarget::RenderTarget(RenderTargetPool &pool, const RenderTargetDesc &desc,
+                           GLuint texture)
+    : m_pool(pool), m_desc(desc), m_texture(texture) {}
+
+RenderTarget::~RenderTarget() { m_pool.release(m_desc, m_texture); }
+
+void RenderTarget::bindToSlot(GLuint slot) const {
+	StateCache::get().bindTexture(slot,
+	                              m_desc.samples > 1 ? GL_TEXTURE_2D_MULTISAMPLE
+	                                                 : GL_TEXTURE_2D,
+	                              m_texture);
+}
+
+RenderTargetPool::~RenderTargetPool() {
+	assert(m_leased == 0 && "Render targets outlived their pool");
+
+	for (const auto &target : m_free)
+		StateCache::get().deleteTextures(1, &target.texture);
+}
+
+auto RenderTargetPool::acquire(const RenderTargetDesc &desc)
+    -> std::unique_ptr<RenderTarget> {
+	m_leased++;
+
+	// Reuse the most recently released match, it is the most likely to
+	// still be resident
+	const auto match =
+	    std::find_if(m_free.rbegin(), m_free.rend(),
+	                 [&](const auto &target) { return target.desc == desc; });
+	if (match != m_free.rend()) {
+		const auto texture = match->texture;
+		m_free.erase(std::next(match).base());
+		return std::make_unique<RenderTarget>(*this, desc, texture);
+	}
+
+	return std::make_unique<RenderTarget>(*this, desc, create_texture(desc));
+}
+
+void RenderTargetPool::release(const RenderTargetDesc &desc, GLuint texture) {
+	assert(m_leased > 0);
+
+	m_leased--;
+	m_free.push_back({desc, texture, m_frame});
+}
+
+void RenderTargetPool::endFrame() {
+	m_frame++;
+
+	// Free the targets that have been idle for too long, e.g. the old sizes
+	// after a resize
+	const auto idle = std::stable_partition(
+	    begin(m_free), end(m_free), [&](const auto &target) {
+		    return m_frame - target.last_used <= gMaxIdleFrames;
+	    });
+	for (auto it = idle; it != end(m_free); ++it)
+		StateCache::get().deleteTextures(1, &it->texture);
+	m_free.erase(idle, end(m_free));
+}
@@ -2,6 +2,7 @@
 #include <fstream>
 #include <glm/gtc/type_ptr.hpp>
 #include <glove/ShaderProgram.h>
+#include <glove/StateCache.h>
 #include <iostream>
 
 ShaderProgram::ShaderProgram(const std::initializer_list<std::string> paths) {
@@ -32,6 +33,8 @@ ShaderProgram::ShaderProgram(const std::initializer_list<std::string> paths) {
 			type = GL_GEOMETRY_SHADER;
 		else if (path.find(".frag") != std::string::npos)
 			type = GL_FRAGMENT_SHADER;
+		else if (path.find(".comp") != std::string::npos)
+			type = GL_COMPUTE_SHADER;
 		else {
 			std::cout << "Error: Shader with unknown file extension: " << path
 			          << std::endl;
@@ -123,9 +126,15 @@ ShaderProgram::ShaderProgram(const std::initializer_list<std::string> paths) {
 	}
 }
 
-ShaderProgram::~ShaderProgram() { glDeleteProgram(m_program); }
+ShaderProgram::~ShaderProgram() { StateCache::get().deleteProgram(m_program); }
 
-void ShaderProgram::use() const { glUseProgram(m_program); }
+void ShaderProgram::use() const { StateCache::get().useProgram(m_program); }
+
+void ShaderProgram::dispatch(GLuint groups_x, GLuint groups_y,
+                             GLuint groups_z) const {
+	use();
+	glDispatchCompute(groups_x, groups_y, groups_z);
+}
 
 void ShaderProgram::setUniform(const std::string &name, const GLuint x) {
 	glUniform1i(m_uniforms.at(name).location, x);
@@ -170,3 +179,39 @@ void ShaderProgram::setUniform(const std::string &     name,
 	setUniform(name + ".direction", v.direction);
 	setUniform(name + ".specularity", v.specularity);
 }
+
+void ShaderProgram::setUniform(const std::string &       name,
+                               const std::vector<float> &v) {
+	const auto *array = findArray(name);
+	if (array == nullptr || v.empty())
+		return;
+
+	glUniform1fv(array->location, v.size(), v.data());
+}
+
+void ShaderProgram::setUniform(const std::string &           name,
+                               const std::vector<glm::vec4> &v) {
+	const auto *array = findArray(name);
+	if (array == nullptr || v.empty())
+		return;
+
+	glUniform4fv(array->location, v.size(), glm::value_ptr(v.front()));
+}
+
+void ShaderProgram::setUniform(const std::string &           name,
+                               const std::vector<glm::mat4> &v) {
+	const auto *array = findArray(name);
+	if (array == nullptr || v.empty())
+		return;
+
+	glUniformMatrix4fv(array->location, v.size(), GL_FALSE,
+	                   glm::value_ptr(v.front()));
+}
+
+auto ShaderProgram::findArray(const std::string &name) const
+    -> const UniformSpec * {
+	// Arrays are reported by the name of their first element, and not at all
+	// if no element is used
+	const auto it = m_uniforms.find(name + "[0]");
+	return it != m_uniforms.end() ? &it->second : nullptr;
+}
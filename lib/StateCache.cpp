@@ -0,0 +1,169 @@
+#include <glove/StateCache.h>
+
+StateCache::StateCache() : m_frame{0, 0}, m_last_frame{0, 0} {}
+
+auto StateCache::get() -> StateCache & {
+	static StateCache cache;
+	return cache;
+}
+
+void StateCache::invalidate() {
+	m_program    = std::nullopt;
+	m_vao        = std::nullopt;
+	m_read_fbo   = std::nullopt;
+	m_draw_fbo   = std::nullopt;
+	m_viewport   = std::nullopt;
+	m_blend_func = std::nullopt;
+	m_depth_func = std::nullopt;
+	m_depth_mask = std::nullopt;
+	m_color_mask = std::nullopt;
+	m_cull_face  = std::nullopt;
+	m_textures.clear();
+	m_capabilities.clear();
+}
+
+void StateCache::endFrame() {
+	m_last_frame = m_frame;
+	m_frame      = {0, 0};
+}
+
+void StateCache::useProgram(GLuint program) {
+	if (change(m_program, program))
+		glUseProgram(program);
+}
+
+void StateCache::bindVertexArray(GLuint vao) {
+	if (change(m_vao, vao))
+		glBindVertexArray(vao);
+}
+
+void StateCache::bindFramebuffer(GLenum target, GLuint fbo) {
+	switch (target) {
+		case GL_READ_FRAMEBUFFER:
+			if (change(m_read_fbo, fbo))
+				glBindFramebuffer(target, fbo);
+			break;
+		case GL_DRAW_FRAMEBUFFER:
+			if (change(m_draw_fbo, fbo))
+				glBindFramebuffer(target, fbo);
+			break;
+		default: {
+			// Binding both counts as one call, and is only skipped if both
+			// are already bound
+			if (m_read_fbo == fbo && m_draw_fbo == fbo) {
+				m_frame.skipped++;
+				break;
+			}
+
+			m_frame.issued++;
+			m_read_fbo = fbo;
+			m_draw_fbo = fbo;
+			glBindFramebuffer(target, fbo);
+			break;
+		}
+	}
+}
+
+void StateCache::setViewport(glm::ivec4 viewport) {
+	if (change(m_viewport, viewport))
+		glViewport(viewport.x, viewport.y, viewport.z, viewport.w);
+}
+
+void StateCache::bindTexture(GLuint unit, GLenum target, GLuint texture) {
+	if (!change(m_textures[{unit, target}], texture))
+		return;
+
+	// Binding no texture unbinds every target of the unit
+	if (texture == 0) {
+		for (auto &[binding, bound] : m_textures)
+			if (binding.first == unit)
+				bound = 0;
+	}
+
+	// Binds by unit leave the active unit alone, and unlike glBindTexture
+	// they can be traced
+	glBindTextureUnit(unit, texture);
+}
+
+void StateCache::bindTexture(GLenum target, GLuint texture) {
+	// Glove never changes the active unit, but the application might, so the
+	// binding can not be remembered, and it replaces whatever the cache knows
+	// to be bound to the target on that unit
+	for (auto &[binding, bound] : m_textures)
+		if (binding.second == target)
+			bound = std::nullopt;
+
+	m_frame.issued++;
+	glBindTexture(target, texture);
+}
+
+void StateCache::setEnabled(GLenum capability, bool enabled) {
+	if (!change(m_capabilities[capability], enabled))
+		return;
+
+	if (enabled)
+		glEnable(capability);
+	else
+		glDisable(capability);
+}
+
+void StateCache::setBlendFunc(GLenum source, GLenum destination) {
+	if (change(m_blend_func, std::make_pair(source, destination)))
+		glBlendFunc(source, destination);
+}
+
+void StateCache::setDepthFunc(GLenum func) {
+	if (change(m_depth_func, func))
+		glDepthFunc(func);
+}
+
+void StateCache::setDepthMask(bool write) {
+	if (change(m_depth_mask, write))
+		glDepthMask(write ? GL_TRUE : GL_FALSE);
+}
+
+void StateCache::setColorMask(bool write) {
+	if (!change(m_color_mask, write))
+		return;
+
+	const auto mask = write ? GL_TRUE : GL_FALSE;
+	glColorMask(mask, mask, mask, mask);
+}
+
+void StateCache::setCullFace(GLenum mode) {
+	if (change(m_cull_face, mode))
+		glCullFace(mode);
+}
+
+void StateCache::deleteProgram(GLuint program) {
+	// A deleted program stays in use until another one is used, but its name
+	// may be reused by a new program
+	if (m_program == program)
+		m_program = std::nullopt;
+	glDeleteProgram(program);
+}
+
+void StateCache::deleteVertexArray(GLuint vao) {
+	// Deleting a bound object reverts the binding to zero
+	if (m_vao == vao)
+		m_vao = 0;
+	glDeleteVertexArrays(1, &vao);
+}
+
+void StateCache::deleteFramebuffer(GLuint fbo) {
+	if (m_read_fbo == fbo)
+		m_read_fbo = 0;
+	if (m_draw_fbo == fbo)
+		m_draw_fbo = 0;
+	glDeleteFramebuffers(1, &fbo);
+}
+
+void StateCache::deleteTextures(GLsizei count, const GLuint *textures) {
+	for (GLsizei i = 0; i < count; ++i) {
+		for (auto &[binding, texture] : m_textures) {
+			if (texture == textures[i])
+				texture = 0;
+		}
+	}
+	glDeleteTextures(count, textures);
+}
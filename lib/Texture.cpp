@@ -3,6 +3,7 @@
  * details */
 #define STB_IMAGE_IMPLEMENTATION
 
+#include <glove/StateCache.h>
 #include <glove/Texture.h>
 #include <stb_image.h>
 
@@ -37,7 +38,7 @@ Texture::Texture(const std::string &path, GLuint type) {
 
 	// Create the texture
 	glGenTextures(1, &m_handle);
-	glBindTexture(GL_TEXTURE_2D, m_handle);
+	StateCache::get().bindTexture(GL_TEXTURE_2D, m_handle);
 
 	// Set texture parameters
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
@@ -60,9 +61,8 @@ Texture::Texture(const std::string &path, GLuint type) {
 	stbi_image_free(data);
 }
 
-Texture::~Texture() { glDeleteTextures(1, &m_handle); }
+Texture::~Texture() { StateCache::get().deleteTextures(1, &m_handle); }
 
 void Texture::bindToSlot(unsigned int slot) {
-	glActiveTexture(GL_TEXTURE0 + slot);
-	glBindTexture(GL_TEXTURE_2D, m_handle);
+	StateCache::get().bindTexture(slot, GL_TEXTURE_2D, m_handle);
 }
@@ -0,0 +1,43 @@
+#include <algorithm>
+#include <glove/ThreadPool.h>
+
+ThreadPool::ThreadPool(size_t thread_count) : m_stopping(false) {
+	thread_count = std::max<size_t>(thread_count, 1);
+
+	m_threads.reserve(thread_count);
+	for (size_t i = 0; i < thread_count; ++i)
+		m_threads.emplace_back(&ThreadPool::work, this);
+}
+
+ThreadPool::~ThreadPool() {
+	{
+		std::lock_guard lock(m_mutex);
+		m_stopping = true;
+
+		// Dropping the jobs destroys their packaged tasks, which breaks the
+		// promises of the futures waiting on them
+		m_jobs = {};
+	}
+	m_condition.notify_all();
+
+	for (auto &thread : m_threads)
+		thread.join();
+}
+
+void ThreadPool::work() {
+	while (true) {
+		std::function<void()> job;
+		{
+			std::unique_lock lock(m_mutex);
+			m_condition.wait(
+			    lock, [this]() { return m_stopping || !m_jobs.empty(); });
+			if (m_stopping)
+				return;
+
+			job = std::move(m_jobs.front());
+			m_jobs.pop();
+		}
+
+		job();
+	}
+}
@@ -1,3 +1,5 @@
+#include <glove/CommandList.h>
+#include <glove/StateCache.h>
 #include <glove/VertexBuffer.h>
 #include <glove/VertexFormats.h>
 
@@ -10,7 +12,7 @@ VertexBuffer<VertexFormat>::VertexBuffer(size_t size, bool indexed,
 	m_usage           = usage;
 
 	glGenVertexArrays(1, &m_vao);
-	glBindVertexArray(m_vao);
+	StateCache::get().bindVertexArray(m_vao);
 
 	glGenBuffers(1, &m_vbo);
 	glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
@@ -36,7 +38,7 @@ VertexBuffer<VertexFormat>::VertexBuffer(
 
 	// Generate a vao
 	glGenVertexArrays(1, &m_vao);
-	glBindVertexArray(m_vao);
+	StateCache::get().bindVertexArray(m_vao);
 
 	// Generate a vbo
 	glGenBuffers(1, &m_vbo);
@@ -50,26 +52,35 @@ VertexBuffer<VertexFormat>::VertexBuffer(
 template <typename VertexFormat>
 VertexBuffer<VertexFormat>::VertexBuffer(
     const std::vector<VertexFormat> &vertices,
-    const std::vector<GLuint> &      indices) {
+    const std::vector<GLuint> &      indices)
+    : VertexBuffer(vertices.data(), vertices.size(), indices.data(),
+                   indices.size()) {}
+
+template <typename VertexFormat>
+VertexBuffer<VertexFormat>::VertexBuffer(const VertexFormat *vertices,
+                                         size_t vertex_count,
+                                         const GLuint *indices,
+                                         size_t        index_count) {
 	m_instanced       = false;
 	m_indexed         = true;
-	m_primitive_count = indices.size();
+	m_primitive_count = index_count;
+	m_usage           = GL_STATIC_DRAW;
 
 	// Generate a vertex array
 	glGenVertexArrays(1, &m_vao);
-	glBindVertexArray(m_vao);
+	StateCache::get().bindVertexArray(m_vao);
 
 	// Generate a vertex buffer
 	glGenBuffers(1, &m_vbo);
 	glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
-	glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(VertexFormat),
-	             vertices.data(), GL_STATIC_DRAW);
+	glBufferData(GL_ARRAY_BUFFER, vertex_count * sizeof(VertexFormat),
+	             vertices, GL_STATIC_DRAW);
 
 	// Generate element buffer
 	glGenBuffers(1, &m_ebo);
 	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_ebo);
-	glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(GLuint),
-	             indices.data(), GL_STATIC_DRAW);
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, index_count * sizeof(GLuint),
+	             indices, GL_STATIC_DRAW);
 
 	setVertexAttribs<VertexFormat>();
 }
@@ -84,12 +95,12 @@ VertexBuffer<VertexFormat>::~VertexBuffer() {
 	if (m_instanced)
 		glDeleteBuffers(1, &m_instance_vbo);
 
-	glDeleteVertexArrays(1, &m_vao);
+	StateCache::get().deleteVertexArray(m_vao);
 }
 
 template <typename VertexFormat>
 void VertexBuffer<VertexFormat>::draw() const {
-	glBindVertexArray(m_vao);
+	StateCache::get().bindVertexArray(m_vao);
 
 	// Draw the VBO using the appropriate gl command
 	if (m_instanced) {
@@ -101,15 +112,74 @@ void VertexBuffer<VertexFormat>::draw() const {
 			                      m_instance_count);
 		}
 	} else {
+		// The OpenGL 1.1 draws can not be traced, these are the same
 		if (m_indexed) {
-			glDrawElements(GL_TRIANGLES, m_primitive_count, GL_UNSIGNED_INT,
-			               nullptr);
+			glDrawElementsBaseVertex(GL_TRIANGLES, m_primitive_count,
+			                         GL_UNSIGNED_INT, nullptr, 0);
 		} else {
-			glDrawArrays(GL_TRIANGLES, 0, m_primitive_count);
+			glDrawArraysInstanced(GL_TRIANGLES, 0, m_primitive_count, 1);
 		}
 	}
 }
 
+template <typename VertexFormat>
+void VertexBuffer<VertexFormat>::drawRange(GLuint index_offset,
+                                           GLuint index_count,
+                                           GLint  base_vertex) const {
+	assert(m_indexed);
+
+	if (m_instanced) {
+		drawRangeInstanced(index_offset, index_count, base_vertex, 0,
+		                   m_instance_count);
+		return;
+	}
+
+	StateCache::get().bindVertexArray(m_vao);
+	glDrawElementsBaseVertex(
+	    GL_TRIANGLES, index_count, GL_UNSIGNED_INT,
+	    reinterpret_cast<const void *>(index_offset * sizeof(GLuint)),
+	    base_vertex);
+}
+
+template <typename VertexFormat>
+void VertexBuffer<VertexFormat>::drawRangeInstanced(
+    GLuint index_offset, GLuint index_count, GLint base_vertex,
+    GLuint first_instance, GLuint instance_count) const {
+	assert(m_indexed && m_instanced);
+
+	StateCache::get().bindVertexArray(m_vao);
+	glDrawElementsInstancedBaseVertexBaseInstance(
+	    GL_TRIANGLES, index_count, GL_UNSIGNED_INT,
+	    reinterpret_cast<const void *>(index_offset * sizeof(GLuint)),
+	    instance_count, base_vertex, first_instance);
+}
+
+template <typename VertexFormat>
+void VertexBuffer<VertexFormat>::recordRange(CommandList &list,
+                                             GLuint       index_offset,
+                                             GLuint       index_count,
+                                             GLint        base_vertex) const {
+	assert(m_indexed);
+
+	list.drawElements(m_vao, index_offset, index_count, base_vertex, 0,
+	                  m_instanced ? m_instance_count : 1);
+}
+
+template <typename VertexFormat>
+void VertexBuffer<VertexFormat>::drawIndirect(const Buffer &commands,
+                                              size_t        first_command,
+                                              size_t command_count) const {
+	assert(m_indexed);
+
+	StateCache::get().bindVertexArray(m_vao);
+	commands.bind(GL_DRAW_INDIRECT_BUFFER);
+	glMultiDrawElementsIndirect(
+	    GL_TRIANGLES, GL_UNSIGNED_INT,
+	    reinterpret_cast<const void *>(first_command *
+	                                   sizeof(DrawElementsIndirectCommand)),
+	    static_cast<GLsizei>(command_count), 0);
+}
+
 template <typename VertexFormat>
 void VertexBuffer<VertexFormat>::uploadWhole(
     const std::vector<VertexFormat> &vertices,
@@ -142,7 +212,7 @@ void VertexBuffer<VertexFormat>::enableInstancing() {
 	glBindBuffer(GL_ARRAY_BUFFER, m_instance_vbo);
 
 	// Associate the new VBO with the preexisting VAO
-	glBindVertexArray(m_vao);
+	StateCache::get().bindVertexArray(m_vao);
 	setVertexAttribs<InstanceFormat>();
 }
 
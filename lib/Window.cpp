@@ -55,7 +55,7 @@ static auto glfw_to_inputcode(int key) {
 }
 
 Window::Window(const std::string &title, const uint32_t width,
-               const uint32_t height) {
+               const uint32_t height, const ContextMode mode) {
 	// Initialize glfw
 	if (glfwInit() == GLFW_FALSE) {
 		throw std::runtime_error("GLFW3 Failed to initialize.");
@@ -71,7 +71,11 @@ Window::Window(const std::string &title, const uint32_t width,
 	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 5);
 	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
 	glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GLFW_TRUE);
-	glfwWindowHint(GLFW_OPENGL_DEBUG_CONTEXT, GLFW_TRUE);
+	// A release context skips the driver's validation and error checks
+	if (mode == ContextMode::Debug)
+		glfwWindowHint(GLFW_OPENGL_DEBUG_CONTEXT, GLFW_TRUE);
+	else
+		glfwWindowHint(GLFW_CONTEXT_NO_ERROR, GLFW_TRUE);
 	glfwWindowHint(GLFW_SAMPLES, 4);
 	m_window = glfwCreateWindow(width, height, title.c_str(), nullptr, nullptr);
 	if (m_window == nullptr) {
@@ -79,10 +83,9 @@ Window::Window(const std::string &title, const uint32_t width,
 	}
 
 	glfwMakeContextCurrent(m_window);
-	glfwSwapInterval(1);
 
 	// Setup input queue
-	m_input_queue = std::make_shared<std::deque<Input>>();
+	m_input_queue = std::make_shared<InputQueue::element_type>();
 
 	// Setup key callback
 	auto input = m_input_queue; // Get a copy of the input queue pointer for
@@ -100,8 +103,10 @@ Window::Window(const std::string &title, const uint32_t width,
 			default: throw std::runtime_error("Unknown GLFW action!");
 		}
 
-		auto i = Input{code, state};
-		input->push_back(i);
+		// Stamped as they arrive, as one poll may receive several events. A
+		// full ring means the game has stopped reading, so the event is
+		// dropped.
+		input->push(Input{code, state, glfwGetTime()});
 	};
 
 	// Hack to make the key callback to work with lambda's that capture the
@@ -126,10 +131,19 @@ Window::Window(const std::string &title, const uint32_t width,
 		throw std::runtime_error("GLEW Failed to initialize.");
 	}
 
+	// The new context starts out with default state, not whatever an earlier
+	// context was left with
+	StateCache::get().invalidate();
+
 	// Enable debugging
-	glEnable(GL_DEBUG_OUTPUT);
-	glEnable(GL_DEBUG_OUTPUT_SYNCHRONOUS);
-	glDebugMessageCallback(glDebugOutput, nullptr);
+	if (mode == ContextMode::Debug) {
+		glEnable(GL_DEBUG_OUTPUT);
+		glEnable(GL_DEBUG_OUTPUT_SYNCHRONOUS);
+		glDebugMessageCallback(glDebugOutput, nullptr);
+	}
+
+	// Sets the swap interval, and bounds the frames in flight
+	m_pacer = std::make_unique<FramePacer>();
 
 	glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
 
@@ -139,25 +153,25 @@ Window::Window(const std::string &title, const uint32_t width,
 }
 
 Window::~Window() {
+	// The pacer's fences belong to the context
+	m_pacer.reset();
+
 	glfwDestroyWindow(m_window);
 	glfwTerminate();
 }
 
 bool Window::pollEvents() {
-	// Clear the input queue to avoid storing all the input events for the
-	// entire game
-	m_input_queue->clear();
-
-	// THEN poll events
 	glfwPollEvents();
 
 	return glfwWindowShouldClose(m_window);
 }
 
 void Window::swapBuffers() {
+	m_pacer->beforeSwap();
 	glfwSwapBuffers(m_window);
+	m_pacer->afterSwap();
 
-	auto now     = std::chrono::steady_clock::now();
+	auto now     = m_pacer->getPresentTimes().back();
 	m_delta_time = (now - m_prev_frame).count() / 1000000000.0f;
 	m_prev_frame = now;
 
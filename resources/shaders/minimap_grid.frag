@@ -0,0 +1,30 @@
+#version 450 core
+
+// Must match EntityType on the CPU side
+#define WALL 1u
+#define PELLET 4u
+
+in vec2 v_texcoord;
+
+out vec4 frag_color;
+
+uniform usampler2D u_grid;
+uniform ivec2 u_level_size;
+
+void main() {
+    // The map is seen from above, with the x axis of the level to the left
+    vec2 position = vec2(1.0 - v_texcoord.x, v_texcoord.y) * vec2(u_level_size);
+    ivec2 cell = clamp(ivec2(position), ivec2(0), u_level_size - 1);
+    uint entity = texelFetch(u_grid, cell, 0).r;
+
+    bool dot = distance(fract(position), vec2(0.5)) < 0.15;
+    bool pellet = entity == PELLET && dot;
+
+    if (entity == WALL) {
+        frag_color = vec4(1.0, 0.0, 0.0, 1.0);
+    } else if (pellet) {
+        frag_color = vec4(1.0, 1.0, 0.0, 1.0);
+    } else {
+        frag_color = vec4(0.0, 0.0, 0.0, 1.0);
+    }
+}
@@ -0,0 +1,11 @@
+#version 450 core
+
+out vec2 v_texcoord;
+
+void main() {
+    // One triangle covering the whole viewport, generated from the vertex id
+    vec2 position = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2);
+    v_texcoord = position;
+
+    gl_Position = vec4(position * 2.0 - 1.0, 0.0, 1.0);
+}
@@ -0,0 +1,13 @@
+#version 450 core
+
+in vec4 v_color;
+
+out vec4 frag_color;
+
+void main() {
+    // Round sprites
+    if (distance(gl_PointCoord, vec2(0.5)) > 0.5)
+        discard;
+
+    frag_color = v_color;
+}
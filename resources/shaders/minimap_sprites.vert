@@ -0,0 +1,25 @@
+#version 450 core
+
+struct Sprite {
+    vec4 position; // Position in cells in xy, radius in cells in z
+    vec4 color;
+};
+
+layout(std430, binding = 0) readonly buffer Sprites {
+    Sprite sprites[];
+};
+
+out vec4 v_color;
+
+uniform ivec2 u_level_size;
+uniform float u_pixels_per_cell;
+
+void main() {
+    Sprite sprite = sprites[gl_VertexID];
+    v_color = sprite.color;
+
+    // Mirrored in x like the grid
+    vec2 uv = sprite.position.xy / vec2(u_level_size);
+    gl_Position = vec4(1.0 - 2.0 * uv.x, 2.0 * uv.y - 1.0, 0.0, 1.0);
+    gl_PointSize = 2.0 * sprite.position.z * u_pixels_per_cell;
+}
@@ -1,7 +1,11 @@
 #version 450 core
 
+// Must match gMaxCascades on the CPU side
+#define MAX_CASCADES 4
+
 in vec3 v_frag_pos;
-in vec4 v_frag_pos_light_space;
+in vec3 v_world_pos;
+in float v_view_depth;
 in vec3 v_normal;
 in vec2 v_texcoord;
 in vec3 v_view_pos;
@@ -9,7 +13,10 @@ in vec3 v_view_pos;
 out vec4 frag_color;
 
 uniform sampler2D u_diffuse_map;
-uniform sampler2D u_shadow_map;
+uniform sampler2DArray u_shadow_map;
+uniform mat4 u_light_space_matrices[MAX_CASCADES];
+uniform float u_cascade_splits[MAX_CASCADES];
+uniform int u_cascade_count;
 uniform vec4 u_model_color;
 uniform struct DirectionalLight {
     vec3 color;
@@ -17,12 +24,46 @@ uniform struct DirectionalLight {
     float specularity;
 } u_directional_light;
 
+// Point lights binned into clusters, see ClusteredLights
+struct PointLight {
+    vec3 position;
+    float radius;
+    vec3 color;
+    float intensity;
+};
+
+layout(std430, binding = 3) readonly buffer Lights {
+    PointLight lights[];
+};
+
+layout(std430, binding = 4) readonly buffer ClusterCounts {
+    uint cluster_counts[];
+};
+
+layout(std430, binding = 5) readonly buffer ClusterIndices {
+    uint cluster_indices[];
+};
+
+uniform ivec3 u_cluster_grid;
+uniform vec2 u_cluster_depth_range;
+uniform vec2 u_cluster_viewport;
+uniform int u_max_lights_per_cluster;
+
 /*
  * Calculates if the fragment is in shadow or not.
  */
 float compute_shadow() {
+    // Pick the first cascade that reaches the fragment, there are no shadows
+    // beyond the last one
+    int cascade = 0;
+    while (cascade < u_cascade_count && v_view_depth > u_cascade_splits[cascade])
+        cascade++;
+    if (cascade == u_cascade_count)
+        return 0.0;
+
     // Where should we sample the shadow map?
-    vec3 proj_coords = v_frag_pos_light_space.xyz / v_frag_pos_light_space.w;
+    vec4 frag_pos_light_space = u_light_space_matrices[cascade] * vec4(v_world_pos, 1.0);
+    vec3 proj_coords = frag_pos_light_space.xyz / frag_pos_light_space.w;
     proj_coords = proj_coords * 0.5 + 0.5;
     float current_depth = proj_coords.z;
 
@@ -30,13 +71,13 @@ float compute_shadow() {
      float bias = max(0.005 * (1.0 - dot(v_normal, u_directional_light.direction)), 0.0005);
 
     float shadow = 0.0;
-    vec2 texel_size = 1.0 / textureSize(u_shadow_map, 0);
+    vec2 texel_size = 1.0 / textureSize(u_shadow_map, 0).xy;
 
     // Percentage closer filtering
     // Based on brute force implementation from [GPU Gems](https://developer.nvidia.com/gpugems/gpugems/part-ii-lighting-and-shadows/chapter-11-shadow-map-antialiasing)
     for (float x = -2.5; x <= 2.5; x += 0.5) {
         for (float y = -2.5; y <= 2.5; y += 0.5) {
-            float pcf_depth = texture(u_shadow_map, proj_coords.xy + vec2(x, y) * texel_size).r;
+            float pcf_depth = texture(u_shadow_map, vec3(proj_coords.xy + vec2(x, y) * texel_size, cascade)).r;
             shadow += current_depth - bias > pcf_depth ? 1.0 : 0.0;
         }
     }
@@ -71,10 +112,45 @@ vec3 compute_directional_light() {
 }
 
 /*
- * Compute a point light's color contribution to the fragment color.
+ * Compute the point lights' color contribution to the fragment color. Only
+ * the lights in the fragment's cluster are considered.
  */
 vec3 compute_point_light() {
-    return vec3(0.0, 0.0, 0.0);
+    // No clusters are bound
+    if (u_cluster_grid.z == 0)
+        return vec3(0.0, 0.0, 0.0);
+
+    // Find the cluster from the position on screen and the depth, the slices
+    // are spaced exponentially like in cluster_lights.comp
+    vec2 depth_range = u_cluster_depth_range;
+    vec2 tile = gl_FragCoord.xy / u_cluster_viewport * vec2(u_cluster_grid.xy);
+    float depth = max(v_view_depth, depth_range.x);
+    float slice =
+        log(depth / depth_range.x) / log(depth_range.y / depth_range.x);
+    ivec3 id = ivec3(ivec2(tile), int(slice * float(u_cluster_grid.z)));
+    id = clamp(id, ivec3(0), u_cluster_grid - 1);
+    int cluster = (id.z * u_cluster_grid.y + id.y) * u_cluster_grid.x + id.x;
+
+    vec3 color = vec3(0.0, 0.0, 0.0);
+    int first = cluster * u_max_lights_per_cluster;
+    uint count = cluster_counts[cluster];
+    for (uint i = 0; i < count; ++i) {
+        PointLight light = lights[cluster_indices[first + int(i)]];
+
+        vec3 to_light = light.position - v_world_pos;
+        float light_distance = max(length(to_light), 0.0001);
+
+        // Inverse square falloff, windowed to reach zero at the radius
+        float falloff = pow(light_distance / light.radius, 4.0);
+        float window = clamp(1.0 - falloff, 0.0, 1.0);
+        float attenuation =
+            window * window / (light_distance * light_distance + 1.0);
+
+        float diffuse = max(dot(v_normal, to_light / light_distance), 0.0);
+        color += diffuse * attenuation * light.intensity * light.color;
+    }
+
+    return color;
 }
 
 void main() {
@@ -5,20 +5,26 @@ layout(location = 1) in vec3 a_normal;
 layout(location = 2) in vec2 a_texcoord;
 
 out vec3 v_frag_pos;
-out vec4 v_frag_pos_light_space;
+out vec3 v_world_pos;
+out float v_view_depth;
 out vec3 v_normal;
 out vec2 v_texcoord;
 out vec3 v_view_pos;
 
+// Matches the depth pre-pass, see model_depth.vert
+invariant gl_Position;
+
 uniform mat4 u_projection;
 uniform mat4 u_view;
 uniform mat4 u_transform;
-uniform mat4 u_light_space_matrix;
 
 void main() {
     v_frag_pos = a_position;
 
-    v_frag_pos_light_space = u_light_space_matrix * u_transform * vec4(a_position, 1.0);
+    // Shadows are looked up in world space, in the cascade picked by depth
+    vec4 world_pos = u_transform * vec4(a_position, 1.0);
+    v_world_pos = world_pos.xyz;
+    v_view_depth = -(u_view * world_pos).z;
 
     // FIXME: Does not handle rotation
 //    mat3 norm_mat = transpose(inverse(mat3(u_transform)));
@@ -30,5 +36,5 @@ void main() {
 
     v_view_pos = u_view[3].xyz;
 
-    gl_Position = u_projection * u_view * u_transform * vec4(a_position, 1.0);
+    gl_Position = u_projection * u_view * world_pos;
 }
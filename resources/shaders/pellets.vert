@@ -6,19 +6,24 @@ layout(location = 2) in vec2 a_texcoord;
 layout(location = 4) in mat4 a_transform;
 
 out vec3 v_frag_pos;
-out vec4 v_frag_pos_light_space;
+out vec3 v_world_pos;
+out float v_view_depth;
 out vec3 v_normal;
 out vec2 v_texcoord;
 out vec3 v_view_pos;
 
+// Matches the depth pre-pass, see pellets_depth.vert
+invariant gl_Position;
+
 uniform mat4 u_view;
 uniform mat4 u_projection;
-uniform mat4 u_light_space_matrix;
 
 void main() {
     v_frag_pos = a_position;
 
-    v_frag_pos_light_space = u_light_space_matrix * a_transform * vec4(a_position, 1.0);
+    vec4 world_pos = a_transform * vec4(a_position, 1.0);
+    v_world_pos = world_pos.xyz;
+    v_view_depth = -(u_view * world_pos).z;
 
     mat3 norm_mat = mat3(transpose(inverse(a_transform)));
     v_normal = normalize(norm_mat * a_normal);
@@ -27,5 +32,5 @@ void main() {
 
     v_view_pos = u_view[3].xyz;
 
-    gl_Position = u_projection * u_view * a_transform * vec4(a_position, 1.0);
+    gl_Position = u_projection * u_view * world_pos;
 }
\ No newline at end of file
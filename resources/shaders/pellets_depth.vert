@@ -0,0 +1,17 @@
+#version 450 core
+
+layout(location = 0) in vec3 a_position;
+layout(location = 4) in mat4 a_transform;
+
+// Must compute gl_Position exactly like pellets.vert, the lit pass tests its
+// depth for equality against this one
+invariant gl_Position;
+
+uniform mat4 u_view;
+uniform mat4 u_projection;
+
+void main() {
+    vec4 world_pos = a_transform * vec4(a_position, 1.0);
+
+    gl_Position = u_projection * u_view * world_pos;
+}
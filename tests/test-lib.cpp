@@ -1,5 +1,6 @@
 #define CATCH_CONFIG_MAIN
 #include <catch2/catch.hpp>
+#include <fstream>
 #include <glove/lib.h>
 
 /**
@@ -37,4 +38,801 @@ TEST_CASE("Compile Shader Programs", "[shaders]") {
 		shader.setUniform("u_projection", glm::mat4(1.0f));
 		shader.setUniform("u_sprite_sheet", 0u);
 	}
+
+	SECTION("Pellet culling compute shader") {
+		auto shader = ShaderProgram({"resources/shaders/cull_pellets.comp"});
+		shader.use();
+		shader.setUniform("u_lod_errors", std::vector<float>{0.0f, 0.1f});
+		shader.setUniform("u_planes", std::vector<glm::vec4>(6));
+	}
+
+	SECTION("Light clustering compute shader") {
+		auto shader = ShaderProgram({"resources/shaders/cluster_lights.comp"});
+		shader.use();
+		shader.setUniform("u_grid", glm::ivec3(16, 9, 24));
+		shader.setUniform("u_depth_range", glm::vec2(0.1f, 50.0f));
+		shader.setUniform("u_inverse_projection", glm::mat4(1.0f));
+	}
+
+	SECTION("Depth pre-pass shaders") {
+		auto shader = ShaderProgram({"resources/shaders/model_depth.vert",
+		                             "resources/shaders/shadow.frag"});
+		shader.use();
+		shader.setUniform("u_transform", glm::mat4(1.0f));
+		shader.setUniform("u_view", glm::mat4(1.0f));
+		shader.setUniform("u_projection", glm::mat4(1.0f));
+	}
+
+	SECTION("Minimap shaders") {
+		auto grid = ShaderProgram({"resources/shaders/minimap_grid.vert",
+		                           "resources/shaders/minimap_grid.frag"});
+		grid.use();
+		grid.setUniform("u_grid", 0u);
+		grid.setUniform("u_level_size", glm::ivec2(28, 36));
+
+		auto sprites =
+		    ShaderProgram({"resources/shaders/minimap_sprites.vert",
+		                   "resources/shaders/minimap_sprites.frag"});
+		sprites.use();
+		sprites.setUniform("u_pixels_per_cell", 10.0f);
+	}
+}
+
+/**
+ * Test if a mesh survives a round trip through the binary mesh cache, and that
+ * the cache is rejected once the source file changes or its materials are
+ * corrupt.
+ */
+TEST_CASE("Mesh Cache Round Trip", "[model]") {
+	const auto source_path = std::string("mesh-cache-test.obj");
+	{
+		std::ofstream source(source_path);
+		source << "# Stand in for a model file\n";
+	}
+
+	MeshData mesh;
+	mesh.vertices = {
+	    {glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f), glm::vec2(0.0f)},
+	    {glm::vec3(1.0f, 0.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f),
+	     glm::vec2(1.0f, 0.0f)},
+	    {glm::vec3(0.0f, 0.0f, 1.0f), glm::vec3(0.0f, 1.0f, 0.0f),
+	     glm::vec2(0.0f, 1.0f)}};
+	mesh.indices   = {0, 1, 2};
+	mesh.submeshes = {Submesh{0, 3, 0, 0}};
+	mesh.materials = {Material{"wall", glm::vec4(1.0f), ""}};
+	mesh.bounds    = computeBounds(mesh.vertices);
+	mesh.submeshes[0].bounds = computeBounds(mesh, mesh.submeshes[0]);
+
+	mesh.optimizer_stats = {{3.0f, 1.5f}, {1.0f, 1.0f}};
+
+	REQUIRE(MeshCache::store(source_path, mesh));
+
+	SECTION("Unchanged source") {
+		const auto cache = MeshCache::load(source_path);
+		REQUIRE(cache != nullptr);
+		REQUIRE(cache->vertexCount() == mesh.vertices.size());
+		REQUIRE(cache->indexCount() == mesh.indices.size());
+		REQUIRE(cache->submeshes().size() == 1);
+		REQUIRE(cache->submeshes()[0].bounds.max == mesh.bounds.max);
+		REQUIRE(cache->vertices()[1].pos == mesh.vertices[1].pos);
+		REQUIRE(cache->indices()[2] == 2);
+		REQUIRE(cache->bounds().max == glm::vec3(1.0f, 0.0f, 1.0f));
+		REQUIRE(cache->materials().size() == 1);
+		REQUIRE(cache->materials()[0].name == "wall");
+		REQUIRE(cache->optimizerStats().before.acmr == 3.0f);
+	}
+
+	SECTION("Corrupt materials") {
+		// The last field is the length of the empty diffuse map
+		{
+			std::fstream cache(MeshCache::cachePath(source_path),
+			                   std::fstream::in | std::fstream::out |
+			                       std::fstream::binary);
+			const auto length = uint32_t(0xffffffff);
+			cache.seekp(-static_cast<std::streamoff>(sizeof(length)),
+			            std::fstream::end);
+			cache.write(reinterpret_cast<const char *>(&length),
+			            sizeof(length));
+		}
+		REQUIRE(MeshCache::load(source_path) == nullptr);
+	}
+
+	SECTION("Changed source") {
+		{
+			std::ofstream source(source_path, std::ofstream::app);
+			source << "v 0.0 0.0 0.0\n";
+		}
+		REQUIRE(MeshCache::load(source_path) == nullptr);
+	}
+}
+
+/**
+ * Test that the OBJ loader triangulates polygons, shares identical vertices
+ * and splits the mesh on material changes.
+ */
+TEST_CASE("Load OBJ", "[model]") {
+	const auto path = std::string("obj-loader-test.obj");
+	{
+		std::ofstream source(path);
+		source << "v 0 0 0\nv 1 0 0\nv 1 0 1\nv 0 0 1\n"
+		       << "vn 0 1 0\n"
+		       << "usemtl a\nf 1//1 2//1 3//1 4//1\n"
+		       << "usemtl b\nf -4//1 -2//1 -1//1\n";
+	}
+
+	const auto mesh = loadObj(path);
+	REQUIRE(mesh.vertices.size() == 4);
+	REQUIRE(mesh.indices.size() == 9);
+	REQUIRE(mesh.submeshes.size() == 2);
+	REQUIRE(mesh.submeshes[0].index_count == 6);
+	REQUIRE(mesh.submeshes[1].index_offset == 6);
+	REQUIRE(mesh.bounds.max == glm::vec3(1.0f, 0.0f, 1.0f));
+	REQUIRE(mesh.vertices[0].normal == glm::vec3(0.0f, 1.0f, 0.0f));
+}
+
+/**
+ * Test that optimizing a mesh welds its vertices, keeps its triangles and makes
+ * it better for the vertex cache.
+ */
+TEST_CASE("Optimize Mesh", "[model]") {
+	// A grid of quads with a separate copy of every vertex per quad, in an
+	// order that is bad for the cache
+	constexpr int size = 16;
+	MeshData      mesh;
+	for (int i = 0; i < size; ++i) {
+		for (int j = 0; j < size; ++j) {
+			const auto base = static_cast<GLuint>(mesh.vertices.size());
+			for (const auto &corner : {glm::vec2(0, 0), glm::vec2(1, 0),
+			                           glm::vec2(0, 1), glm::vec2(1, 1)}) {
+				mesh.vertices.push_back(
+				    {glm::vec3(j + corner.x, 0.0f, i + corner.y),
+				     glm::vec3(0.0f, 1.0f, 0.0f), glm::vec2(0.0f)});
+			}
+			mesh.indices.insert(end(mesh.indices), {base + 0, base + 2, base + 1,
+			                                        base + 1, base + 2, base + 3});
+		}
+	}
+	mesh.submeshes = {Submesh{0, static_cast<uint32_t>(mesh.indices.size()), 0,
+	                          0}};
+
+	const auto stats = optimizeMesh(mesh);
+	REQUIRE(mesh.vertices.size() == (size + 1) * (size + 1));
+	REQUIRE(mesh.indices.size() == size * size * 6);
+	REQUIRE(stats.after.acmr < stats.before.acmr);
+	REQUIRE(mesh.optimizer_stats.after.acmr == stats.after.acmr);
+	REQUIRE(mesh.bounds.max == glm::vec3(size, 0.0f, size));
+}
+
+/**
+ * Test that simplifying a flat grid removes triangles without moving the
+ * surface, and keeps the border intact.
+ */
+TEST_CASE("Simplify Mesh", "[model]") {
+	constexpr int                size = 16;
+	std::vector<Vertex3DNormTex> vertices;
+	std::vector<GLuint>          indices;
+	for (int i = 0; i <= size; ++i) {
+		for (int j = 0; j <= size; ++j) {
+			vertices.push_back({glm::vec3(j, 0.0f, i),
+			                    glm::vec3(0.0f, 1.0f, 0.0f), glm::vec2(0.0f)});
+		}
+	}
+	for (int i = 0; i < size; ++i) {
+		for (int j = 0; j < size; ++j) {
+			const auto base = static_cast<GLuint>(i * (size + 1) + j);
+			indices.insert(end(indices),
+			               {base, base + size + 1, base + 1, base + 1,
+			                base + size + 1, base + size + 2});
+		}
+	}
+
+	const auto lod = simplifyMesh(vertices, indices, indices.size() / 2, 0.1f);
+	REQUIRE(!lod.indices.empty());
+	REQUIRE(lod.indices.size() <= indices.size() / 2);
+	REQUIRE(lod.indices.size() % 3 == 0);
+	REQUIRE(lod.error == Approx(0.0f).margin(1e-4));
+}
+
+/**
+ * Test that the frustum of an orthographic projection keeps what is inside it
+ * and culls what is outside.
+ */
+TEST_CASE("Frustum Culling", "[model]") {
+	const auto frustum =
+	    Frustum::fromMatrix(glm::ortho(-1.0f, 1.0f, -1.0f, 1.0f, 0.1f, 10.0f));
+
+	REQUIRE(frustum.intersectsSphere(glm::vec3(0.0f, 0.0f, -5.0f), 0.5f));
+	REQUIRE(frustum.intersectsSphere(glm::vec3(1.2f, 0.0f, -5.0f), 0.5f));
+	REQUIRE(!frustum.intersectsSphere(glm::vec3(2.0f, 0.0f, -5.0f), 0.5f));
+	REQUIRE(!frustum.intersectsSphere(glm::vec3(0.0f, 0.0f, 5.0f), 0.5f));
+
+	const auto bounds = Bounds{glm::vec3(-0.5f), glm::vec3(0.5f),
+	                           glm::vec3(0.0f), std::sqrt(0.75f)};
+	REQUIRE(frustum.intersects(
+	    bounds, glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 0.0f, -5.0f))));
+	REQUIRE(!frustum.intersects(
+	    bounds, glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 3.0f, -5.0f))));
+}
+
+/**
+ * Test that jobs run on the thread pool, and that results and exceptions are
+ * passed back through the futures.
+ */
+TEST_CASE("Thread Pool", "[threads]") {
+	auto pool = ThreadPool(4);
+
+	std::vector<std::future<int>> results;
+	for (int i = 0; i < 64; ++i)
+		results.push_back(pool.submit([i]() { return i * i; }));
+	for (int i = 0; i < 64; ++i)
+		REQUIRE(results[i].get() == i * i);
+
+	auto failed = pool.submit([]() -> int {
+		throw std::runtime_error("Job failed");
+	});
+	REQUIRE_THROWS_AS(failed.get(), std::runtime_error);
+}
+
+/**
+ * Test that async models draw their placeholder until uploaded, that uploads
+ * stop once the budget is spent, that dropped loads are pruned, and that
+ * failed loads throw once uploaded.
+ */
+TEST_CASE("Model Loader", "[model]") {
+	auto window = Window("Test", 640, 480);
+
+	MeshData mesh;
+	mesh.vertices = {
+	    {glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f), glm::vec2(0.0f)},
+	    {glm::vec3(1.0f, 0.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f),
+	     glm::vec2(1.0f, 0.0f)},
+	    {glm::vec3(0.0f, 0.0f, 1.0f), glm::vec3(0.0f, 1.0f, 0.0f),
+	     glm::vec2(0.0f, 1.0f)}};
+	mesh.indices   = {0, 1, 2};
+	mesh.submeshes = {Submesh{0, 3, 0, 0}};
+	mesh.bounds    = computeBounds(mesh.vertices);
+
+	SECTION("Placeholder") {
+		auto placeholder = std::make_shared<Model>(mesh);
+		auto promise     = std::promise<MeshData>();
+		auto model       = AsyncModel(promise.get_future(), placeholder);
+		REQUIRE_FALSE(model.finalize());
+		REQUIRE_FALSE(model.ready());
+		REQUIRE(model.get() == placeholder.get());
+
+		promise.set_value(mesh);
+		REQUIRE(model.finalize());
+		REQUIRE(model.ready());
+		REQUIRE(model.get() != placeholder.get());
+	}
+
+	SECTION("Failed import") {
+		auto promise = std::promise<MeshData>();
+		auto model   = AsyncModel(promise.get_future(), nullptr);
+		promise.set_exception(
+		    std::make_exception_ptr(std::runtime_error("Import failed")));
+		REQUIRE_THROWS_AS(model.finalize(), std::runtime_error);
+		REQUIRE_THROWS_AS(model.finalize(), std::runtime_error);
+		REQUIRE(model.get() == nullptr);
+	}
+
+	SECTION("Loader") {
+		using namespace std::chrono_literals;
+
+		auto       loader = ModelLoader();
+		const auto path   = std::string("resources/models/sphere.obj");
+		const auto first  = loader.load(path);
+		const auto second = loader.load(path);
+		loader.load(path);
+
+		// The dropped load is pruned, and a spent budget uploads nothing
+		REQUIRE(loader.finalize(0us) == 2);
+		REQUIRE_FALSE(first->ready());
+		REQUIRE_FALSE(second->ready());
+
+		for (int i = 0; i < 1000 && loader.pending() > 0; ++i) {
+			loader.finalize(1s);
+			std::this_thread::sleep_for(1ms);
+		}
+		REQUIRE(loader.pending() == 0);
+		REQUIRE(first->ready());
+		REQUIRE(second->ready());
+
+		// The failed load is no longer pending once it threw
+		const auto missing = loader.load("missing.obj");
+		auto       threw   = false;
+		for (int i = 0; i < 1000 && !threw; ++i) {
+			try {
+				loader.finalize(1s);
+			} catch (const std::runtime_error &) {
+				threw = true;
+			}
+			std::this_thread::sleep_for(1ms);
+		}
+		REQUIRE(threw);
+		REQUIRE(loader.pending() == 0);
+		REQUIRE_FALSE(missing->ready());
+	}
+}
+
+/**
+ * Test that render targets are reused by description, and freed once they have
+ * been idle for a few frames.
+ */
+TEST_CASE("Render Target Pool", "[framebuffer]") {
+	auto window = Window("Test", 640, 480);
+	auto pool   = RenderTargetPool();
+
+	const auto desc = RenderTargetDesc{AttachmentType::Color,
+	                                   glm::ivec2(64, 64), 1};
+	GLuint texture;
+	{
+		const auto target = pool.acquire(desc);
+		texture           = target->getTexture();
+	}
+	{
+		const auto target = pool.acquire(desc);
+		REQUIRE(target->getTexture() == texture);
+
+		const auto other = pool.acquire(
+		    {AttachmentType::Depth, glm::ivec2(64, 64), 1});
+		REQUIRE(other->getTexture() != texture);
+	}
+	REQUIRE(pool.size() == 2);
+
+	for (int i = 0; i < 8; ++i)
+		pool.endFrame();
+	REQUIRE(pool.size() == 0);
+}
+
+/**
+ * Test that the cascades split the view into growing slices, and that every
+ * cascade covers the far end of its slice.
+ */
+TEST_CASE("Cascaded Shadow Map", "[framebuffer]") {
+	auto window     = Window("Test", 640, 480);
+	auto shadow_map = CascadedShadowMap(256, 4, 30.0f);
+
+	const auto camera = CameraComponent(640.0f / 480.0f, 70.0f);
+	const auto view   = glm::lookAt(glm::vec3(0.0f, 2.0f, 0.0f),
+	                                glm::vec3(0.0f, 2.0f, -1.0f),
+	                                glm::vec3(0.0f, 1.0f, 0.0f));
+	const auto light  = glm::normalize(glm::vec3(1.0f, 2.0f, 1.0f));
+	shadow_map.update(camera, view, light);
+
+	const auto &splits = shadow_map.getSplits();
+	REQUIRE(splits.size() == 4);
+	for (size_t i = 1; i < splits.size(); ++i)
+		REQUIRE(splits[i] - splits[i - 1] > splits[0]);
+	REQUIRE(splits.back() == Approx(30.0f));
+
+	for (size_t i = 0; i < splits.size(); ++i) {
+		const auto point =
+		    shadow_map.getMatrix(i) * glm::vec4(0.0f, 2.0f, -splits[i], 1.0f);
+		REQUIRE(std::abs(point.x / point.w) <= 1.0f);
+		REQUIRE(std::abs(point.y / point.w) <= 1.0f);
+		REQUIRE(std::abs(point.z / point.w) <= 1.0f);
+		REQUIRE(shadow_map.pixelsPerUnit(i) > 0.0f);
+	}
+}
+
+/**
+ * Test that the cached static casters of the cascades survive small camera
+ * moves, and are drawn again once the camera moves far or the light changes.
+ */
+TEST_CASE("Cascaded Shadow Map Cache", "[framebuffer]") {
+	auto window     = Window("Test", 640, 480);
+	auto shadow_map = CascadedShadowMap(256, 4, 30.0f);
+
+	const auto camera = CameraComponent(640.0f / 480.0f, 70.0f);
+	const auto light  = glm::normalize(glm::vec3(1.0f, 2.0f, 1.0f));
+	const auto view   = [](float x) {
+		return glm::lookAt(glm::vec3(x, 2.0f, 0.0f), glm::vec3(x, 2.0f, -1.0f),
+		                   glm::vec3(0.0f, 1.0f, 0.0f));
+	};
+
+	shadow_map.update(camera, view(0.0f), light);
+	const auto matrices = shadow_map.getMatrices();
+	for (size_t i = 0; i < shadow_map.getCascadeCount(); ++i) {
+		REQUIRE(shadow_map.beginStatic(i));
+		REQUIRE_FALSE(shadow_map.beginStatic(i));
+	}
+
+	// Less than a texel of the finest cascade
+	const auto texel = 1.0f / shadow_map.pixelsPerUnit(0);
+	shadow_map.update(camera, view(texel / 2.0f), light);
+	REQUIRE(shadow_map.getMatrices() == matrices);
+	for (size_t i = 0; i < shadow_map.getCascadeCount(); ++i)
+		REQUIRE_FALSE(shadow_map.beginStatic(i));
+
+	shadow_map.update(camera, view(100.0f), light);
+	for (size_t i = 0; i < shadow_map.getCascadeCount(); ++i)
+		REQUIRE(shadow_map.beginStatic(i));
+
+	shadow_map.update(camera, view(100.0f), -light);
+	for (size_t i = 0; i < shadow_map.getCascadeCount(); ++i)
+		REQUIRE(shadow_map.beginStatic(i));
+}
+
+/**
+ * Test that the resolution drops when frames are over budget, holds within the
+ * budget, and recovers once there is room again.
+ */
+TEST_CASE("Dynamic Resolution", "[framebuffer]") {
+	auto controller = DynamicResolution(10.0f, 0.5f, 1.0f);
+	REQUIRE(controller.getScale() == 1.0f);
+	REQUIRE(controller.scale(glm::ivec2(1280, 720)) == glm::ivec2(1280, 720));
+
+	// The frame time follows the number of pixels
+	for (int i = 0; i < 100; ++i) {
+		const auto scale = controller.getScale();
+		controller.update(20.0f * scale * scale);
+	}
+	const auto dropped = controller.getScale();
+	REQUIRE(dropped < 1.0f);
+	REQUIRE(dropped >= 0.5f);
+
+	for (int i = 0; i < 100; ++i)
+		controller.update(9.0f);
+	REQUIRE(controller.getScale() == dropped);
+
+	for (int i = 0; i < 100; ++i)
+		controller.update(2.0f);
+	REQUIRE(controller.getScale() == 1.0f);
+
+	// Recovers from the smallest scale too, where a single rise is less than
+	// half a step
+	for (int i = 0; i < 100; ++i)
+		controller.update(100.0f);
+	REQUIRE(controller.getScale() == 0.5f);
+
+	for (int i = 0; i < 100; ++i)
+		controller.update(2.0f);
+	REQUIRE(controller.getScale() == 1.0f);
+}
+
+/**
+ * Test that the state cache skips calls that change nothing, counts them, and
+ * issues everything again once invalidated.
+ */
+TEST_CASE("State Cache", "[state]") {
+	auto  window = Window("Test", 640, 480);
+	auto &state  = StateCache::get();
+	state.endFrame();
+
+	state.setEnabled(GL_DEPTH_TEST, true);
+	state.setEnabled(GL_DEPTH_TEST, true);
+	state.setViewport(glm::ivec4(0, 0, 64, 32));
+	state.setViewport(glm::ivec4(0, 0, 64, 32));
+	REQUIRE(glIsEnabled(GL_DEPTH_TEST) == GL_TRUE);
+
+	GLint viewport[4];
+	glGetIntegerv(GL_VIEWPORT, viewport);
+	REQUIRE(viewport[2] == 64);
+	REQUIRE(viewport[3] == 32);
+
+	state.endFrame();
+	REQUIRE(state.lastFrame().issued == 2);
+	REQUIRE(state.lastFrame().skipped == 2);
+
+	state.invalidate();
+	state.setEnabled(GL_DEPTH_TEST, true);
+	state.endFrame();
+	REQUIRE(state.lastFrame().issued == 1);
+	REQUIRE(state.lastFrame().skipped == 0);
+}
+
+/**
+ * Test that sort keys order by their most significant field first, and that
+ * the radix sort agrees with a comparison sort and is stable.
+ */
+TEST_CASE("Render Queue", "[state]") {
+	SECTION("Key ordering") {
+		const auto key = [](uint32_t pass, uint32_t program, float depth) {
+			return RenderQueue::makeKey({pass, 0, program, 0, 0, depth});
+		};
+		REQUIRE(key(0, 5, 1.0f) < key(1, 0, 0.0f));
+		REQUIRE(key(0, 0, 1.0f) < key(0, 1, 0.0f));
+		REQUIRE(key(0, 0, 0.25f) < key(0, 0, 0.5f));
+
+		const auto back_to_front = [](float depth) {
+			return RenderQueue::makeKey({0, 0, 0, 0, 0, depth, true});
+		};
+		REQUIRE(back_to_front(0.5f) < back_to_front(0.25f));
+	}
+
+	SECTION("Radix sort") {
+		// Some keys repeat, to check that equal keys keep their order
+		std::vector<SortEntry> entries;
+		auto                   state = uint64_t(0x9e3779b97f4a7c15);
+		for (uint32_t i = 0; i < 1000; ++i) {
+			state ^= state << 13;
+			state ^= state >> 7;
+			state ^= state << 17;
+			entries.push_back({state % 64 == 0 ? 42 : state, i});
+		}
+
+		auto expected = entries;
+		std::stable_sort(begin(expected), end(expected),
+		                 [](const auto &a, const auto &b) {
+			                 return a.key < b.key;
+		                 });
+
+		std::vector<SortEntry> scratch;
+		RenderQueue::radixSort(entries, scratch);
+		for (size_t i = 0; i < entries.size(); ++i) {
+			REQUIRE(entries[i].key == expected[i].key);
+			REQUIRE(entries[i].index == expected[i].index);
+		}
+	}
+}
+
+/**
+ * Test that command lists recorded on worker threads replay in the order they
+ * were recorded in.
+ */
+TEST_CASE("Command Queue", "[threads]") {
+	auto window = Window("Test", 640, 480);
+	auto buffer = Buffer(4 * sizeof(GLuint));
+	auto queue  = CommandQueue(2);
+
+	// Later lists overwrite what earlier lists uploaded
+	for (GLuint i = 0; i < 4; ++i) {
+		queue.record([&buffer, i](CommandList &list) {
+			const auto values = std::vector<GLuint>(4 - i, i);
+			list.upload(buffer, values.data(), values.size() * sizeof(GLuint),
+			            i * sizeof(GLuint));
+			REQUIRE(list.size() == 1);
+		});
+	}
+	queue.execute(0);
+	queue.execute();
+	queue.reset();
+
+	auto values = std::vector<GLuint>(4);
+	glGetNamedBufferSubData(buffer.getId(), 0, 4 * sizeof(GLuint),
+	                        values.data());
+	REQUIRE(values == std::vector<GLuint>{0, 1, 2, 3});
+}
+
+/**
+ * Test that the frame graph culls passes nothing uses, shares targets between
+ * passes that do not overlap, and only compiles again when the passes change.
+ */
+TEST_CASE("Frame Graph", "[framebuffer]") {
+	auto       pool  = RenderTargetPool();
+	auto       graph = FrameGraph(pool);
+	const auto desc =
+	    RenderTargetDesc{AttachmentType::Color, glm::ivec2(64, 64), 1};
+
+	// A chain of passes, each reading what the one before it created, and a
+	// pass nobody reads from
+	auto previous = FrameResource();
+	graph.addPass(
+	    "first",
+	    [&](FrameGraph::PassBuilder &builder) {
+		    previous = builder.create(desc);
+	    },
+	    [](const FrameGraph::PassContext &) {});
+	for (const auto *name : {"second", "third"}) {
+		graph.addPass(
+		    name,
+		    [&](FrameGraph::PassBuilder &builder) {
+			    builder.read(previous);
+			    previous = builder.create(desc);
+		    },
+		    [](const FrameGraph::PassContext &) {});
+	}
+	graph.addPass(
+	    "unused",
+	    [&](FrameGraph::PassBuilder &builder) { builder.create(desc); },
+	    [](const FrameGraph::PassContext &) {});
+	graph.addPass(
+	    "present",
+	    [&](FrameGraph::PassBuilder &builder) {
+		    builder.read(previous);
+		    builder.sideEffect();
+	    },
+	    [](const FrameGraph::PassContext &) {});
+
+	graph.compile();
+	REQUIRE(graph.getCompiledPasses() ==
+	        std::vector<std::string>{"first", "second", "third", "present"});
+	REQUIRE(graph.getPeakTargets() == 2);
+	REQUIRE(graph.getCompileCount() == 1);
+
+	// Compiling the same passes again reuses the plan
+	graph.compile();
+	REQUIRE(graph.getCompileCount() == 1);
+}
+
+/**
+ * Test that boxes behind a wall are culled, and boxes in front of it, beside
+ * it, peeking out past it or through the near plane are not.
+ */
+TEST_CASE("Occlusion Culling", "[model]") {
+	auto culler = OcclusionCuller(glm::ivec2(64, 32), 2);
+
+	// A wall two units wide, five units in front of the camera
+	culler.setOccluders({glm::vec3(-1.0f, -1.0f, -5.0f),
+	                     glm::vec3(1.0f, -1.0f, -5.0f),
+	                     glm::vec3(1.0f, 1.0f, -5.0f),
+	                     glm::vec3(-1.0f, -1.0f, -5.0f),
+	                     glm::vec3(1.0f, 1.0f, -5.0f),
+	                     glm::vec3(-1.0f, 1.0f, -5.0f)});
+
+	const auto projection =
+	    glm::perspective(glm::radians(90.0f), 2.0f, 0.1f, 100.0f);
+	const auto view = glm::lookAt(glm::vec3(0.0f), glm::vec3(0.0f, 0.0f, -1.0f),
+	                              glm::vec3(0.0f, 1.0f, 0.0f));
+	culler.render(projection * view);
+
+	const auto box = [&](glm::vec3 center, float size) {
+		return culler.isVisible(center - size, center + size);
+	};
+	REQUIRE_FALSE(box(glm::vec3(0.0f, 0.0f, -10.0f), 0.5f));
+	REQUIRE(box(glm::vec3(0.0f, 0.0f, -3.0f), 0.5f));
+	REQUIRE(box(glm::vec3(6.0f, 0.0f, -10.0f), 0.5f));
+	REQUIRE(box(glm::vec3(0.0f, 0.0f, -10.0f), 4.0f));
+	REQUIRE(box(glm::vec3(0.0f, 0.0f, 0.0f), 0.5f));
+
+	// Pixels the wall only partly covers hide nothing, even if it covers their
+	// centers, here the edge is just past the center of a pixel
+	culler.setOccluders({glm::vec3(-1.0f, -1.0f, -5.0f),
+	                     glm::vec3(1.1f, -1.0f, -5.0f),
+	                     glm::vec3(1.1f, 1.0f, -5.0f),
+	                     glm::vec3(-1.0f, -1.0f, -5.0f),
+	                     glm::vec3(1.1f, 1.0f, -5.0f),
+	                     glm::vec3(-1.0f, 1.0f, -5.0f)});
+	culler.render(projection * view);
+	REQUIRE_FALSE(box(glm::vec3(0.0f, 0.0f, -10.0f), 0.5f));
+	REQUIRE(culler.isVisible(glm::vec3(2.25f, -0.1f, -10.0f),
+	                         glm::vec3(2.4f, 0.1f, -10.0f)));
+}
+
+/**
+ * Test that the profiler reads back nested scopes without waiting on the GPU,
+ * and orders them by when they first ran.
+ */
+TEST_CASE("GPU Profiler", "[state]") {
+	auto window   = Window("Test", 640, 480);
+	auto profiler = GpuProfiler();
+
+	// Frames are read back once the GPU is done with them
+	for (size_t frame = 0; frame < 2 * gGpuTimerLatency; ++frame) {
+		{
+			auto outer = GpuProfiler::Scope(profiler, "outer");
+			auto inner = GpuProfiler::Scope(profiler, "inner");
+			glClear(GL_COLOR_BUFFER_BIT);
+		}
+		glFinish();
+		profiler.endFrame();
+	}
+
+	const auto &stats = profiler.getStats();
+	REQUIRE(stats.size() == 2);
+	REQUIRE(stats[0].name == "outer");
+	REQUIRE(stats[1].name == "inner");
+	REQUIRE(stats[0].maximum >= stats[0].average);
+	REQUIRE(stats[0].average >= stats[1].average);
+}
+
+/**
+ * Test that the tracer counts the calls of a frame by kind, and nothing once
+ * it is disabled.
+ */
+TEST_CASE("GL Tracer", "[state]") {
+	auto  window = Window("Test", 640, 480);
+	auto  buffer = Buffer(4 * sizeof(GLuint));
+	auto &tracer = GlTracer::get();
+	tracer.setEnabled(true);
+	tracer.endFrame();
+
+	const auto values = std::vector<GLuint>{1, 2, 3, 4};
+	buffer.upload(values.data(), 4 * sizeof(GLuint), 0);
+	tracer.endFrame();
+	REQUIRE(tracer.lastFrame().binds == 1);
+	REQUIRE(tracer.lastFrame().uploads == 1);
+	REQUIRE(tracer.lastFrame().uploaded == 4 * sizeof(GLuint));
+	REQUIRE(tracer.lastFrame().draws == 0);
+
+	// Texture binds go through glBindTextureUnit, so they are traced too
+	GLuint texture = 0;
+	glCreateTextures(GL_TEXTURE_2D, 1, &texture);
+	auto &state = StateCache::get();
+	state.invalidate();
+	state.bindTexture(0, GL_TEXTURE_2D, texture);
+	state.bindTexture(0, GL_TEXTURE_2D, texture);
+	tracer.endFrame();
+	REQUIRE(tracer.lastFrame().binds == 1);
+	glDeleteTextures(1, &texture);
+	state.invalidate();
+
+	tracer.setEnabled(false);
+	buffer.upload(values.data(), 4 * sizeof(GLuint), 0);
+	tracer.endFrame();
+	REQUIRE(tracer.lastFrame().uploads == 0);
+}
+
+/**
+ * Test that the ring drops what does not fit, and hands a consumer thread
+ * everything a producer thread pushed, in order.
+ */
+TEST_CASE("Ring Buffer", "[threads]") {
+	auto ring = RingBuffer<int, 4>();
+	for (int i = 0; i < 4; ++i)
+		REQUIRE(ring.push(i));
+	REQUIRE(!ring.push(4));
+	REQUIRE(ring.pop() == 0);
+	REQUIRE(ring.push(4));
+
+	auto popped = std::vector<int>();
+	while (const auto value = ring.pop())
+		popped.push_back(value.value());
+	REQUIRE(popped == std::vector<int>{1, 2, 3, 4});
+	REQUIRE(ring.empty());
+
+	auto producer = std::thread([&ring]() {
+		for (int i = 0; i < 10000; ++i)
+			while (!ring.push(i))
+				std::this_thread::yield();
+	});
+	for (int i = 0; i < 10000; ++i) {
+		auto value = ring.pop();
+		while (!value)
+			value = ring.pop();
+		REQUIRE(value.value() == i);
+	}
+	producer.join();
+}
+
+/**
+ * Test that a capped window presents no faster than its rate, and remembers
+ * when it presented.
+ */
+TEST_CASE("Frame Pacing", "[framebuffer]") {
+	auto window = Window("Test", 640, 480);
+	window.setPresentMode(PresentMode::Capped, 200.0f);
+
+	for (int i = 0; i < 10; ++i)
+		window.swapBuffers();
+
+	// Nine periods of 5 ms, less some slack for the first frame
+	const auto &times = window.getPresentTimes();
+	REQUIRE(times.size() == 10);
+	REQUIRE(times.back() - times.front() >= std::chrono::milliseconds(40));
+}
+
+/**
+ * Test that the tick clock runs whole ticks, drops time past the most ticks per
+ * frame, and leaves an alpha from 0 to 1.
+ */
+TEST_CASE("Tick Clock", "[state]") {
+	auto       clock = TickClock();
+	const auto ticks = [&clock]() {
+		auto count = 0;
+		while (clock.tick())
+			count++;
+		return count;
+	};
+
+	clock.advance(gTickLength / 2.0f);
+	REQUIRE(ticks() == 0);
+	REQUIRE(clock.alpha() == Approx(0.5f));
+
+	clock.advance(gTickLength * 2.0f);
+	REQUIRE(ticks() == 2);
+	REQUIRE(clock.alpha() == Approx(0.5f));
+
+	// A hitch of a whole second only runs the most ticks per frame
+	clock.advance(1.0f);
+	REQUIRE(ticks() == gMaxTicksPerFrame);
+	REQUIRE(clock.alpha() == 0.0f);
+
+	for (int i = 0; i < 100; ++i) {
+		clock.advance(0.007f * static_cast<float>(i % 7));
+		REQUIRE(ticks() <= gMaxTicksPerFrame);
+		REQUIRE(clock.alpha() >= 0.0f);
+		REQUIRE(clock.alpha() < 1.0f);
+	}
 }